@@ -35,6 +35,21 @@ namespace sdl {
         }
 
 
+        /// Resize memory using SDL_realloc()
+        void*
+        reallocate(void* ptr,
+                   std::size_t size);
+
+
+        template<typename T>
+        T
+        reallocate_as(void* ptr,
+                      std::size_t size)
+        {
+            return reinterpret_cast<T>(reallocate(ptr, size));
+        }
+
+
         /// Free memory using SDL_free()
         void
         deallocate(void* ptr)
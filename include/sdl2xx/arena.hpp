@@ -0,0 +1,242 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_ARENA_HPP
+#define SDL2XX_ARENA_HPP
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <SDL_stdinc.h>
+
+#include "vector.hpp"
+
+
+namespace sdl {
+
+    /**
+     * A monotonic allocator: memory is carved out of big blocks, and only released
+     * all at once.
+     *
+     * Blocks are kept after reset(), so once the arena has grown to fit a frame's
+     * worth of allocations, later frames don't call SDL_malloc() at all.
+     */
+    class arena {
+
+        struct block {
+            Uint8* data;
+            std::size_t size;
+        };
+
+        vector<block> blocks;
+        std::size_t block_size;
+
+        // Current allocation point.
+        std::size_t current = 0;
+        std::size_t offset = 0;
+
+    public:
+
+        static constexpr std::size_t default_block_size = 64 * 1024;
+
+
+        struct marker {
+            std::size_t block;
+            std::size_t offset;
+        };
+
+
+        explicit
+        arena(std::size_t block_size = default_block_size)
+            noexcept;
+
+
+        /// Move constructor.
+        arena(arena&& other)
+            noexcept;
+
+
+        ~arena()
+            noexcept;
+
+
+        /// Move assignment.
+        arena&
+        operator =(arena&& other)
+            noexcept;
+
+
+        [[nodiscard]]
+        void*
+        allocate(std::size_t size,
+                 std::size_t alignment = alignof(std::max_align_t));
+
+
+        /// Remember the allocation point.
+        [[nodiscard]]
+        marker
+        mark()
+            const noexcept;
+
+        /// Free everything allocated after the marker was taken, in O(1).
+        void
+        rewind(marker m)
+            noexcept;
+
+        /// Free everything, in O(1); the blocks are kept for reuse.
+        void
+        reset()
+            noexcept;
+
+
+        /// Give the blocks back to SDL_free().
+        void
+        release()
+            noexcept;
+
+
+        /// Bytes allocated from the arena, including alignment padding.
+        [[nodiscard]]
+        std::size_t
+        get_used()
+            const noexcept;
+
+        /// Total size of all blocks.
+        [[nodiscard]]
+        std::size_t
+        get_capacity()
+            const noexcept;
+
+    }; // class arena
+
+
+    /// Allocator for standard containers; deallocation is a no-op.
+    template<typename T>
+    struct arena_allocator {
+
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap            = std::true_type;
+
+
+        arena* source;
+
+
+        arena_allocator(arena& source)
+            noexcept :
+            source{&source}
+        {}
+
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U>& other)
+            noexcept :
+            source{other.source}
+        {}
+
+
+        T*
+        allocate(std::size_t count)
+        {
+            return static_cast<T*>(source->allocate(count * sizeof(T), alignof(T)));
+        }
+
+
+        void
+        deallocate(T* /*ptr*/,
+                   std::size_t /*count*/)
+            noexcept
+        {}
+
+
+        template<typename U>
+        constexpr bool
+        operator ==(const arena_allocator<U>& other)
+            const noexcept
+        {
+            return source == other.source;
+        }
+
+    };
+
+
+    /**
+     * Per-frame temporaries.
+     *
+     * Each thread has its own frame arena. A frame::scope rewinds the arena when it
+     * ends, so containers using frame::allocator must not outlive the scope where
+     * they were created.
+     */
+    namespace frame {
+
+        /// The calling thread's frame arena.
+        [[nodiscard]]
+        arena&
+        get_arena()
+            noexcept;
+
+
+        class scope {
+
+            arena::marker saved;
+
+        public:
+
+            scope()
+                noexcept;
+
+            ~scope()
+                noexcept;
+
+
+            scope(const scope&) = delete;
+
+        }; // class scope
+
+
+        template<typename T>
+        struct allocator : arena_allocator<T> {
+
+            allocator()
+                noexcept :
+                arena_allocator<T>{get_arena()}
+            {}
+
+
+            template<typename U>
+            allocator(const allocator<U>& other)
+                noexcept :
+                arena_allocator<T>{other}
+            {}
+
+        };
+
+
+        template<typename T>
+        using vector = std::vector<T, allocator<T>>;
+
+
+        template<typename T>
+        using basic_string = std::basic_string<T, std::char_traits<T>, allocator<T>>;
+
+        using string    = basic_string<char>;
+        using u8string  = basic_string<char8_t>;
+        using u16string = basic_string<char16_t>;
+        using u32string = basic_string<char32_t>;
+
+    } // namespace frame
+
+} // namespace sdl
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_ASYNC_RWOPS_HPP
+#define SDL2XX_ASYNC_RWOPS_HPP
+
+#include <cstddef>
+
+#include <SDL_rwops.h>
+
+#include "rwops.hpp"
+#include "string.hpp"
+
+
+namespace sdl {
+
+    /**
+     * A read-only rwops that prefetches another rwops from a background thread.
+     *
+     * The I/O thread keeps a bounded ring of chunks filled ahead of the reader. All
+     * access to the source happens on the I/O thread, so the source must not be used
+     * by anyone else while this object is alive.
+     *
+     * Seeking inside the prefetched data is free; other seeks restart the prefetching
+     * at the new position.
+     */
+    struct async_rwops : rwops {
+
+        static constexpr std::size_t default_chunk_size = 64 * 1024;
+        static constexpr unsigned default_num_chunks = 8;
+
+
+        constexpr
+        async_rwops()
+            noexcept = default;
+
+
+        /// The source must outlive this object.
+        explicit
+        async_rwops(rwops& src,
+                    std::size_t chunk_size = default_chunk_size,
+                    unsigned num_chunks = default_num_chunks);
+
+        /// Takes ownership of the source.
+        explicit
+        async_rwops(rwops&& src,
+                    std::size_t chunk_size = default_chunk_size,
+                    unsigned num_chunks = default_num_chunks);
+
+        async_rwops(SDL_RWops* src,
+                    bool close_src,
+                    std::size_t chunk_size = default_chunk_size,
+                    unsigned num_chunks = default_num_chunks);
+
+        explicit
+        async_rwops(const path& filename,
+                    std::size_t chunk_size = default_chunk_size,
+                    unsigned num_chunks = default_num_chunks);
+
+
+        /// Move constructor.
+        async_rwops(async_rwops&& other)
+            noexcept = default;
+
+
+        /// Move assignment.
+        async_rwops&
+        operator =(async_rwops&& other)
+            noexcept = default;
+
+
+        void
+        create(rwops& src,
+               std::size_t chunk_size = default_chunk_size,
+               unsigned num_chunks = default_num_chunks);
+
+        void
+        create(rwops&& src,
+               std::size_t chunk_size = default_chunk_size,
+               unsigned num_chunks = default_num_chunks);
+
+        void
+        create(SDL_RWops* src,
+               bool close_src,
+               std::size_t chunk_size = default_chunk_size,
+               unsigned num_chunks = default_num_chunks);
+
+        void
+        create(const path& filename,
+               std::size_t chunk_size = default_chunk_size,
+               unsigned num_chunks = default_num_chunks);
+
+
+        /// How many bytes are prefetched and ready to be read without blocking.
+        [[nodiscard]]
+        std::size_t
+        get_available()
+            const noexcept;
+
+    }; // struct async_rwops
+
+} // namespace sdl
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_CALLBACK_HPP
+#define SDL2XX_AUDIO_CALLBACK_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include <SDL_audio.h>
+
+#include "audio.hpp"
+
+
+namespace sdl::audio {
+
+    /// The SDL format for a sample type, in native byte order.
+    template<typename T>
+    inline constexpr format format_of = 0;
+
+    template<>
+    inline constexpr format format_of<Uint8> = AUDIO_U8;
+
+    template<>
+    inline constexpr format format_of<Sint8> = AUDIO_S8;
+
+    template<>
+    inline constexpr format format_of<Uint16> = AUDIO_U16SYS;
+
+    template<>
+    inline constexpr format format_of<Sint16> = AUDIO_S16SYS;
+
+    template<>
+    inline constexpr format format_of<Sint32> = AUDIO_S32SYS;
+
+    template<>
+    inline constexpr format format_of<float> = AUDIO_F32SYS;
+
+
+    template<typename T>
+    concept sample = format_of<T> != 0;
+
+
+    /**
+     * An audio device that calls a C++ callable with typed, interleaved samples.
+     *
+     * The callable is stored inside the object, so no allocation or type erasure is
+     * involved, and the compiler can inline it into the callback. The format is fixed
+     * to match `T`; the other parameters may still change, see get_spec().
+     *
+     * The callable runs in the audio thread; it must fill the whole span, and must not
+     * throw. Since SDL keeps a pointer to this object, it can't be moved.
+     */
+    template<sample T,
+             typename F>
+    requires std::invocable<F&, std::span<T>>
+    class callback_device : public device {
+
+        F func;
+        spec obtained;
+
+
+        static
+        void
+        SDLCALL
+        trampoline(void* ctx,
+                   Uint8* stream,
+                   int len)
+            noexcept
+        {
+            auto self = static_cast<callback_device*>(ctx);
+            self->func(std::span<T>{reinterpret_cast<T*>(stream), len / sizeof(T)});
+        }
+
+    public:
+
+        static constexpr Uint32 default_allowed_changes
+            = convert(allow_change::frequency, allow_change::channels, allow_change::samples);
+
+
+        callback_device(const char* name,
+                        bool is_capture,
+                        spec desired,
+                        F f,
+                        Uint32 allowed_changes = default_allowed_changes) :
+            func(std::move(f))
+        {
+            desired.format = format_of<T>;
+            desired.callback = trampoline;
+            desired.userdata = this;
+            // The span type depends on the format, so it can never change.
+            allowed_changes &= ~static_cast<Uint32>(allow_change::format);
+            create(name, is_capture, desired, obtained, allowed_changes);
+        }
+
+
+        callback_device(bool is_capture,
+                        const spec& desired,
+                        F f,
+                        Uint32 allowed_changes = default_allowed_changes) :
+            callback_device{nullptr, is_capture, desired, std::move(f), allowed_changes}
+        {}
+
+
+        callback_device(const callback_device&) = delete;
+
+
+        ~callback_device()
+            noexcept
+        {
+            // Stop the audio thread before the callable is destroyed.
+            destroy();
+        }
+
+
+        /// The spec SDL actually opened the device with.
+        [[nodiscard]]
+        const spec&
+        get_spec()
+            const noexcept
+        {
+            return obtained;
+        }
+
+
+        /// Lock the device before touching the callable from another thread.
+        [[nodiscard]]
+        F&
+        get_callback()
+            noexcept
+        {
+            return func;
+        }
+
+        [[nodiscard]]
+        const F&
+        get_callback()
+            const noexcept
+        {
+            return func;
+        }
+
+    }; // class callback_device
+
+
+    /// Lets the sample type be given explicitly, while the callable type is deduced.
+    template<sample T,
+             typename F>
+    [[nodiscard]]
+    callback_device<T, std::decay_t<F>>
+    make_callback_device(bool is_capture,
+                         const spec& desired,
+                         F&& f,
+                         Uint32 allowed_changes
+                             = callback_device<T, std::decay_t<F>>::default_allowed_changes)
+    {
+        return {is_capture, desired, std::forward<F>(f), allowed_changes};
+    }
+
+    template<sample T,
+             typename F>
+    [[nodiscard]]
+    callback_device<T, std::decay_t<F>>
+    make_callback_device(const char* name,
+                         bool is_capture,
+                         const spec& desired,
+                         F&& f,
+                         Uint32 allowed_changes
+                             = callback_device<T, std::decay_t<F>>::default_allowed_changes)
+    {
+        return {name, is_capture, desired, std::forward<F>(f), allowed_changes};
+    }
+
+} // namespace sdl::audio
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_CAPTURE_HPP
+#define SDL2XX_AUDIO_CAPTURE_HPP
+
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+#include <SDL_stdinc.h>
+
+#include "audio.hpp"
+#include "audio_callback.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::audio {
+
+    struct level {
+        float peak = 0;
+        float rms = 0;
+    };
+
+
+    /// Peak and RMS of float samples, over all channels.
+    [[nodiscard]]
+    level
+    measure(std::span<const float> samples)
+        noexcept;
+
+
+    /**
+     * Magnitude spectrum of float samples, using a Hann window and a radix-2 FFT.
+     *
+     * A full-scale sine shows up with a magnitude close to 1.
+     */
+    class spectrum {
+
+        std::size_t size;
+        vector<float> window;
+        float scale;
+        vector<std::complex<float>> twiddles;
+        vector<unsigned> bit_reversed;
+        vector<std::complex<float>> buf;
+        vector<float> magnitudes;
+
+    public:
+
+        /// The size must be a power of two.
+        explicit
+        spectrum(std::size_t size = 1024);
+
+
+        /**
+         * Analyze the last `get_size()` frames of interleaved samples, mixed down to mono.
+         *
+         * Missing frames are treated as silence. Returns `get_size() / 2 + 1` bins, from
+         * 0 Hz to the Nyquist frequency; the span is valid until the next call.
+         */
+        std::span<const float>
+        process(std::span<const float> samples,
+                unsigned channels = 1)
+            noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_size()
+            const noexcept;
+
+    }; // class spectrum
+
+
+    /**
+     * Continuous capture from an audio device, in float samples.
+     *
+     * The audio thread copies each callback into a lock-free ring of fixed-size blocks,
+     * tagged with a timestamp and the levels; a single consumer thread reads them with
+     * front() and pop(). When the consumer falls behind, new blocks are dropped and
+     * counted as overruns; the audio thread never blocks.
+     */
+    class capture {
+
+    public:
+
+        struct block {
+            // Estimated time of the first frame, in nanoseconds, from
+            // SDL_GetPerformanceCounter().
+            Uint64 timestamp;
+            // Index of the first frame since the capture started.
+            Uint64 position;
+            std::span<const float> samples;
+            level levels;
+        };
+
+        static constexpr std::size_t default_num_blocks = 16;
+
+    private:
+
+        struct sink {
+            capture* self;
+
+            void
+            operator ()(std::span<float> samples)
+                noexcept;
+        };
+
+        struct header {
+            Uint64 timestamp;
+            Uint64 position;
+            std::size_t size;
+            level levels;
+        };
+
+        static constexpr std::size_t cache_line = 64;
+
+        std::size_t num_blocks;
+        std::size_t block_size = 0; // in samples
+        vector<header> headers;
+        vector<float> storage;
+
+        // Only touched by the audio thread.
+        Uint64 position = 0;
+
+        // Block counters that only grow; the slot is the counter modulo num_blocks.
+        alignas(cache_line) std::atomic<std::size_t> write_index{0};
+        alignas(cache_line) std::atomic<std::size_t> read_index{0};
+
+        alignas(cache_line) std::atomic<Uint64> overruns{0};
+        std::atomic<float> last_peak{0};
+        std::atomic<float> last_rms{0};
+
+        // Last, so the audio thread is stopped before anything else is destroyed.
+        callback_device<float, sink> dev;
+
+
+        void
+        push(std::span<const float> samples)
+            noexcept;
+
+    public:
+
+        /// The format is always AUDIO_F32SYS; other fields may change, see get_spec().
+        capture(const char* name,
+                const spec& desired,
+                std::size_t num_blocks = default_num_blocks);
+
+        explicit
+        capture(const spec& desired,
+                std::size_t num_blocks = default_num_blocks);
+
+
+        // Disallow copies.
+        capture(const capture&) = delete;
+
+
+        /// The capture starts paused.
+        void
+        start()
+            noexcept;
+
+        void
+        stop()
+            noexcept;
+
+
+        /// Consumer side: the oldest block, valid until pop() is called.
+        [[nodiscard]]
+        std::optional<block>
+        front()
+            const noexcept;
+
+        /// Consumer side: release the oldest block.
+        void
+        pop()
+            noexcept;
+
+        /// Consumer side: drop all blocks.
+        void
+        clear()
+            noexcept;
+
+
+        /// How many blocks are waiting.
+        [[nodiscard]]
+        std::size_t
+        get_available()
+            const noexcept;
+
+
+        /// Levels of the most recent block.
+        [[nodiscard]]
+        level
+        get_level()
+            const noexcept;
+
+
+        [[nodiscard]]
+        Uint64
+        get_overruns()
+            const noexcept;
+
+
+        [[nodiscard]]
+        const spec&
+        get_spec()
+            const noexcept;
+
+
+        [[nodiscard]]
+        device&
+        get_device()
+            noexcept;
+
+    }; // class capture
+
+} // namespace sdl::audio
+
+#endif
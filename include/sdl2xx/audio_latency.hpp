@@ -0,0 +1,245 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_LATENCY_HPP
+#define SDL2XX_AUDIO_LATENCY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include <SDL_audio.h>
+
+#include "audio.hpp"
+#include "string.hpp"
+
+
+namespace sdl::audio {
+
+    /**
+     * Measures how an output device actually behaves.
+     *
+     * In callback mode, instrument() routes the callback through the monitor, which
+     * records the interval between calls and the time spent inside them; a call that
+     * comes more than 1.5 periods after the previous one is counted as late. In queue
+     * mode, sample() polls the queued size, and counts an underrun when the queue runs
+     * dry. Callbacks that detect their own underruns (like audio::ring) can report them
+     * through add_underrun().
+     *
+     * Pause and unpause the device through the monitor, so the gap isn't counted as a
+     * late call.
+     */
+    class latency_monitor {
+
+    public:
+
+        struct stats {
+            double period_ms = 0;          // duration of one device buffer
+            double interval_mean_ms = 0;
+            double interval_jitter_ms = 0; // standard deviation
+            double interval_max_ms = 0;
+            double busy_mean_ms = 0;       // time spent inside the callback
+            double busy_max_ms = 0;
+            double queued_ms = 0;
+            double queued_max_ms = 0;
+            double latency_ms = 0;         // device buffer plus queued audio
+            Uint64 callbacks = 0;
+            Uint64 late_callbacks = 0;
+            Uint64 underruns = 0;
+        };
+
+        /// How many recent callbacks the interval statistics cover.
+        static constexpr std::size_t history_size = 256;
+
+    private:
+
+        SDL_AudioCallback user_callback = nullptr;
+        void* user_data = nullptr;
+
+        std::atomic<double> period_ms{0};
+        std::atomic<int> bytes_per_second{0};
+
+        // Only touched by the audio thread.
+        Uint64 last_call = 0;
+
+        // Set by other threads, handled by the audio thread on the next callback.
+        std::atomic<bool> restart{false};
+        std::atomic<bool> reset_pending{false};
+
+        std::array<std::atomic<float>, history_size> intervals{};
+        std::array<std::atomic<float>, history_size> busy{};
+        std::atomic<std::size_t> num_calls{0};
+        std::atomic<Uint64> late_calls{0};
+        std::atomic<Uint64> underruns{0};
+
+        // Queue mode, only touched by the thread calling sample().
+        double queued_ms = 0;
+        double queued_max_ms = 0;
+        bool had_queued = false;
+
+
+        static
+        void
+        SDLCALL
+        trampoline(void* ctx,
+                   Uint8* stream,
+                   int len)
+            noexcept;
+
+    public:
+
+        latency_monitor()
+            noexcept = default;
+
+        // Disallow copies.
+        latency_monitor(const latency_monitor&) = delete;
+
+
+        /// Replace the spec's callback with one that times the original.
+        void
+        instrument(spec& desired)
+            noexcept;
+
+
+        /// Tell the monitor the spec the device was opened with.
+        void
+        set_spec(const spec& obtained)
+            noexcept;
+
+
+        /// Queue mode: poll the device from the thread that queues audio.
+        void
+        sample(const device& dev)
+            noexcept;
+
+
+        void
+        add_underrun()
+            noexcept;
+
+
+        void
+        pause(device& dev)
+            noexcept;
+
+        void
+        unpause(device& dev)
+            noexcept;
+
+
+        [[nodiscard]]
+        stats
+        get_stats()
+            const noexcept;
+
+
+        /// The callback counters are cleared by the audio thread, on the next callback.
+        void
+        reset()
+            noexcept;
+
+    }; // class latency_monitor
+
+
+    /**
+     * Keeps an output device at the smallest buffer size that plays without glitches.
+     *
+     * The tuner opens the device itself, allowing SDL to change the buffer size. When
+     * update() sees late callbacks or underruns, the device is reopened with twice the
+     * buffer; after a quiet period, and when the callback has enough headroom, a buffer
+     * half the size is tried, but not below a size that failed recently.
+     *
+     * Reopening the device drops whatever it had buffered or queued, so this causes a
+     * short glitch.
+     */
+    class auto_tuner {
+
+        device& dev;
+        string name;
+        spec desired;
+        spec obtained;
+        latency_monitor monitor;
+
+        Uint16 min_samples;
+        Uint16 max_samples;
+        Uint16 fail_floor = 0;
+        Uint64 settle_ms;
+
+        Uint64 last_failures = 0;
+        Uint64 last_change = 0;
+        Uint64 last_failure = 0;
+
+
+        void
+        reopen(Uint16 samples);
+
+    public:
+
+        static constexpr Uint16 default_min_samples = 128;
+        static constexpr Uint16 default_max_samples = 8192;
+        static constexpr Uint64 default_settle_ms = 2000;
+
+
+        /// Opens `dev` as an output device.
+        auto_tuner(device& dev,
+                   const char* name,
+                   const spec& desired,
+                   Uint16 min_samples = default_min_samples,
+                   Uint16 max_samples = default_max_samples,
+                   Uint64 settle_ms = default_settle_ms);
+
+        auto_tuner(device& dev,
+                   const spec& desired,
+                   Uint16 min_samples = default_min_samples,
+                   Uint16 max_samples = default_max_samples,
+                   Uint64 settle_ms = default_settle_ms);
+
+
+        // Disallow copies.
+        auto_tuner(const auto_tuner&) = delete;
+
+
+        /// Closes the device.
+        ~auto_tuner()
+            noexcept;
+
+
+        /// Call periodically from the main thread; returns true if the device was reopened.
+        bool
+        update();
+
+
+        void
+        pause()
+            noexcept;
+
+        void
+        unpause()
+            noexcept;
+
+
+        [[nodiscard]]
+        const spec&
+        get_spec()
+            const noexcept;
+
+        [[nodiscard]]
+        latency_monitor&
+        get_monitor()
+            noexcept;
+
+        [[nodiscard]]
+        const latency_monitor&
+        get_monitor()
+            const noexcept;
+
+    }; // class auto_tuner
+
+} // namespace sdl::audio
+
+#endif
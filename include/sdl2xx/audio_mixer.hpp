@@ -0,0 +1,193 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_MIXER_HPP
+#define SDL2XX_AUDIO_MIXER_HPP
+
+#include <cstddef>
+#include <span>
+
+#include <SDL_stdinc.h>
+
+#include "vector.hpp"
+
+
+namespace sdl::audio {
+
+    /**
+     * A software mixer for many voices, with stereo float output.
+     *
+     * Voices are accumulated into a planar float bus, and clamped/converted once at the
+     * end, instead of saturating after every voice like mix_audio() does. Gain and pan
+     * changes are ramped over a few frames to avoid clicks.
+     *
+     * The inner loops use AVX2 or NEON when the CPU supports them.
+     *
+     * The mixer is not thread-safe; it's meant to be owned by the audio callback.
+     */
+    class mixer {
+
+    public:
+
+        using voice_id = unsigned;
+
+        static constexpr voice_id invalid_voice = ~0u;
+
+        static constexpr std::size_t default_block_frames = 1024;
+        static constexpr unsigned default_ramp_frames = 64;
+
+        enum class simd : Uint8 {
+            scalar,
+            avx2,
+            neon,
+        };
+
+    private:
+
+        struct voice {
+            std::span<const float> samples;
+            unsigned serial = 0;
+            unsigned channels = 1;
+            std::size_t frames = 0;
+            std::size_t pos = 0;
+            bool loop = false;
+            bool active = false;
+            bool stopping = false;
+
+            float gain = 0;
+            float pan = 0;
+
+            // Per-channel gains, ramped from current to target.
+            float cur_l = 0;
+            float cur_r = 0;
+            float target_l = 0;
+            float target_r = 0;
+            unsigned ramp_left = 0;
+        };
+
+        vector<voice> voices;
+        vector<float> bus_l;
+        vector<float> bus_r;
+        unsigned ramp_frames;
+        std::size_t num_active = 0;
+        unsigned next_serial = 0;
+        simd path;
+
+
+        void
+        retarget(voice& v)
+            noexcept;
+
+        void
+        mix_voice(voice& v,
+                  std::size_t frames)
+            noexcept;
+
+        void
+        mix_block(std::size_t frames)
+            noexcept;
+
+        voice*
+        find(voice_id id)
+            noexcept;
+
+        const voice*
+        find(voice_id id)
+            const noexcept;
+
+        void
+        deactivate(voice& v)
+            noexcept;
+
+    public:
+
+        explicit
+        mixer(std::size_t block_frames = default_block_frames,
+              unsigned ramp_frames = default_ramp_frames);
+
+
+        /**
+         * Start playing interleaved float samples (mono or stereo).
+         *
+         * The samples are not copied, and must stay alive while the voice plays. For
+         * stereo voices the pan acts as balance.
+         */
+        voice_id
+        play(std::span<const float> samples,
+             unsigned channels = 1,
+             float gain = 1,
+             float pan = 0,
+             bool loop = false);
+
+
+        /// Fade out and remove the voice.
+        void
+        stop(voice_id id)
+            noexcept;
+
+        /// Remove every voice immediately.
+        void
+        clear()
+            noexcept;
+
+
+        void
+        set_gain(voice_id id,
+                 float gain)
+            noexcept;
+
+        /// -1 is full left, +1 is full right.
+        void
+        set_pan(voice_id id,
+                float pan)
+            noexcept;
+
+
+        [[nodiscard]]
+        bool
+        is_playing(voice_id id)
+            const noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_num_voices()
+            const noexcept;
+
+
+        /// Whether this build and this CPU can use the kernels.
+        [[nodiscard]]
+        static
+        bool
+        is_supported(simd s)
+            noexcept;
+
+        /// The fastest kernels are picked by default; this is meant for benchmarks.
+        void
+        set_simd(simd s);
+
+        [[nodiscard]]
+        simd
+        get_simd()
+            const noexcept;
+
+
+        /// Mix interleaved stereo frames.
+        void
+        mix(std::span<float> out)
+            noexcept;
+
+        void
+        mix(std::span<Sint16> out)
+            noexcept;
+
+    }; // class mixer
+
+} // namespace sdl::audio
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_RESAMPLER_HPP
+#define SDL2XX_AUDIO_RESAMPLER_HPP
+
+#include <cstddef>
+#include <span>
+
+#include <SDL_stdinc.h>
+
+#include "vector.hpp"
+
+
+namespace sdl::audio {
+
+    /**
+     * A float sample rate converter, usable in place of `stream` when only the rate
+     * changes.
+     *
+     * Uses a polyphase windowed-sinc filter, or linear interpolation for the `linear`
+     * quality. Input and output are interleaved, but frames are kept planar internally so
+     * the filter runs with SIMD. All sizes are counted in samples (floats), like `stream`
+     * counts them in bytes.
+     */
+    class resampler {
+
+    public:
+
+        enum class quality {
+            linear,
+            low,    // 16 taps
+            medium, // 32 taps
+            high,   // 64 taps
+        };
+
+    private:
+
+        unsigned channels;
+        int src_rate;
+        int dst_rate;
+
+        // Output frame n is at input position n * step / phases.
+        Uint64 step;
+        Uint64 phases;
+
+        // Filter table; interpolated between neighbouring rows when it has fewer rows
+        // than `phases`.
+        std::size_t taps;
+        std::size_t table_phases;
+        vector<float> table;
+        vector<float> deltas;
+
+        vector<vector<float>> planes;
+        std::size_t pos = 0;  // first tap for the next output, in planes
+        Uint64 frac = 0;      // in 1/phases of a frame
+
+        bool flushed = false;
+        Uint64 total_in = 0;
+        Uint64 total_out = 0;
+
+
+        [[nodiscard]]
+        std::size_t
+        available_frames()
+            const noexcept;
+
+        void
+        compact();
+
+        void
+        reset_planes();
+
+    public:
+
+        resampler(unsigned channels,
+                  int src_rate,
+                  int dst_rate,
+                  quality q = quality::medium);
+
+
+        void
+        put(const float* samples,
+            std::size_t count);
+
+        template<std::size_t E>
+        void
+        put(std::span<const float, E> samples)
+        {
+            put(samples.data(), samples.size());
+        }
+
+
+        [[nodiscard]]
+        std::size_t
+        get(float* samples,
+            std::size_t count)
+            noexcept;
+
+        template<std::size_t E>
+        std::size_t
+        get(std::span<float, E> samples)
+            noexcept
+        {
+            return get(samples.data(), samples.size());
+        }
+
+        vector<float>
+        get(std::size_t count);
+
+
+        [[nodiscard]]
+        std::size_t
+        get_available()
+            const noexcept;
+
+
+        /// Mark the end of the input, so the last frames can be read.
+        void
+        flush();
+
+
+        void
+        clear()
+            noexcept;
+
+
+        /// How many output frames the filter delays the signal by.
+        [[nodiscard]]
+        std::size_t
+        get_latency()
+            const noexcept;
+
+
+        [[nodiscard]]
+        unsigned
+        get_channels()
+            const noexcept;
+
+        [[nodiscard]]
+        int
+        get_src_rate()
+            const noexcept;
+
+        [[nodiscard]]
+        int
+        get_dst_rate()
+            const noexcept;
+
+    }; // class resampler
+
+} // namespace sdl::audio
+
+#endif
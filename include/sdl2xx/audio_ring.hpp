@@ -0,0 +1,162 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_RING_HPP
+#define SDL2XX_AUDIO_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <span>
+
+#include <SDL_audio.h>
+
+#include "audio.hpp"
+#include "blob.hpp"
+
+
+namespace sdl::audio {
+
+    /**
+     * A single-producer, single-consumer ring buffer of audio frames.
+     *
+     * One thread pushes frames, the audio thread pops them through callback(); neither
+     * side blocks or takes the device lock. When the producer falls behind, the
+     * callback outputs silence and counts an underrun; when the ring is full, push()
+     * stores what fits and counts an overrun.
+     */
+    class ring {
+
+        static constexpr std::size_t cache_line = 64;
+
+        blob storage;
+        std::size_t capacity;   // in bytes
+        std::size_t frame_size; // in bytes
+        Uint8 silence;
+
+        // Byte counters that only grow; the index is the counter modulo the capacity. At
+        // 64 bits they don't wrap around in practice, even at a GB/s.
+        alignas(cache_line) std::atomic<Uint64> write_pos{0};
+        alignas(cache_line) std::atomic<Uint64> read_pos{0};
+
+        alignas(cache_line) std::atomic<Uint64> underruns{0};
+        std::atomic<Uint64> overruns{0};
+
+    public:
+
+        ring(std::size_t capacity_frames,
+             std::size_t frame_size,
+             Uint8 silence = 0);
+
+        /// Use the frame size and silence value from the spec.
+        ring(const spec& s,
+             std::size_t capacity_frames);
+
+
+        // Disallow copies.
+        ring(const ring&) = delete;
+
+
+        /// Producer side: returns how many frames were stored.
+        std::size_t
+        push(const void* frames,
+             std::size_t count)
+            noexcept;
+
+        template<typename T,
+                 std::size_t E>
+        std::size_t
+        push(std::span<const T, E> samples)
+            noexcept
+        {
+            return push(samples.data(), samples.size_bytes() / frame_size);
+        }
+
+
+        /// Consumer side: returns how many frames were read.
+        std::size_t
+        pop(void* frames,
+            std::size_t count)
+            noexcept;
+
+
+        /// Consumer side: fill `size` bytes, padding with silence.
+        void
+        fill(Uint8* stream,
+             std::size_t size)
+            noexcept;
+
+
+        /// Set the spec's callback and userdata to pull from this ring.
+        void
+        attach(spec& s)
+            noexcept;
+
+        static
+        void
+        SDLCALL
+        callback(void* ctx,
+                 Uint8* stream,
+                 int len)
+            noexcept;
+
+
+        /// How many frames are buffered.
+        [[nodiscard]]
+        std::size_t
+        get_size()
+            const noexcept;
+
+        /// How many frames can be pushed without overrunning.
+        [[nodiscard]]
+        std::size_t
+        get_free()
+            const noexcept;
+
+        [[nodiscard]]
+        std::size_t
+        get_capacity()
+            const noexcept;
+
+        [[nodiscard]]
+        std::size_t
+        get_frame_size()
+            const noexcept;
+
+
+        /// Buffered fraction, from 0 to 1.
+        [[nodiscard]]
+        float
+        get_fill_level()
+            const noexcept;
+
+
+        [[nodiscard]]
+        Uint64
+        get_underruns()
+            const noexcept;
+
+        [[nodiscard]]
+        Uint64
+        get_overruns()
+            const noexcept;
+
+        void
+        reset_counters()
+            noexcept;
+
+
+        /// Consumer side: drop all buffered frames.
+        void
+        clear()
+            noexcept;
+
+    }; // class ring
+
+} // namespace sdl::audio
+
+#endif
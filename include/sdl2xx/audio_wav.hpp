@@ -0,0 +1,200 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_AUDIO_WAV_HPP
+#define SDL2XX_AUDIO_WAV_HPP
+
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <span>
+
+#include <SDL_rwops.h>
+
+#include "audio.hpp"
+#include "audio_resampler.hpp"
+#include "error.hpp"
+#include "rwops.hpp"
+#include "string.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::audio {
+
+    /**
+     * Reads a WAV file block by block, instead of loading it all like load_wav().
+     *
+     * The header is parsed once, on construction. Samples are read in a fixed-size
+     * block, and converted to the output format set by set_output(); when the sample
+     * rate differs, a resampler is used.
+     *
+     * Supports PCM with 8, 16, 24 or 32 bits, and 32 or 64-bit float, including
+     * WAVE_FORMAT_EXTENSIBLE.
+     */
+    class wav_reader {
+
+        rwops owner; // only valid when the source is owned
+        SDL_RWops* src = nullptr;
+
+        // File layout.
+        spec file_spec;
+        unsigned bits = 0;
+        bool is_float = false;
+        std::size_t frame_size = 0;
+        Sint64 data_start = 0;
+        Uint64 num_frames = 0;
+        Uint64 frame_pos = 0;
+
+        // Output.
+        spec out_spec;
+        std::size_t out_frame_size = 0;
+        bool passthrough = false;
+        std::optional<resampler> rs;
+
+        std::size_t block_frames;
+        vector<Uint8> raw;
+        vector<float> work;
+
+
+        void
+        parse_header();
+
+        std::size_t
+        decode_block(std::size_t frames)
+            noexcept;
+
+        void
+        encode(const float* in,
+               std::size_t frames,
+               Uint8* out)
+            const noexcept;
+
+    public:
+
+        static constexpr std::size_t default_block_frames = 4096;
+
+
+        /// The source must outlive this object.
+        explicit
+        wav_reader(rwops& src,
+                   std::size_t block_frames = default_block_frames);
+
+        /// Takes ownership of the source.
+        explicit
+        wav_reader(rwops&& src,
+                   std::size_t block_frames = default_block_frames);
+
+        wav_reader(SDL_RWops* src,
+                   bool close_src,
+                   std::size_t block_frames = default_block_frames);
+
+        explicit
+        wav_reader(const path& filename,
+                   std::size_t block_frames = default_block_frames);
+
+
+        /// Move constructor.
+        wav_reader(wav_reader&& other)
+            noexcept = default;
+
+
+        /// Move assignment.
+        wav_reader&
+        operator =(wav_reader&& other)
+            noexcept = default;
+
+
+        /// The closest SDL format for the file's samples; 24-bit data is read as 32-bit.
+        [[nodiscard]]
+        const spec&
+        get_file_spec()
+            const noexcept;
+
+        /// Length of the file, in file frames.
+        [[nodiscard]]
+        Uint64
+        get_length()
+            const noexcept;
+
+
+        /**
+         * Change the format of read().
+         *
+         * By default, the output uses the file spec. Only mono to N and N to mono channel
+         * conversions are supported. Resets any resampler state.
+         */
+        void
+        set_output(format fmt,
+                   Uint8 channels,
+                   int rate,
+                   resampler::quality q = resampler::quality::medium);
+
+        [[nodiscard]]
+        const spec&
+        get_output_spec()
+            const noexcept;
+
+
+        /// Read up to `size` bytes in the output format; returns 0 at the end.
+        [[nodiscard]]
+        std::size_t
+        read(void* buf,
+             std::size_t size);
+
+        template<typename T,
+                 std::size_t E>
+        [[nodiscard]]
+        std::size_t
+        read(std::span<T, E> buf)
+        {
+            return read(buf.data(), buf.size_bytes());
+        }
+
+        [[nodiscard]]
+        std::expected<std::size_t, error>
+        try_read(void* buf,
+                 std::size_t size)
+            noexcept;
+
+        template<typename T,
+                 std::size_t E>
+        [[nodiscard]]
+        std::expected<std::size_t, error>
+        try_read(std::span<T, E> buf)
+            noexcept
+        {
+            return try_read(buf.data(), buf.size_bytes());
+        }
+
+
+        /// Move to a position, in file frames.
+        void
+        seek(Uint64 frame);
+
+        std::expected<void, error>
+        try_seek(Uint64 frame)
+            noexcept;
+
+
+        /// Position of the next block to be decoded, in file frames.
+        [[nodiscard]]
+        Uint64
+        tell()
+            const noexcept;
+
+
+        [[nodiscard]]
+        bool
+        is_eof()
+            const noexcept;
+
+    }; // class wav_reader
+
+} // namespace sdl::audio
+
+#endif
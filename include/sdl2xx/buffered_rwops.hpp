@@ -0,0 +1,133 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_BUFFERED_RWOPS_HPP
+#define SDL2XX_BUFFERED_RWOPS_HPP
+
+#include <cstddef>
+#include <expected>
+
+#include <SDL_rwops.h>
+
+#include "error.hpp"
+#include "rwops.hpp"
+#include "string.hpp"
+
+
+namespace sdl {
+
+    /**
+     * A rwops that buffers another rwops.
+     *
+     * Small reads are served from a read-ahead buffer, small writes are coalesced into a
+     * write-behind buffer. Reads or writes larger than the buffer bypass it. Seeking
+     * inside the read buffer does not touch the source.
+     *
+     * Pending writes are flushed on flush(), seek(), get_size(), and when destroyed.
+     */
+    struct buffered_rwops : rwops {
+
+        static constexpr std::size_t default_buffer_size = 64 * 1024;
+
+
+        constexpr
+        buffered_rwops()
+            noexcept = default;
+
+
+        /// The source must outlive this object.
+        explicit
+        buffered_rwops(rwops& src,
+                       std::size_t buffer_size = default_buffer_size);
+
+        /// Takes ownership of the source.
+        explicit
+        buffered_rwops(rwops&& src,
+                       std::size_t buffer_size = default_buffer_size);
+
+        buffered_rwops(SDL_RWops* src,
+                       bool close_src,
+                       std::size_t buffer_size = default_buffer_size);
+
+        buffered_rwops(const path& filename,
+                       const char* mode,
+                       std::size_t buffer_size = default_buffer_size);
+
+        inline
+        buffered_rwops(const path& filename,
+                       const concepts::string auto& mode,
+                       std::size_t buffer_size = default_buffer_size) :
+            buffered_rwops{filename, mode.data(), buffer_size}
+        {}
+
+
+        /// Move constructor.
+        buffered_rwops(buffered_rwops&& other)
+            noexcept = default;
+
+
+        /// Move assignment.
+        buffered_rwops&
+        operator =(buffered_rwops&& other)
+            noexcept = default;
+
+
+        void
+        create(rwops& src,
+               std::size_t buffer_size = default_buffer_size);
+
+        void
+        create(rwops&& src,
+               std::size_t buffer_size = default_buffer_size);
+
+        void
+        create(SDL_RWops* src,
+               bool close_src,
+               std::size_t buffer_size = default_buffer_size);
+
+        void
+        create(const path& filename,
+               const char* mode,
+               std::size_t buffer_size = default_buffer_size);
+
+        inline
+        void
+        create(const path& filename,
+               const concepts::string auto& mode,
+               std::size_t buffer_size = default_buffer_size)
+        {
+            create(filename, mode.data(), buffer_size);
+        }
+
+
+        /// Write out any pending data to the source.
+        void
+        flush();
+
+        std::expected<void, error>
+        try_flush()
+            noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_buffer_size()
+            const noexcept;
+
+
+        /// Returns the source rwops, not owned by the caller.
+        [[nodiscard]]
+        SDL_RWops*
+        get_source()
+            noexcept;
+
+    }; // struct buffered_rwops
+
+} // namespace sdl
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_COMPRESSED_RWOPS_HPP
+#define SDL2XX_COMPRESSED_RWOPS_HPP
+
+#include <cstddef>
+#include <expected>
+
+#include <SDL_rwops.h>
+
+#include "error.hpp"
+#include "rwops.hpp"
+
+
+namespace sdl {
+
+    enum class codec {
+        deflate, // zlib format; gzip is also accepted when decompressing
+        gzip,
+        zstd,
+        lz4,     // LZ4 frame format
+    };
+
+
+    /// Whether support for the codec was enabled when building the library.
+    [[nodiscard]]
+    bool
+    is_supported(codec c)
+        noexcept;
+
+
+    /**
+     * A read-only rwops that decompresses another rwops on the fly.
+     *
+     * Input is read through a bounded window, so memory use does not depend on the
+     * size of the data. Concatenated frames are decoded as a single stream.
+     *
+     * Forward seeks decode and discard data; backward seeks restart decoding from the
+     * beginning, so they require a seekable source.
+     *
+     * get_size() is known when the caller provides it, or when the source holds a
+     * single zstd or LZ4 frame whose header stores it; otherwise it's -1 until the
+     * stream is decoded to the end. Seeking from the end decodes to the end if needed.
+     */
+    struct decompress_rwops : rwops {
+
+        static constexpr std::size_t default_window_size = 64 * 1024;
+
+
+        constexpr
+        decompress_rwops()
+            noexcept = default;
+
+
+        /// The source must outlive this object.
+        decompress_rwops(rwops& src,
+                         codec c,
+                         Sint64 size = -1,
+                         std::size_t window_size = default_window_size);
+
+        /// Takes ownership of the source.
+        decompress_rwops(rwops&& src,
+                         codec c,
+                         Sint64 size = -1,
+                         std::size_t window_size = default_window_size);
+
+        decompress_rwops(SDL_RWops* src,
+                         bool close_src,
+                         codec c,
+                         Sint64 size = -1,
+                         std::size_t window_size = default_window_size);
+
+
+        /// Move constructor.
+        decompress_rwops(decompress_rwops&& other)
+            noexcept = default;
+
+
+        /// Move assignment.
+        decompress_rwops&
+        operator =(decompress_rwops&& other)
+            noexcept = default;
+
+
+        void
+        create(rwops& src,
+               codec c,
+               Sint64 size = -1,
+               std::size_t window_size = default_window_size);
+
+        void
+        create(rwops&& src,
+               codec c,
+               Sint64 size = -1,
+               std::size_t window_size = default_window_size);
+
+        void
+        create(SDL_RWops* src,
+               bool close_src,
+               codec c,
+               Sint64 size = -1,
+               std::size_t window_size = default_window_size);
+
+    }; // struct decompress_rwops
+
+
+    /**
+     * A write-only rwops that compresses into another rwops.
+     *
+     * The compressed stream is completed by finish(), or when this object is destroyed.
+     */
+    struct compress_rwops : rwops {
+
+        static constexpr std::size_t default_window_size = 64 * 1024;
+
+        /// Use the codec's default level.
+        static constexpr int default_level = -1;
+
+        /// Use the codec's fastest level.
+        static constexpr int fast_level = 1;
+
+
+        constexpr
+        compress_rwops()
+            noexcept = default;
+
+
+        /// The destination must outlive this object.
+        compress_rwops(rwops& dst,
+                       codec c,
+                       int level = default_level,
+                       std::size_t window_size = default_window_size);
+
+        /// Takes ownership of the destination.
+        compress_rwops(rwops&& dst,
+                       codec c,
+                       int level = default_level,
+                       std::size_t window_size = default_window_size);
+
+        compress_rwops(SDL_RWops* dst,
+                       bool close_dst,
+                       codec c,
+                       int level = default_level,
+                       std::size_t window_size = default_window_size);
+
+
+        /// Move constructor.
+        compress_rwops(compress_rwops&& other)
+            noexcept = default;
+
+
+        /// Move assignment.
+        compress_rwops&
+        operator =(compress_rwops&& other)
+            noexcept = default;
+
+
+        void
+        create(rwops& dst,
+               codec c,
+               int level = default_level,
+               std::size_t window_size = default_window_size);
+
+        void
+        create(rwops&& dst,
+               codec c,
+               int level = default_level,
+               std::size_t window_size = default_window_size);
+
+        void
+        create(SDL_RWops* dst,
+               bool close_dst,
+               codec c,
+               int level = default_level,
+               std::size_t window_size = default_window_size);
+
+
+        /// Write out the end of the compressed stream; no more data can be written.
+        void
+        finish();
+
+        std::expected<void, error>
+        try_finish()
+            noexcept;
+
+    }; // struct compress_rwops
+
+} // namespace sdl
+
+#endif
@@ -10,8 +10,10 @@
 #define SDL2XX_IMG_HPP
 
 #include <concepts>
+#include <cstddef>
 #include <expected>
 #include <filesystem>
+#include <span>
 
 #include <SDL_image.h>
 
@@ -540,6 +542,81 @@ namespace sdl::img {
         noexcept;
 
 
+    enum class format : Uint8 {
+        unknown,
+        avif,
+        bmp,
+        cur,
+        gif,
+        ico,
+        jpg,
+        jxl,
+        lbm,
+        pcx,
+        png,
+        pnm,
+        qoi,
+        svg,
+        tif,
+        webp,
+        xcf,
+        xpm,
+        xv,
+    };
+
+
+    /// How many bytes detect() reads; SVG needs to look that far for the "<svg" tag.
+    constexpr std::size_t detect_size = 4096;
+
+
+    /// Match the start of a file against all known signatures.
+    [[nodiscard]]
+    format
+    detect(std::span<const Uint8> header)
+        noexcept;
+
+    /**
+     * Detect the format with a single read, instead of calling every is_*() function.
+     *
+     * The stream is left at the position it started.
+     */
+    [[nodiscard]]
+    format
+    detect(SDL_RWops* src)
+        noexcept;
+
+    [[nodiscard]]
+    format
+    detect(rwops& src)
+        noexcept;
+
+
+    /// Call the load_*() function for `fmt`; for format::unknown, SDL_image probes.
+    [[nodiscard]]
+    surface
+    load(SDL_RWops* src,
+         bool close_src,
+         format fmt);
+
+    [[nodiscard]]
+    surface
+    load(rwops& src,
+         format fmt);
+
+    [[nodiscard]]
+    std::expected<surface, error>
+    try_load(SDL_RWops* src,
+             bool close_src,
+             format fmt)
+        noexcept;
+
+    [[nodiscard]]
+    std::expected<surface, error>
+    try_load(rwops& src,
+             format fmt)
+        noexcept;
+
+
 #if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
 
     [[nodiscard]]
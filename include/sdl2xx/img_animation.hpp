@@ -0,0 +1,338 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_IMG_ANIMATION_HPP
+#define SDL2XX_IMG_ANIMATION_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "blob.hpp"
+#include "error.hpp"
+#include "img.hpp"
+#include "pack.hpp"
+#include "renderer.hpp"
+#include "texture.hpp"
+#include "unique_ptr.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::img {
+
+    using std::chrono::milliseconds;
+
+
+    /**
+     * Decodes the frames of an animation one at a time.
+     *
+     * Frames are full-size RGBA32 images. decode() is only called from one thread at a
+     * time, usually in increasing order; the other methods can be called concurrently with
+     * it.
+     */
+    class frame_source {
+
+    public:
+
+        virtual
+        ~frame_source()
+            noexcept;
+
+
+        [[nodiscard]]
+        virtual
+        int
+        get_width()
+            const noexcept = 0;
+
+        [[nodiscard]]
+        virtual
+        int
+        get_height()
+            const noexcept = 0;
+
+        [[nodiscard]]
+        virtual
+        unsigned
+        get_count()
+            const noexcept = 0;
+
+        [[nodiscard]]
+        virtual
+        milliseconds
+        get_delay(unsigned index)
+            const noexcept = 0;
+
+
+        /// Write frame `index` to `dst`, which holds width * height * 4 bytes.
+        virtual
+        void
+        decode(unsigned index,
+               Uint8* dst) = 0;
+
+    }; // class frame_source
+
+
+    /**
+     * A GIF decoder that produces one frame at a time.
+     *
+     * SDL_image only decodes whole animations, so this has its own decoder. The file is
+     * kept in memory compressed; decoding needs two frame-sized buffers, no matter how
+     * long the animation is. Seeking backwards restarts from the closest frame that
+     * covers the whole image.
+     *
+     * Delays under 20 ms are treated as 100 ms, like browsers do.
+     */
+    class gif_source : public frame_source {
+
+        struct frame_info {
+            std::size_t offset = 0; // image descriptor
+            int left = 0;
+            int top = 0;
+            int width = 0;
+            int height = 0;
+            milliseconds delay{0};
+            Uint8 disposal = 0;
+            int transparent = -1;
+            bool keyframe = false;
+        };
+
+        blob data{nullptr, 0};
+
+        int width = 0;
+        int height = 0;
+        std::array<Uint8, 768> global_palette{};
+
+        vector<frame_info> frames;
+
+        // Decoding state.
+        vector<Uint8> canvas;
+        vector<Uint8> saved;
+        vector<Uint8> indices;
+        int decoded = -1;
+
+
+        void
+        parse();
+
+        void
+        render(unsigned index);
+
+    public:
+
+        /// Takes the whole GIF file.
+        explicit
+        gif_source(blob data);
+
+        explicit
+        gif_source(const path& filename);
+
+        explicit
+        gif_source(rwops& src);
+
+        gif_source(const pack::archive& archive,
+                   std::string_view name);
+
+
+        [[nodiscard]]
+        int
+        get_width()
+            const noexcept override;
+
+        [[nodiscard]]
+        int
+        get_height()
+            const noexcept override;
+
+        [[nodiscard]]
+        unsigned
+        get_count()
+            const noexcept override;
+
+        [[nodiscard]]
+        milliseconds
+        get_delay(unsigned index)
+            const noexcept override;
+
+
+        void
+        decode(unsigned index,
+               Uint8* dst)
+            override;
+
+    }; // class gif_source
+
+
+    /**
+     * Plays an animation by decoding a few frames ahead, on a worker thread.
+     *
+     * Only `window` decoded frames (at least 2) are kept in memory; the displayed frame is
+     * uploaded to a streaming texture. If the next frame isn't decoded when it's due, the
+     * current one stays on screen a bit longer, and it's counted as a stall.
+     *
+     * All methods must be called from the render thread.
+     */
+    class animation_player {
+
+    public:
+
+        static constexpr unsigned default_window = 4;
+
+    private:
+
+        struct slot {
+            blob pixels{nullptr, 0};
+            int frame = -1;
+            bool decoding = false;
+            bool ready = false;
+        };
+
+        unique_ptr<frame_source> source;
+        texture tex;
+        int width;
+        int height;
+        unsigned count;
+
+        mutable std::mutex mutex;
+        std::condition_variable worker_cv;
+
+        // All fields below are guarded by the mutex.
+
+        vector<slot> slots;
+        unsigned current = 0;
+        bool looping = true;
+        bool stop = false;
+        std::optional<error> failure;
+
+        std::thread worker;
+
+        // Only touched by the render thread.
+
+        bool playing = false;
+        int shown = -1;
+        milliseconds elapsed{0};
+        Uint64 stalls = 0;
+
+
+        [[nodiscard]]
+        unsigned
+        distance(unsigned frame)
+            const noexcept;
+
+        [[nodiscard]]
+        bool
+        in_window(int frame)
+            const noexcept;
+
+        [[nodiscard]]
+        slot*
+        find_ready(unsigned frame)
+            noexcept;
+
+        void
+        show(slot& s);
+
+        void
+        run()
+            noexcept;
+
+    public:
+
+        animation_player(renderer& ren,
+                         unique_ptr<frame_source> source,
+                         unsigned window = default_window);
+
+        /// Plays a GIF file.
+        animation_player(renderer& ren,
+                         const path& filename,
+                         unsigned window = default_window);
+
+        // Disallow copies.
+        animation_player(const animation_player&) = delete;
+
+        ~animation_player()
+            noexcept;
+
+
+        void
+        play()
+            noexcept;
+
+        void
+        pause()
+            noexcept;
+
+        [[nodiscard]]
+        bool
+        is_playing()
+            const noexcept;
+
+
+        void
+        set_looping(bool loop)
+            noexcept;
+
+        [[nodiscard]]
+        bool
+        is_looping()
+            const noexcept;
+
+
+        /// Jump to a frame; it's shown once it's decoded.
+        void
+        seek(unsigned frame)
+            noexcept;
+
+
+        /**
+         * Advance the animation, and upload the frame to the texture when it changes.
+         *
+         * Throws the decoder's error, if it failed.
+         */
+        void
+        update(milliseconds dt);
+
+
+        /// The frame the animation is at; it may not be shown yet, after a seek.
+        [[nodiscard]]
+        unsigned
+        get_frame()
+            const noexcept;
+
+        /// True when the texture holds the current frame.
+        [[nodiscard]]
+        bool
+        is_ready()
+            const noexcept;
+
+        [[nodiscard]]
+        unsigned
+        get_count()
+            const noexcept;
+
+        [[nodiscard]]
+        texture&
+        get_texture()
+            noexcept;
+
+        /// How many update() calls held a frame because the next one wasn't decoded.
+        [[nodiscard]]
+        Uint64
+        get_stalls()
+            const noexcept;
+
+    }; // class animation_player
+
+} // namespace sdl::img
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_IMG_ATLAS_HPP
+#define SDL2XX_IMG_ATLAS_HPP
+
+#include <chrono>
+#include <span>
+
+#include "img.hpp"
+#include "rect.hpp"
+#include "renderer.hpp"
+#include "texture.hpp"
+#include "vec2.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::img {
+
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+    using std::chrono::milliseconds;
+
+
+    /**
+     * An animation baked into a single texture.
+     *
+     * All frames go into one atlas page, so drawing a frame is a single copy(), with no
+     * uploads. This is meant for short animations; long ones are better played with
+     * animation_player.
+     *
+     * Fully transparent borders can be trimmed from each frame, and frames with the same
+     * pixels (after trimming) share one area of the page, even if they're drawn at
+     * different offsets.
+     */
+    class animation_atlas {
+
+    public:
+
+        struct options {
+            bool trim = true;
+            bool dedup = true;
+            // Transparent pixels around each frame, so filtering doesn't bleed.
+            int padding = 1;
+        };
+
+        struct frame {
+            // Area in the page; empty if the frame is fully transparent.
+            rect area;
+            // Where the area goes, relative to the animation's top-left corner.
+            vec2 offset;
+            milliseconds start;
+            milliseconds delay;
+        };
+
+    private:
+
+        texture page;
+        vector<frame> frames;
+        int width = 0;
+        int height = 0;
+        unsigned images = 0;
+        milliseconds duration{0};
+
+    public:
+
+        animation_atlas(renderer& ren,
+                        const animation& anim);
+
+        animation_atlas(renderer& ren,
+                        const animation& anim,
+                        const options& opt);
+
+
+        [[nodiscard]]
+        texture&
+        get_texture()
+            noexcept;
+
+        [[nodiscard]]
+        const texture&
+        get_texture()
+            const noexcept;
+
+
+        [[nodiscard]]
+        std::span<const frame>
+        get_frames()
+            const noexcept;
+
+        [[nodiscard]]
+        unsigned
+        get_count()
+            const noexcept;
+
+        /// How many distinct images are in the page.
+        [[nodiscard]]
+        unsigned
+        get_images()
+            const noexcept;
+
+
+        /// Size of the animation, not of the page.
+        [[nodiscard]]
+        int
+        get_width()
+            const noexcept;
+
+        [[nodiscard]]
+        int
+        get_height()
+            const noexcept;
+
+
+        [[nodiscard]]
+        milliseconds
+        get_duration()
+            const noexcept;
+
+        /// The frame shown at time `t`.
+        [[nodiscard]]
+        unsigned
+        find_frame(milliseconds t,
+                   bool loop = true)
+            const noexcept;
+
+
+        /// Draw a frame with the animation's top-left corner at `pos`.
+        void
+        draw(renderer& ren,
+             unsigned index,
+             vec2 pos)
+            const;
+
+        /// Draw a frame with the whole animation scaled to `dst`.
+        void
+        draw(renderer& ren,
+             unsigned index,
+             const rectf& dst)
+            const;
+
+    }; // class animation_atlas
+
+#endif // SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+} // namespace sdl::img
+
+#endif
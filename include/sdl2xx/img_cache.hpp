@@ -0,0 +1,264 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_IMG_CACHE_HPP
+#define SDL2XX_IMG_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string_view>
+
+#include "blob.hpp"
+#include "error.hpp"
+#include "img.hpp"
+#include "pack.hpp"
+#include "string.hpp"
+#include "surface.hpp"
+
+
+namespace sdl::img {
+
+    /**
+     * A surface that may be backed by a file mapping.
+     *
+     * When it comes from the disk cache, the pixels are mapped copy-on-write: they can be
+     * modified, but the changes don't go back to the file.
+     */
+    class cached_surface {
+
+        void* map_base = nullptr;
+        std::size_t map_size = 0;
+
+        // Used when the file is read into memory instead.
+        blob storage{nullptr, 0};
+
+        // Declared last, so it's destroyed before the pixels it points to.
+        surface surf{nullptr, surface::dont_destroy};
+
+
+        friend class decode_cache;
+
+        cached_surface(void* map_base,
+                       std::size_t map_size,
+                       blob storage,
+                       surface surf)
+            noexcept;
+
+        void
+        destroy()
+            noexcept;
+
+    public:
+
+        cached_surface()
+            noexcept = default;
+
+        explicit
+        cached_surface(surface&& surf)
+            noexcept;
+
+        /// Move constructor.
+        cached_surface(cached_surface&& other)
+            noexcept;
+
+        ~cached_surface()
+            noexcept;
+
+        /// Move assignment.
+        cached_surface&
+        operator =(cached_surface&& other)
+            noexcept;
+
+
+        [[nodiscard]]
+        surface&
+        get()
+            noexcept;
+
+        [[nodiscard]]
+        const surface&
+        get()
+            const noexcept;
+
+
+        /// True if the pixels come from the disk cache, instead of a decoder.
+        [[nodiscard]]
+        bool
+        is_cached()
+            const noexcept;
+
+    }; // class cached_surface
+
+
+    /**
+     * Stores decoded images on disk, so later runs don't need to decode them again.
+     *
+     * Images are keyed by an XXH64 hash of the source bytes, their size, and the decode
+     * parameters (the SVG rasterization size). A cache file is a 64-byte header followed by
+     * the raw pixels, so on a hit the file is mapped and used as the surface's pixels
+     * directly. Paletted images are converted to RGBA32 before being stored.
+     *
+     * The files use the native byte order and layout; the cache directory is not meant to
+     * be shared between machines. Writes go through a temporary file and a rename, so
+     * several processes can share a directory. Failing to write a cache file is not an
+     * error, the decoded image is still returned.
+     *
+     * All methods can be called from any thread.
+     */
+    class decode_cache {
+
+    public:
+
+        struct stats {
+            Uint64 hits = 0;
+            Uint64 misses = 0;
+            Uint64 stores = 0;
+        };
+
+    private:
+
+        path directory;
+
+        std::atomic<Uint64> hits = 0;
+        std::atomic<Uint64> misses = 0;
+        std::atomic<Uint64> stores = 0;
+
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_get(std::span<const Uint8> data,
+                int width,
+                int height)
+            noexcept;
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_map(const path& filename,
+                Uint64 hash,
+                Uint64 size)
+            noexcept;
+
+        bool
+        store(const path& filename,
+              const surface& surf,
+              Uint64 hash,
+              Uint64 size)
+            noexcept;
+
+    public:
+
+        static constexpr std::string_view extension = ".sdlsurf";
+
+
+        /// Creates the directory if needed.
+        explicit
+        decode_cache(const path& directory);
+
+
+        [[nodiscard]]
+        const path&
+        get_directory()
+            const noexcept;
+
+
+        [[nodiscard]]
+        cached_surface
+        load(const path& filename);
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_load(const path& filename)
+            noexcept;
+
+        [[nodiscard]]
+        cached_surface
+        load(const pack::archive& archive,
+             std::string_view name);
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_load(const pack::archive& archive,
+                 std::string_view name)
+            noexcept;
+
+        /// Decode from memory.
+        [[nodiscard]]
+        cached_surface
+        load(std::span<const Uint8> data);
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_load(std::span<const Uint8> data)
+            noexcept;
+
+
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+        /// Each rasterization size is cached separately.
+        [[nodiscard]]
+        cached_surface
+        load_svg(const path& filename,
+                 int width,
+                 int height);
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_load_svg(const path& filename,
+                     int width,
+                     int height)
+            noexcept;
+
+        [[nodiscard]]
+        cached_surface
+        load_svg(const pack::archive& archive,
+                 std::string_view name,
+                 int width,
+                 int height);
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_load_svg(const pack::archive& archive,
+                     std::string_view name,
+                     int width,
+                     int height)
+            noexcept;
+
+        [[nodiscard]]
+        cached_surface
+        load_svg(std::span<const Uint8> data,
+                 int width,
+                 int height);
+
+        [[nodiscard]]
+        std::expected<cached_surface, error>
+        try_load_svg(std::span<const Uint8> data,
+                     int width,
+                     int height)
+            noexcept;
+
+#endif // SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+
+        /// Delete every cache file in the directory.
+        void
+        clear()
+            noexcept;
+
+
+        [[nodiscard]]
+        stats
+        get_stats()
+            const noexcept;
+
+    }; // class decode_cache
+
+} // namespace sdl::img
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_IMG_CAPTURE_HPP
+#define SDL2XX_IMG_CAPTURE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+#include <SDL_stdinc.h>
+
+#include "error.hpp"
+#include "img.hpp"
+#include "pixels.hpp"
+#include "rect.hpp"
+#include "renderer.hpp"
+#include "surface.hpp"
+#include "thread_pool.hpp"
+#include "unique_ptr.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::img {
+
+    /**
+     * Captures rendered frames, and hands them to a thread pool.
+     *
+     * SDL2 can only read pixels back synchronously, so the render thread still waits for
+     * the GPU in capture(); that's all it does there. The pixels are read in the render
+     * target's format (the window's pixel format, or the target texture's), the one
+     * SDL_RenderReadPixels() picks by default, into one of a fixed ring of staging
+     * surfaces, which are reused from frame to frame. The conversion to the requested
+     * format and the frame function run on the pool.
+     *
+     * When every staging surface is busy, because the pool fell behind, the frame is
+     * dropped and counted: the render thread never waits for the pool, and the memory
+     * used doesn't grow.
+     *
+     * The frame function is called from the pool's threads; with more than one thread,
+     * frames may be handled out of order. The pool must outlive the capture.
+     */
+    class frame_capture {
+
+    public:
+
+        /// The frame is only valid during the call.
+        using frame_function = std::function<void (Uint64 index, const surface& frame)>;
+
+        struct options {
+            std::size_t num_slots = 4;
+            // Format given to the frame function; unknown keeps the target's format.
+            pixels::format_enum format = pixels::format_enum::rgba_32;
+            // Area of the render target; empty captures all of it.
+            std::optional<rect> area;
+        };
+
+        struct stats {
+            Uint64 captured = 0;
+            Uint64 dropped = 0;
+            // The read back, or the frame function, failed.
+            Uint64 failed = 0;
+            // Time spent on the render thread by capture(), dropped frames included.
+            std::chrono::nanoseconds last_cost{0};
+            std::chrono::nanoseconds max_cost{0};
+            std::chrono::nanoseconds total_cost{0};
+        };
+
+    private:
+
+        struct slot;
+
+        thread_pool* pool;
+        frame_function func;
+        options opt;
+
+        vector<unique_ptr<slot>> slots;
+
+        // Only touched by the render thread.
+        Uint64 next_index = 0;
+
+        mutable std::mutex mutex;
+        std::condition_variable idle_cv;
+
+        // All fields below are guarded by the mutex.
+
+        vector<slot*> free_slots;
+        std::size_t in_flight = 0;
+        stats counters;
+
+
+        void
+        process(slot& s,
+                Uint64 index)
+            noexcept;
+
+        void
+        release(slot& s,
+                bool ok)
+            noexcept;
+
+    public:
+
+        frame_capture(thread_pool& pool,
+                      frame_function func);
+
+        frame_capture(thread_pool& pool,
+                      frame_function func,
+                      const options& opt);
+
+        // Disallow copies.
+        frame_capture(const frame_capture&) = delete;
+
+        /// Waits until every captured frame is handled.
+        ~frame_capture()
+            noexcept;
+
+
+        /**
+         * Read back the current render target; call it before present().
+         *
+         * Returns false if the frame was dropped.
+         */
+        bool
+        capture(renderer& ren);
+
+        std::expected<bool, error>
+        try_capture(renderer& ren)
+            noexcept;
+
+
+        /// Block until every captured frame is handled.
+        void
+        wait()
+            noexcept;
+
+        /// How many frames are not handled yet.
+        [[nodiscard]]
+        std::size_t
+        get_pending()
+            const noexcept;
+
+
+        [[nodiscard]]
+        stats
+        get_stats()
+            const noexcept;
+
+        void
+        reset_stats()
+            noexcept;
+
+
+        /// A frame function that saves each frame as `<prefix><index>.png`.
+        [[nodiscard]]
+        static
+        frame_function
+        save_png_files(const path& prefix);
+
+    }; // class frame_capture
+
+} // namespace sdl::img
+
+#endif
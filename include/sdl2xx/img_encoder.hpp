@@ -0,0 +1,162 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_IMG_ENCODER_HPP
+#define SDL2XX_IMG_ENCODER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "error.hpp"
+#include "img.hpp"
+#include "rwops.hpp"
+#include "surface.hpp"
+#include "thread_pool.hpp"
+
+
+namespace sdl::img {
+
+    /**
+     * Encodes images on a thread pool.
+     *
+     * The surface is taken by value, as a snapshot: pass a copy to keep using the
+     * original. The destination can be any rwops; it's closed when the image is written.
+     *
+     * A PNG is split in bands of rows, and each band is filtered and deflated by a
+     * separate task, like parallel deflate does; the bands are written in order as soon
+     * as they're ready. This needs zlib; without it, PNGs are saved by SDL_image in a
+     * single task. JPGs are always saved by SDL_image, one task per image.
+     *
+     * The done callbacks are called from the pool's threads. The pool must outlive the
+     * encoder.
+     */
+    class encoder {
+
+    public:
+
+        enum class preset : Uint8 {
+            fast,
+            normal,
+            best,
+        };
+
+        struct png_options {
+            preset compression = preset::normal;
+            // Rows compressed by each task; 0 picks a size from the image and the pool.
+            int band_rows = 0;
+        };
+
+        using done_function = std::function<void (std::expected<void, error>)>;
+
+    private:
+
+        struct job;
+
+        thread_pool* pool;
+
+        mutable std::mutex mutex;
+        std::condition_variable idle_cv;
+
+        // All fields below are guarded by the mutex.
+
+        // Images that didn't finish.
+        std::size_t in_flight = 0;
+
+
+        void
+        start(std::shared_ptr<job> j);
+
+        void
+        prepare(const std::shared_ptr<job>& j)
+            noexcept;
+
+        void
+        run_band(const std::shared_ptr<job>& j,
+                 std::size_t index)
+            noexcept;
+
+        void
+        finish(job& j,
+               std::expected<void, error> result)
+            noexcept;
+
+    public:
+
+        explicit
+        encoder(thread_pool& pool)
+            noexcept;
+
+        // Disallow copies.
+        encoder(const encoder&) = delete;
+
+        /// Waits until every image is written.
+        ~encoder()
+            noexcept;
+
+
+        void
+        save_png(surface src,
+                 rwops&& dst,
+                 done_function done);
+
+        void
+        save_png(surface src,
+                 rwops&& dst,
+                 const png_options& opt,
+                 done_function done);
+
+        [[nodiscard]]
+        std::future<void>
+        save_png(surface src,
+                 rwops&& dst);
+
+        [[nodiscard]]
+        std::future<void>
+        save_png(surface src,
+                 rwops&& dst,
+                 const png_options& opt);
+
+
+#if SDL_IMAGE_VERSION_ATLEAST(2, 0, 2)
+
+        void
+        save_jpg(surface src,
+                 rwops&& dst,
+                 int quality,
+                 done_function done);
+
+        [[nodiscard]]
+        std::future<void>
+        save_jpg(surface src,
+                 rwops&& dst,
+                 int quality);
+
+#endif // SDL_IMAGE_VERSION_ATLEAST(2, 0, 2)
+
+
+        /// Block until every image is written.
+        void
+        wait()
+            noexcept;
+
+        /// How many images are not written yet.
+        [[nodiscard]]
+        std::size_t
+        get_pending()
+            const noexcept;
+
+    }; // class encoder
+
+} // namespace sdl::img
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_IMG_LOADER_HPP
+#define SDL2XX_IMG_LOADER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "error.hpp"
+#include "img.hpp"
+#include "pack.hpp"
+#include "renderer.hpp"
+#include "rwops.hpp"
+#include "string.hpp"
+#include "surface.hpp"
+#include "texture.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::img {
+
+    /**
+     * Loads textures in the background.
+     *
+     * Images are decoded into surfaces by the thread pool; creating the textures is done
+     * by update(), which must be called from the render thread. Each update() call only
+     * uploads up to the byte budget, so a level load doesn't cause a long frame; at least
+     * one texture is uploaded per call, even if it's over budget.
+     *
+     * Requests with a higher priority are decoded and uploaded first. The ready callbacks
+     * are called from update(). All methods must be called from the render thread.
+     */
+    class loader {
+
+    public:
+
+        using request_id = Uint64;
+
+        using ready_function = std::function<void (std::expected<texture, error>)>;
+
+        /// A request whose result is delivered through a future.
+        struct pending {
+            request_id id = 0;
+            std::future<texture> result;
+        };
+
+        static constexpr std::size_t default_upload_budget = 8 * 1024 * 1024;
+
+    private:
+
+        struct source {
+            path filename;
+            const pack::archive* archive = nullptr;
+            string name;
+            std::optional<rwops> src;
+        };
+
+        struct request {
+            int priority = 0;
+            ready_function func;
+            source src;
+            thread_pool::task_id task = 0;
+        };
+
+        struct decoded {
+            request_id id;
+            int priority;
+            std::expected<surface, error> value;
+        };
+
+        thread_pool* pool;
+
+        mutable std::mutex mutex;
+        std::condition_variable idle_cv;
+
+        // All fields below are guarded by the mutex.
+
+        std::size_t upload_budget;
+        request_id next_id = 0;
+
+        // Pool tasks that were submitted, and didn't return or get cancelled.
+        unsigned in_flight = 0;
+
+        // Requests that didn't finish.
+        std::unordered_map<request_id, request> requests;
+
+        // Decoded surfaces waiting for update().
+        vector<decoded> ready;
+
+
+        [[nodiscard]]
+        static
+        std::expected<surface, error>
+        decode(source& src)
+            noexcept;
+
+
+        request_id
+        enqueue(source src,
+                ready_function func,
+                int priority);
+
+        pending
+        enqueue(source src,
+                int priority);
+
+        void
+        run(request_id id)
+            noexcept;
+
+    public:
+
+        /// The pool must outlive the loader.
+        explicit
+        loader(thread_pool& pool,
+               std::size_t upload_budget = default_upload_budget)
+            noexcept;
+
+        // Disallow copies.
+        loader(const loader&) = delete;
+
+        /// Cancels everything, and waits for the decodes in progress.
+        ~loader()
+            noexcept;
+
+
+        request_id
+        load(const path& filename,
+             ready_function func,
+             int priority = 0);
+
+        /// Takes ownership of the source.
+        request_id
+        load(rwops&& src,
+             ready_function func,
+             int priority = 0);
+
+        /// The archive must outlive the loader.
+        request_id
+        load(const pack::archive& archive,
+             std::string_view name,
+             ready_function func,
+             int priority = 0);
+
+
+        /// Don't wait on the future from the render thread, it's only set by update().
+        [[nodiscard]]
+        pending
+        load(const path& filename,
+             int priority = 0);
+
+        [[nodiscard]]
+        pending
+        load(rwops&& src,
+             int priority = 0);
+
+        [[nodiscard]]
+        pending
+        load(const pack::archive& archive,
+             std::string_view name,
+             int priority = 0);
+
+
+        /**
+         * Cancel a request that didn't finish yet; returns true if it was cancelled.
+         *
+         * The callback is not called; a future gets a broken promise.
+         */
+        bool
+        cancel(request_id id)
+            noexcept;
+
+        void
+        cancel_all()
+            noexcept;
+
+
+        /// Create textures from decoded images; returns how many requests finished.
+        std::size_t
+        update(renderer& ren);
+
+
+        void
+        set_upload_budget(std::size_t bytes)
+            noexcept;
+
+        [[nodiscard]]
+        std::size_t
+        get_upload_budget()
+            const noexcept;
+
+        /// How many requests didn't finish yet.
+        [[nodiscard]]
+        std::size_t
+        get_pending()
+            const noexcept;
+
+    }; // class loader
+
+} // namespace sdl::img
+
+#endif
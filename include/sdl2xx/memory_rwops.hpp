@@ -0,0 +1,106 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_MEMORY_RWOPS_HPP
+#define SDL2XX_MEMORY_RWOPS_HPP
+
+#include <cstddef>
+#include <span>
+
+#include <SDL_rwops.h>
+
+#include "blob.hpp"
+#include "rwops.hpp"
+
+
+namespace sdl {
+
+    /**
+     * A rwops that reads and writes memory, with 64-bit sizes.
+     *
+     * When it owns its buffer, writes past the end grow the buffer geometrically,
+     * using SDL_realloc(); the contents can then be taken with release_blob(),
+     * without copying.
+     *
+     * When created from a span, it's a fixed-size view into the caller's memory.
+     */
+    struct memory_rwops : rwops {
+
+        /// Create an empty, growable buffer.
+        explicit
+        memory_rwops(std::size_t capacity = 0);
+
+        /// Take ownership of the blob; writes start at the beginning.
+        explicit
+        memory_rwops(blob data);
+
+        /// Fixed-size view; the memory must outlive this object.
+        explicit
+        memory_rwops(std::span<Uint8> mem);
+
+        /// Read-only view; the memory must outlive this object.
+        explicit
+        memory_rwops(std::span<const Uint8> mem);
+
+
+        /// Move constructor.
+        memory_rwops(memory_rwops&& other)
+            noexcept = default;
+
+
+        /// Move assignment.
+        memory_rwops&
+        operator =(memory_rwops&& other)
+            noexcept = default;
+
+
+        void
+        create(std::size_t capacity = 0);
+
+        void
+        create(blob data);
+
+        void
+        create(std::span<Uint8> mem);
+
+        void
+        create(std::span<const Uint8> mem);
+
+
+        /// The bytes written so far (or the whole view).
+        [[nodiscard]]
+        std::span<const Uint8>
+        get_data()
+            const noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_capacity()
+            const noexcept;
+
+
+        /// Grow the buffer so it can hold at least `capacity` bytes.
+        void
+        reserve(std::size_t capacity);
+
+
+        /**
+         * Hand over the contents as a blob.
+         *
+         * The rwops is left empty, and can keep being written to.
+         */
+        [[nodiscard]]
+        blob
+        release_blob();
+
+    }; // struct memory_rwops
+
+} // namespace sdl
+
+#endif
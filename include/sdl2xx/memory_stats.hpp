@@ -0,0 +1,147 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_MEMORY_STATS_HPP
+#define SDL2XX_MEMORY_STATS_HPP
+
+#include <array>
+#include <cstddef>
+#include <expected>
+
+#include <SDL_stdinc.h>
+
+#include "error.hpp"
+
+
+/**
+ * Allocation statistics.
+ *
+ * Tracking installs wrappers with SDL_SetMemoryFunctions(), so it sees every
+ * allocation made by SDL, its satellite libraries, and sdl2xx's own allocator. Each
+ * allocation is attributed to the tag that was active in the allocating thread.
+ *
+ * The library opens the surface, texture, audio, ttf and img tags itself, around the
+ * calls that allocate: creating and converting surfaces, creating, updating and locking
+ * textures, opening audio devices, streams and converters, rendering text, and loading
+ * images. The innermost tag_scope wins, so those replace the caller's tag during the
+ * call; `user` is never set by the library.
+ */
+namespace sdl::memory {
+
+    enum class tag : Uint8 {
+        none,
+        surface,
+        texture,
+        audio,
+        ttf,
+        img,
+        user,
+    };
+
+    inline constexpr std::size_t num_tags = 7;
+
+
+    /// Size class `i` counts allocations of `[2^(i-1), 2^i)` bytes; the last one is open.
+    inline constexpr std::size_t num_size_classes = 32;
+
+
+    struct stats {
+        Uint64 allocations     = 0;
+        Uint64 deallocations   = 0;
+        Uint64 reallocations   = 0;
+        Uint64 bytes_allocated = 0; // cumulative
+        Uint64 bytes_in_use    = 0;
+        Uint64 peak_bytes      = 0;
+        Uint64 budget          = 0; // 0 means no budget
+        Uint64 over_budget     = 0; // allocations that exceeded the budget
+        std::array<Uint64, num_size_classes> size_classes{};
+    };
+
+
+    struct snapshot {
+
+        stats total;
+        std::array<stats, num_tags> tags;
+
+
+        [[nodiscard]]
+        const stats&
+        operator [](tag t)
+            const noexcept;
+
+    };
+
+
+    /**
+     * Start tracking allocations.
+     *
+     * Must be called before SDL allocates anything (so, before SDL_Init()); once
+     * started, tracking can't be stopped.
+     */
+    void
+    start_tracking();
+
+    std::expected<void, error>
+    try_start_tracking()
+        noexcept;
+
+
+    [[nodiscard]]
+    bool
+    is_tracking()
+        noexcept;
+
+
+    [[nodiscard]]
+    snapshot
+    get_snapshot()
+        noexcept;
+
+
+    /// Set the peaks to the current usage.
+    void
+    reset_peaks()
+        noexcept;
+
+
+    /// Count allocations that push the tag's usage above `bytes`; 0 disables it.
+    void
+    set_budget(tag t,
+               Uint64 bytes)
+        noexcept;
+
+
+    /// The calling thread's current tag.
+    [[nodiscard]]
+    tag
+    get_tag()
+        noexcept;
+
+
+    /// Attribute the calling thread's allocations to a tag, while in scope.
+    class tag_scope {
+
+        tag previous;
+
+    public:
+
+        explicit
+        tag_scope(tag t)
+            noexcept;
+
+        ~tag_scope()
+            noexcept;
+
+
+        tag_scope(const tag_scope&) = delete;
+
+    }; // class tag_scope
+
+} // namespace sdl::memory
+
+#endif
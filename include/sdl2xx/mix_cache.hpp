@@ -0,0 +1,258 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_MIX_CACHE_HPP
+#define SDL2XX_MIX_CACHE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "error.hpp"
+#include "mix.hpp"
+#include "pack.hpp"
+#include "string.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::mix {
+
+    /**
+     * Decodes each sound once, and shares the chunk between everyone who loads it.
+     *
+     * Sounds are keyed by file name, or by pack archive and entry name; they're decoded
+     * by SDL_mixer, into the format the mixer was opened with. When the decoded size goes
+     * over the budget, the least recently used sounds that nobody holds a handle to are
+     * evicted. Sounds that are still referenced are never evicted, even over budget.
+     *
+     * Async loads are decoded on a worker thread; the ready callbacks are called from
+     * update(), on the thread that calls it. All other methods must be called from the
+     * same thread as well.
+     *
+     * Freeing a chunk halts the channels playing it, so keep the handle while the sound
+     * plays.
+     */
+    class sound_cache {
+
+    public:
+
+        using handle = std::shared_ptr<chunk>;
+
+        using ready_function = std::function<void (std::expected<handle, error>)>;
+
+        struct stats {
+            Uint64 hits = 0;
+            Uint64 misses = 0;
+            Uint64 evictions = 0;
+        };
+
+        static constexpr std::size_t default_budget = 64 * 1024 * 1024;
+
+    private:
+
+        struct key_hash {
+            using is_transparent = void;
+
+            std::size_t
+            operator ()(std::string_view key)
+                const noexcept;
+        };
+
+        struct entry {
+            handle sound;
+            std::size_t bytes = 0;
+            Uint64 last_use = 0;
+            bool pending = false;
+            vector<ready_function> waiters;
+        };
+
+        struct source {
+            path filename;
+            const pack::archive* archive = nullptr;
+            string name;
+        };
+
+        struct job {
+            string key;
+            source src;
+        };
+
+        struct result {
+            ready_function func;
+            std::expected<handle, error> value;
+        };
+
+        mutable std::mutex mutex;
+        std::condition_variable decoded_cv;
+        std::condition_variable jobs_cv;
+
+        // All fields below are guarded by the mutex.
+
+        std::size_t budget;
+        std::size_t memory = 0;
+        Uint64 clock = 0;
+        stats counters;
+
+        std::unordered_map<string, entry, key_hash, std::equal_to<>> entries;
+
+        std::deque<job> jobs;
+        vector<result> results;
+        bool stop = false;
+
+        std::thread worker;
+
+
+        [[nodiscard]]
+        static
+        string
+        make_key(const path& filename);
+
+        [[nodiscard]]
+        static
+        string
+        make_key(const pack::archive& archive,
+                 std::string_view name);
+
+        [[nodiscard]]
+        static
+        std::expected<handle, error>
+        decode(const source& src)
+            noexcept;
+
+
+        [[nodiscard]]
+        std::expected<handle, error>
+        try_get(string key,
+                const source& src)
+            noexcept;
+
+        void
+        get_async(string key,
+                  source src,
+                  ready_function func);
+
+        void
+        finish(const string& key,
+               std::expected<handle, error> value)
+            noexcept;
+
+        void
+        run()
+            noexcept;
+
+        void
+        trim()
+            noexcept;
+
+    public:
+
+        explicit
+        sound_cache(std::size_t budget = default_budget);
+
+        // Disallow copies.
+        sound_cache(const sound_cache&) = delete;
+
+        /// Pending async loads are abandoned, without calling their callbacks.
+        ~sound_cache()
+            noexcept;
+
+
+        [[nodiscard]]
+        handle
+        load(const path& filename);
+
+        [[nodiscard]]
+        std::expected<handle, error>
+        try_load(const path& filename)
+            noexcept;
+
+        /// The archive must outlive the cache.
+        [[nodiscard]]
+        handle
+        load(const pack::archive& archive,
+             std::string_view name);
+
+        [[nodiscard]]
+        std::expected<handle, error>
+        try_load(const pack::archive& archive,
+                 std::string_view name)
+            noexcept;
+
+
+        /// If the sound is already decoded, `func` is still only called from update().
+        void
+        load_async(const path& filename,
+                   ready_function func);
+
+        /// The archive must outlive the cache.
+        void
+        load_async(const pack::archive& archive,
+                   std::string_view name,
+                   ready_function func);
+
+
+        /// Call the ready callbacks of finished async loads; returns how many were called.
+        std::size_t
+        update();
+
+
+        /// The cached sound, if decoded, without loading it.
+        [[nodiscard]]
+        handle
+        find(const path& filename);
+
+        [[nodiscard]]
+        handle
+        find(const pack::archive& archive,
+             std::string_view name);
+
+
+        /// Evict every sound that isn't referenced.
+        void
+        purge()
+            noexcept;
+
+
+        void
+        set_budget(std::size_t bytes)
+            noexcept;
+
+        [[nodiscard]]
+        std::size_t
+        get_budget()
+            const noexcept;
+
+        /// Decoded bytes held by the cache, including referenced sounds.
+        [[nodiscard]]
+        std::size_t
+        get_memory()
+            const noexcept;
+
+        [[nodiscard]]
+        std::size_t
+        size()
+            const noexcept;
+
+
+        [[nodiscard]]
+        stats
+        get_stats()
+            const noexcept;
+
+    }; // class sound_cache
+
+} // namespace sdl::mix
+
+#endif
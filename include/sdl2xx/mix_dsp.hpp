@@ -0,0 +1,593 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_MIX_DSP_HPP
+#define SDL2XX_MIX_DSP_HPP
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include <SDL_mixer.h>
+
+#include "mix.hpp"
+#include "unique_ptr.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::mix {
+
+    class effect_chain;
+
+
+    /**
+     * A node in an effect_chain, processing interleaved float samples.
+     *
+     * Setters can be called from any thread: parameters are atomics, and the audio
+     * thread picks up the changes at the start of the next block. Everything the node
+     * needs is allocated in prepare(), before the chain is attached.
+     */
+    class effect {
+
+        friend class effect_chain;
+
+        std::atomic<bool> enabled{true};
+        std::atomic<Uint32> version{0};
+        Uint32 seen_version = -1;
+
+    protected:
+
+        int rate = 0;
+        unsigned channels = 0;
+        std::size_t max_frames = 0;
+
+
+        /// Call after changing a parameter.
+        void
+        touch()
+            noexcept;
+
+        /// Audio thread: true if a parameter changed since the last call.
+        [[nodiscard]]
+        bool
+        changed()
+            noexcept;
+
+
+        /// Allocate buffers; `rate`, `channels` and `max_frames` are already set.
+        virtual
+        void
+        prepare();
+
+        /// Clear the internal state; called before the chain is attached.
+        virtual
+        void
+        reset()
+            noexcept;
+
+        /// Audio thread: process up to `max_frames` frames in place.
+        virtual
+        void
+        process(float* samples,
+                std::size_t frames)
+            noexcept = 0;
+
+        /// Audio thread: called once the whole buffer was processed.
+        virtual
+        void
+        finish()
+            noexcept;
+
+    public:
+
+        effect()
+            noexcept = default;
+
+        // Disallow copies.
+        effect(const effect&) = delete;
+
+        virtual
+        ~effect()
+            noexcept = default;
+
+
+        /// A disabled node lets the audio through.
+        void
+        set_enabled(bool enable)
+            noexcept;
+
+        [[nodiscard]]
+        bool
+        is_enabled()
+            const noexcept;
+
+    }; // class effect
+
+
+    /// RBJ-style second order filter.
+    class biquad : public effect {
+
+    public:
+
+        enum class type {
+            band_pass,
+            high_pass,
+            high_shelf,
+            low_pass,
+            low_shelf,
+            notch,
+            peaking,
+        };
+
+    private:
+
+        std::atomic<type> kind;
+        std::atomic<float> frequency;
+        std::atomic<float> q;
+        std::atomic<float> gain_db;
+
+        float b0 = 1;
+        float b1 = 0;
+        float b2 = 0;
+        float a1 = 0;
+        float a2 = 0;
+        vector<float> z1;
+        vector<float> z2;
+
+
+        void
+        prepare()
+            override;
+
+        void
+        reset()
+            noexcept override;
+
+        void
+        process(float* samples,
+                std::size_t frames)
+            noexcept override;
+
+    public:
+
+        explicit
+        biquad(type t = type::peaking,
+               float frequency = 1000,
+               float q = 0.7071f,
+               float gain_db = 0)
+            noexcept;
+
+
+        void
+        set_type(type t)
+            noexcept;
+
+        /// In Hz.
+        void
+        set_frequency(float hz)
+            noexcept;
+
+        void
+        set_q(float q)
+            noexcept;
+
+        /// Only used by the peaking and shelf filters.
+        void
+        set_gain(float db)
+            noexcept;
+
+
+        [[nodiscard]]
+        type
+        get_type()
+            const noexcept;
+
+        [[nodiscard]]
+        float
+        get_frequency()
+            const noexcept;
+
+        [[nodiscard]]
+        float
+        get_q()
+            const noexcept;
+
+        [[nodiscard]]
+        float
+        get_gain()
+            const noexcept;
+
+    }; // class biquad
+
+
+    /**
+     * One-pole low-pass filter, meant for occlusion.
+     *
+     * Cutoff changes are ramped over a block, so moving sources don't produce zipper
+     * noise.
+     */
+    class low_pass : public effect {
+
+        std::atomic<float> cutoff;
+
+        float target = 1;
+        float coef = 1;
+        vector<float> state;
+
+
+        void
+        prepare()
+            override;
+
+        void
+        reset()
+            noexcept override;
+
+        void
+        process(float* samples,
+                std::size_t frames)
+            noexcept override;
+
+    public:
+
+        explicit
+        low_pass(float cutoff = 20000)
+            noexcept;
+
+
+        /// In Hz.
+        void
+        set_cutoff(float hz)
+            noexcept;
+
+        /// From 0 (no occlusion, 20 kHz cutoff) to 1 (fully occluded, 400 Hz cutoff).
+        void
+        set_occlusion(float amount)
+            noexcept;
+
+        [[nodiscard]]
+        float
+        get_cutoff()
+            const noexcept;
+
+    }; // class low_pass
+
+
+    /**
+     * Feed-forward peak compressor, with the channels linked.
+     */
+    class compressor : public effect {
+
+        std::atomic<float> threshold_db;
+        std::atomic<float> ratio;
+        std::atomic<float> attack_ms;
+        std::atomic<float> release_ms;
+        std::atomic<float> makeup_db;
+        std::atomic<float> reduction_db{0};
+
+        float slope = 0;
+        float attack_coef = 0;
+        float release_coef = 0;
+        float envelope = 0; // gain reduction, in dB
+
+
+        void
+        reset()
+            noexcept override;
+
+        void
+        process(float* samples,
+                std::size_t frames)
+            noexcept override;
+
+    public:
+
+        explicit
+        compressor(float threshold_db = -12,
+                   float ratio = 4,
+                   float attack_ms = 5,
+                   float release_ms = 100,
+                   float makeup_db = 0)
+            noexcept;
+
+
+        void
+        set_threshold(float db)
+            noexcept;
+
+        /// Use infinity for limiting.
+        void
+        set_ratio(float ratio)
+            noexcept;
+
+        void
+        set_attack(float ms)
+            noexcept;
+
+        void
+        set_release(float ms)
+            noexcept;
+
+        void
+        set_makeup(float db)
+            noexcept;
+
+
+        /// Current gain reduction, in dB, for metering.
+        [[nodiscard]]
+        float
+        get_reduction()
+            const noexcept;
+
+    }; // class compressor
+
+
+    /**
+     * A compressor with infinite ratio and instant attack: peaks never go above the
+     * ceiling. There's no lookahead, so the attack can distort.
+     */
+    class limiter : public compressor {
+
+    public:
+
+        explicit
+        limiter(float ceiling_db = -1,
+                float release_ms = 50)
+            noexcept;
+
+    }; // class limiter
+
+
+    /**
+     * A shared reverb, placed in the post-mix chain.
+     *
+     * Channel chains feed it through reverb_send nodes; the reverb output is added to the
+     * post-mix buffer. This is a Schroeder-Moorer reverb: 4 damped combs and 2 allpasses
+     * per channel, with the right channels slightly detuned for width.
+     */
+    class reverb_bus : public effect {
+
+        friend class reverb_send;
+
+        std::atomic<float> room_size;
+        std::atomic<float> damping;
+        std::atomic<float> wet;
+
+        float feedback = 0;
+        float damp = 0;
+        float gain = 0;
+
+        struct line {
+            std::size_t offset;
+            std::size_t size;
+            std::size_t pos;
+            float filter;
+        };
+
+        vector<float> delays;
+        vector<line> lines; // per channel: 4 combs, then 2 allpasses
+
+        // Only touched by the audio thread.
+        vector<float> bus;
+        std::size_t used = 0; // frames
+        std::size_t read_pos = 0;
+        Uint64 generation = 0;
+
+
+        void
+        prepare()
+            override;
+
+        void
+        reset()
+            noexcept override;
+
+        void
+        process(float* samples,
+                std::size_t frames)
+            noexcept override;
+
+        void
+        finish()
+            noexcept override;
+
+    public:
+
+        explicit
+        reverb_bus(float room_size = 0.5f,
+                   float damping = 0.5f,
+                   float wet = 0.3f)
+            noexcept;
+
+
+        /// From 0 to 1.
+        void
+        set_room_size(float size)
+            noexcept;
+
+        /// From 0 to 1.
+        void
+        set_damping(float damping)
+            noexcept;
+
+        void
+        set_wet(float level)
+            noexcept;
+
+    }; // class reverb_bus
+
+
+    /**
+     * Sends a copy of the channel to a reverb_bus, leaving the channel unchanged.
+     *
+     * The send is pre-fader: the channel volume is applied by SDL_mixer after the
+     * effects.
+     */
+    class reverb_send : public effect {
+
+        reverb_bus& target;
+        std::atomic<float> level;
+
+        std::size_t cursor = 0;
+        Uint64 generation = 0;
+        bool fresh = true;
+
+
+        void
+        reset()
+            noexcept override;
+
+        void
+        process(float* samples,
+                std::size_t frames)
+            noexcept override;
+
+    public:
+
+        explicit
+        reverb_send(reverb_bus& target,
+                    float level = 0.5f)
+            noexcept;
+
+
+        void
+        set_level(float level)
+            noexcept;
+
+        [[nodiscard]]
+        float
+        get_level()
+            const noexcept;
+
+    }; // class reverb_send
+
+
+    /**
+     * A list of effects, attached to a channel or to the post-mix.
+     *
+     * The mixer samples are converted to float, processed in blocks of up to
+     * `max_frames` frames, and converted back; no allocation or locking happens in the
+     * audio thread. Nodes are added while the chain is detached, and live as long as the
+     * chain.
+     *
+     * SDL_mixer removes channel effects when the channel stops, so attach() must be
+     * called again after each play. A channel must not have more than one chain.
+     */
+    class effect_chain {
+
+        spec sp;
+        std::size_t max_frames;
+        vector<unique_ptr<effect>> nodes;
+        vector<float> scratch;
+
+        std::optional<unsigned> channel;
+        std::atomic<bool> attached{false};
+        std::atomic<bool> bypass{false};
+
+
+        static
+        void
+        SDLCALL
+        channel_trampoline(int chan,
+                           void* stream,
+                           int len,
+                           void* ctx)
+            noexcept;
+
+        static
+        void
+        SDLCALL
+        done_trampoline(int chan,
+                        void* ctx)
+            noexcept;
+
+        static
+        void
+        SDLCALL
+        post_mix_trampoline(void* ctx,
+                            Uint8* stream,
+                            int len)
+            noexcept;
+
+
+        void
+        run(void* stream,
+            std::size_t bytes)
+            noexcept;
+
+        effect&
+        insert(unique_ptr<effect> node);
+
+    public:
+
+        static constexpr std::size_t default_max_frames = 4096;
+
+
+        /// The mixer must be open; `max_frames` should be at least the mixer chunk size.
+        explicit
+        effect_chain(std::size_t max_frames = default_max_frames);
+
+
+        // Disallow copies.
+        effect_chain(const effect_chain&) = delete;
+
+
+        ~effect_chain()
+            noexcept;
+
+
+        template<std::derived_from<effect> E,
+                 typename... Args>
+        E&
+        add(Args&&... args)
+        {
+            auto node = make_unique<E>(std::forward<Args>(args)...);
+            return static_cast<E&>(insert(unique_ptr<effect>{node.release()}));
+        }
+
+
+        void
+        attach(unsigned channel);
+
+        void
+        attach_post_mix();
+
+        void
+        detach()
+            noexcept;
+
+        /// False after detach(), or after the channel stopped playing.
+        [[nodiscard]]
+        bool
+        is_attached()
+            const noexcept;
+
+
+        /// Skip every node, without detaching.
+        void
+        set_bypass(bool enable)
+            noexcept;
+
+
+        [[nodiscard]]
+        const spec&
+        get_spec()
+            const noexcept;
+
+        [[nodiscard]]
+        std::size_t
+        get_max_frames()
+            const noexcept;
+
+    }; // class effect_chain
+
+} // namespace sdl::mix
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_MIX_MUSIC_HPP
+#define SDL2XX_MIX_MUSIC_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include "async_rwops.hpp"
+#include "mix.hpp"
+#include "pack.hpp"
+#include "rwops.hpp"
+
+
+namespace sdl::mix {
+
+    /**
+     * Music that owns its source, and reads it through a prefetching async_rwops.
+     *
+     * SDL_mixer reads music from the audio thread while it plays; here those reads come
+     * from memory that a background thread keeps filled, so slow storage doesn't cause
+     * glitches. The prefetch is given as a duration, and converted to bytes using the
+     * highest expected bitrate.
+     *
+     * Loop points come from the file's tags (like LOOPSTART in OGG files), unless they
+     * are overridden by set_loop(); overridden loop points are applied by
+     * music_player::update().
+     */
+    class music_stream {
+
+        async_rwops src;
+        // Declared after the source, so it's destroyed first.
+        music mus;
+        std::optional<dbl_seconds> loop_start;
+        std::optional<dbl_seconds> loop_end;
+
+
+        [[nodiscard]]
+        static
+        std::size_t
+        chunk_size_for(milliseconds prefetch,
+                       unsigned kbps)
+            noexcept;
+
+    public:
+
+        static constexpr milliseconds default_prefetch{2000};
+        static constexpr unsigned default_kbps = 320;
+        static constexpr unsigned prefetch_chunks = 4;
+
+
+        /// Takes ownership of the source; it can be any rwops, like a decompress_rwops.
+        explicit
+        music_stream(rwops&& source,
+                     milliseconds prefetch = default_prefetch,
+                     unsigned kbps = default_kbps);
+
+        explicit
+        music_stream(const path& filename,
+                     milliseconds prefetch = default_prefetch,
+                     unsigned kbps = default_kbps);
+
+        /// The archive must outlive the stream.
+        music_stream(const pack::archive& archive,
+                     std::string_view name,
+                     milliseconds prefetch = default_prefetch,
+                     unsigned kbps = default_kbps);
+
+
+        [[nodiscard]]
+        music&
+        get_music()
+            noexcept;
+
+        [[nodiscard]]
+        const music&
+        get_music()
+            const noexcept;
+
+
+        void
+        play(int loops = -1);
+
+        void
+        fade_in(milliseconds duration,
+                int loops = -1);
+
+
+        /// Only works while this stream is the one playing.
+        bool
+        seek(dbl_seconds position)
+            noexcept;
+
+        [[nodiscard]]
+        std::optional<dbl_seconds>
+        get_position()
+            const noexcept;
+
+        [[nodiscard]]
+        std::optional<dbl_seconds>
+        get_duration()
+            const noexcept;
+
+
+        /// Override the loop points from the tags.
+        void
+        set_loop(dbl_seconds start,
+                 dbl_seconds end)
+            noexcept;
+
+        /// Go back to the loop points from the tags.
+        void
+        reset_loop()
+            noexcept;
+
+        /// True if the loop points were set by set_loop().
+        [[nodiscard]]
+        bool
+        has_custom_loop()
+            const noexcept;
+
+        [[nodiscard]]
+        std::optional<dbl_seconds>
+        get_loop_start()
+            const noexcept;
+
+        [[nodiscard]]
+        std::optional<dbl_seconds>
+        get_loop_end()
+            const noexcept;
+
+
+        /// How many bytes are prefetched.
+        [[nodiscard]]
+        std::size_t
+        get_prefetched()
+            const noexcept;
+
+    }; // class music_stream
+
+
+    /**
+     * Plays music streams one after the other, with fades.
+     *
+     * SDL_mixer only plays one music at a time, so a transition is a fade-out of the
+     * current track followed by a fade-in of the next. The next track is opened and
+     * prefetched before the fade-out starts, and update() starts it as soon as the
+     * fade-out ends, so the only gap is the time between update() calls.
+     */
+    class music_player {
+
+        std::optional<music_stream> current;
+        std::optional<music_stream> next;
+        milliseconds next_fade{0};
+        int next_loops = -1;
+        bool stopping = false;
+
+    public:
+
+        music_player()
+            noexcept = default;
+
+        /// Halts the music.
+        ~music_player()
+            noexcept;
+
+
+        /// Replace the current track, fading it out during `fade` and the new one in.
+        void
+        play(music_stream&& track,
+             milliseconds fade = milliseconds{0},
+             int loops = -1);
+
+        void
+        stop(milliseconds fade = milliseconds{0})
+            noexcept;
+
+
+        /// Call once per frame: starts pending tracks and applies custom loop points.
+        void
+        update();
+
+
+        [[nodiscard]]
+        music_stream*
+        get_current()
+            noexcept;
+
+        /// True while a track is waiting for the current one to fade out.
+        [[nodiscard]]
+        bool
+        is_transitioning()
+            const noexcept;
+
+    }; // class music_player
+
+} // namespace sdl::mix
+
+#endif
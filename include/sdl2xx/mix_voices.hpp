@@ -0,0 +1,167 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_MIX_VOICES_HPP
+#define SDL2XX_MIX_VOICES_HPP
+
+#include <optional>
+
+#include <SDL_mixer.h>
+
+#include "mix.hpp"
+#include "vector.hpp"
+
+
+namespace sdl::mix {
+
+    /**
+     * Manages a range of channels as voices, instead of letting chunk::play() grab any
+     * free channel.
+     *
+     * When every voice is busy, the new sound steals the least important voice: the
+     * lowest priority, then the farthest, then the oldest. If that voice is more important
+     * than the new sound, the new sound is dropped. Sounds can also be limited to a
+     * number of simultaneous instances, in which case the oldest instance is replaced,
+     * and sounds too far away are culled without playing.
+     *
+     * The channels are tagged as a group; to keep chunk::play() away from them, put the
+     * pool at the start and use reserve_channels().
+     */
+    class voice_pool {
+
+    public:
+
+        struct params {
+            int priority = 0;
+            // 0 means unlimited.
+            unsigned max_instances = 0;
+            // From 0 (near) to 1 (far), like set_distance().
+            float distance = 0;
+            int loops = 0;
+            milliseconds fade_in{0};
+        };
+
+        struct stats {
+            Uint64 played = 0;
+            Uint64 stolen = 0;
+            Uint64 dropped = 0;
+            Uint64 culled = 0;
+        };
+
+    private:
+
+        struct voice {
+            const Mix_Chunk* sound = nullptr;
+            int priority = 0;
+            float distance = 0;
+            Uint64 serial = 0;
+            bool active = false;
+        };
+
+        unsigned first;
+        int tag;
+        float cull_distance = 1;
+        bool steal_equal = true;
+        vector<voice> voices;
+        Uint64 next_serial = 0;
+        stats counters;
+
+
+        void
+        refresh()
+            noexcept;
+
+        [[nodiscard]]
+        std::optional<unsigned>
+        pick(const Mix_Chunk* sound,
+             const params& p)
+            noexcept;
+
+    public:
+
+        /// Channels from `first` to `first + count - 1` are allocated if needed.
+        voice_pool(unsigned first,
+                   unsigned count,
+                   int tag);
+
+
+        // The channels are tied to this object.
+        voice_pool(const voice_pool&) = delete;
+
+
+        /// Stops every voice.
+        ~voice_pool()
+            noexcept;
+
+
+        /// Returns the channel, or nothing if the sound was dropped or culled.
+        std::optional<unsigned>
+        play(chunk& sound);
+
+        std::optional<unsigned>
+        play(chunk& sound,
+             const params& p);
+
+
+        /// Update a moving sound; ignored if the channel isn't playing a voice.
+        void
+        set_distance(unsigned channel,
+                     float distance);
+
+
+        /// Sounds at this distance or farther are not played.
+        void
+        set_cull_distance(float distance)
+            noexcept;
+
+        /// Whether a sound can steal a voice with the same priority; true by default.
+        void
+        set_steal_equal(bool enable)
+            noexcept;
+
+
+        void
+        halt()
+            noexcept;
+
+        void
+        fade_out(milliseconds duration)
+            noexcept;
+
+
+        /// How many voices are playing.
+        [[nodiscard]]
+        unsigned
+        get_active()
+            noexcept;
+
+        [[nodiscard]]
+        unsigned
+        get_size()
+            const noexcept;
+
+        [[nodiscard]]
+        int
+        get_tag()
+            const noexcept;
+
+
+        [[nodiscard]]
+        const stats&
+        get_stats()
+            const noexcept;
+
+        void
+        reset_stats()
+            noexcept;
+
+    }; // class voice_pool
+
+} // namespace sdl::mix
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_PACK_HPP
+#define SDL2XX_PACK_HPP
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include <SDL_stdinc.h>
+
+#include "blob.hpp"
+#include "compressed_rwops.hpp"
+#include "error.hpp"
+#include "rwops.hpp"
+#include "string.hpp"
+#include "vector.hpp"
+
+
+/**
+ * Pack files: many assets stored in a single archive.
+ *
+ * Layout (all integers are little-endian):
+ *
+ *   header     magic "SDL2XXPK", version, alignment, entry count, directory offset
+ *   data       each entry starts at a multiple of the alignment
+ *   directory  fixed-size records, sorted by name
+ *   names      the entry names, not null-terminated
+ *
+ * The archive is memory-mapped when the platform supports it, so opening an
+ * uncompressed entry returns a rwops that reads straight from the mapping.
+ * Compressed entries are decompressed on the fly by a decompress_rwops.
+ */
+namespace sdl::pack {
+
+    using std::filesystem::path;
+
+
+    inline constexpr Uint32 version = 1;
+
+    inline constexpr std::size_t default_alignment = 16;
+
+
+    enum class compression : Uint8 {
+        none    = 0,
+        deflate = 1,
+        zstd    = 2,
+        lz4     = 3,
+    };
+
+
+    struct entry {
+        std::string_view name;
+        Uint64 offset;
+        Uint64 size;          // stored size
+        Uint64 original_size; // size after decompression
+        compression comp;
+    };
+
+
+    class archive {
+
+        const Uint8* base = nullptr;
+        std::size_t base_size = 0;
+
+        // Set when the archive is mapped from a file.
+        bool mapped = false;
+
+        // Used when the archive is read into memory instead.
+        blob storage{nullptr, 0};
+
+        vector<entry> entries;
+
+
+        void
+        parse();
+
+    public:
+
+        archive()
+            noexcept = default;
+
+
+        explicit
+        archive(const path& filename);
+
+        /// Use an archive that's already in memory.
+        explicit
+        archive(blob data);
+
+
+        /// Move constructor.
+        archive(archive&& other)
+            noexcept;
+
+
+        ~archive()
+            noexcept;
+
+
+        /// Move assignment.
+        archive&
+        operator =(archive&& other)
+            noexcept;
+
+
+        void
+        create(const path& filename);
+
+        void
+        create(blob data);
+
+
+        void
+        destroy()
+            noexcept;
+
+
+        [[nodiscard]]
+        bool
+        is_valid()
+            const noexcept;
+
+        [[nodiscard]]
+        explicit
+        operator bool()
+            const noexcept;
+
+
+        [[nodiscard]]
+        bool
+        is_mapped()
+            const noexcept;
+
+
+        [[nodiscard]]
+        std::span<const entry>
+        get_entries()
+            const noexcept;
+
+
+        [[nodiscard]]
+        const entry*
+        find(std::string_view name)
+            const noexcept;
+
+
+        [[nodiscard]]
+        bool
+        contains(std::string_view name)
+            const noexcept;
+
+
+        /// The stored bytes of an entry.
+        [[nodiscard]]
+        std::span<const Uint8>
+        get_data(const entry& e)
+            const noexcept;
+
+
+        /// The returned rwops must not outlive the archive.
+        [[nodiscard]]
+        rwops
+        open(std::string_view name)
+            const;
+
+        [[nodiscard]]
+        rwops
+        open(const entry& e)
+            const;
+
+        [[nodiscard]]
+        std::expected<rwops, error>
+        try_open(std::string_view name)
+            const noexcept;
+
+        [[nodiscard]]
+        std::expected<rwops, error>
+        try_open(const entry& e)
+            const noexcept;
+
+
+        /// Read the whole entry into memory.
+        [[nodiscard]]
+        blob
+        load(std::string_view name)
+            const;
+
+        [[nodiscard]]
+        std::expected<blob, error>
+        try_load(std::string_view name)
+            const noexcept;
+
+    }; // class archive
+
+
+    class writer {
+
+        struct pending {
+            string name;
+            path filename;
+            blob data;
+            compression comp;
+        };
+
+        std::size_t alignment;
+        int level;
+
+        vector<pending> items;
+
+    public:
+
+        explicit
+        writer(std::size_t alignment = default_alignment,
+               int level = compress_rwops::default_level);
+
+
+        /// Add an entry from memory.
+        void
+        add(std::string_view name,
+            blob data,
+            compression comp = compression::none);
+
+        void
+        add(std::string_view name,
+            std::span<const Uint8> data,
+            compression comp = compression::none);
+
+
+        /// Add an entry from a file; the file is only read when writing the archive.
+        void
+        add_file(std::string_view name,
+                 const path& filename,
+                 compression comp = compression::none);
+
+
+        [[nodiscard]]
+        std::size_t
+        size()
+            const noexcept;
+
+
+        void
+        write(rwops& dst);
+
+
+        void
+        save(const path& filename);
+
+    }; // class writer
+
+} // namespace sdl::pack
+
+#endif
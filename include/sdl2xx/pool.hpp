@@ -0,0 +1,181 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_POOL_HPP
+#define SDL2XX_POOL_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+#include "allocator.hpp"
+#include "vector.hpp"
+
+
+namespace sdl {
+
+    /**
+     * A pool of fixed-size blocks.
+     *
+     * Freed blocks go into a free list and are reused; the memory is only returned
+     * to SDL_free() when the pool is destroyed.
+     */
+    class pool {
+
+        struct node {
+            node* next;
+        };
+
+        std::size_t block_size;
+        std::size_t blocks_per_chunk;
+
+        node* free_list = nullptr;
+        vector<void*> chunks;
+
+        std::size_t used = 0;
+
+    public:
+
+        static constexpr std::size_t default_blocks_per_chunk = 64;
+
+
+        explicit
+        pool(std::size_t block_size,
+             std::size_t blocks_per_chunk = default_blocks_per_chunk)
+            noexcept;
+
+
+        /// Move constructor.
+        pool(pool&& other)
+            noexcept;
+
+
+        ~pool()
+            noexcept;
+
+
+        /// Move assignment.
+        pool&
+        operator =(pool&& other)
+            noexcept;
+
+
+        [[nodiscard]]
+        void*
+        allocate();
+
+        void
+        deallocate(void* ptr)
+            noexcept;
+
+
+        /// Free every chunk; all blocks must have been deallocated.
+        void
+        release()
+            noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_block_size()
+            const noexcept;
+
+        /// How many blocks are allocated.
+        [[nodiscard]]
+        std::size_t
+        get_used()
+            const noexcept;
+
+        /// How many blocks the pool can hold without allocating.
+        [[nodiscard]]
+        std::size_t
+        get_capacity()
+            const noexcept;
+
+    }; // class pool
+
+
+    /**
+     * Allocator for node-based containers.
+     *
+     * Single objects that fit in a block come from the pool; anything else falls back
+     * to SDL_malloc().
+     */
+    template<typename T>
+    struct pool_allocator {
+
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap            = std::true_type;
+
+
+        pool* source;
+
+
+        pool_allocator(pool& source)
+            noexcept :
+            source{&source}
+        {}
+
+
+        template<typename U>
+        pool_allocator(const pool_allocator<U>& other)
+            noexcept :
+            source{other.source}
+        {}
+
+
+        static
+        bool
+        fits(const pool* p,
+             std::size_t count)
+            noexcept
+        {
+            return count == 1
+                && sizeof(T) <= p->get_block_size()
+                && alignof(T) <= alignof(std::max_align_t);
+        }
+
+
+        T*
+        allocate(std::size_t count)
+        {
+            if (fits(source, count))
+                return static_cast<T*>(source->allocate());
+            return malloc_allocator::allocate_as<T*>(count * sizeof(T));
+        }
+
+
+        void
+        deallocate(T* ptr,
+                   std::size_t count)
+            noexcept
+        {
+            if (fits(source, count))
+                source->deallocate(ptr);
+            else
+                malloc_allocator::deallocate(ptr);
+        }
+
+
+        template<typename U>
+        constexpr bool
+        operator ==(const pool_allocator<U>& other)
+            const noexcept
+        {
+            return source == other.source;
+        }
+
+    };
+
+} // namespace sdl
+
+#endif
@@ -11,10 +11,21 @@
 
 #include "allocator.hpp"
 #include "audio.hpp"
+#include "audio_callback.hpp"
+#include "audio_capture.hpp"
+#include "audio_latency.hpp"
+#include "audio_mixer.hpp"
+#include "audio_resampler.hpp"
+#include "audio_ring.hpp"
+#include "audio_wav.hpp"
 #include "angle.hpp"
+#include "arena.hpp"
+#include "async_rwops.hpp"
 #include "blob.hpp"
+#include "buffered_rwops.hpp"
 #include "clipboard.hpp"
 #include "color.hpp"
+#include "compressed_rwops.hpp"
 #include "display.hpp"
 #include "endian.hpp"
 #include "error.hpp"
@@ -24,8 +35,12 @@
 #include "guid.hpp"
 #include "init.hpp"
 #include "joystick.hpp"
+#include "memory_rwops.hpp"
+#include "memory_stats.hpp"
 #include "mouse.hpp"
+#include "pack.hpp"
 #include "pixels.hpp"
+#include "pool.hpp"
 #include "rect.hpp"
 #include "renderer.hpp"
 #include "rwops.hpp"
@@ -33,6 +48,7 @@
 #include "string.hpp"
 #include "surface.hpp"
 #include "texture.hpp"
+#include "thread_pool.hpp"
 #include "unique_ptr.hpp"
 #include "vec2.hpp"
 #include "vector.hpp"
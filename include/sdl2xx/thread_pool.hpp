@@ -0,0 +1,130 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifndef SDL2XX_THREAD_POOL_HPP
+#define SDL2XX_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <SDL_stdinc.h>
+
+#include "vector.hpp"
+
+
+namespace sdl {
+
+    /**
+     * A fixed set of worker threads that run tasks by priority.
+     *
+     * Higher priorities run first; tasks with the same priority run in the order they
+     * were submitted. A task that didn't start yet can be cancelled. Exceptions thrown
+     * by a task are ignored.
+     */
+    class thread_pool {
+
+    public:
+
+        using task_id = Uint64;
+
+        using task_function = std::function<void ()>;
+
+    private:
+
+        struct key {
+            int priority;
+            task_id id;
+
+            constexpr
+            bool
+            operator <(const key& other)
+                const noexcept
+            {
+                if (priority != other.priority)
+                    return priority > other.priority;
+                return id < other.id;
+            }
+        };
+
+        mutable std::mutex mutex;
+        std::condition_variable tasks_cv;
+        std::condition_variable idle_cv;
+
+        // All fields below are guarded by the mutex.
+
+        std::map<key, task_function> tasks;
+        task_id next_id = 0;
+        unsigned running = 0;
+        bool stop = false;
+
+        vector<std::thread> workers;
+
+
+        void
+        run()
+            noexcept;
+
+        void
+        shutdown()
+            noexcept;
+
+    public:
+
+        /// One thread less than the number of CPUs, but at least one.
+        [[nodiscard]]
+        static
+        unsigned
+        default_threads()
+            noexcept;
+
+
+        explicit
+        thread_pool(unsigned threads = default_threads());
+
+        // Disallow copies.
+        thread_pool(const thread_pool&) = delete;
+
+        /// Tasks that didn't start are dropped; running tasks are waited for.
+        ~thread_pool()
+            noexcept;
+
+
+        task_id
+        submit(task_function func,
+               int priority = 0);
+
+        /// Returns true if the task was removed before it started.
+        bool
+        cancel(task_id id)
+            noexcept;
+
+        /// Block until every submitted task finished.
+        void
+        wait()
+            noexcept;
+
+
+        [[nodiscard]]
+        unsigned
+        size()
+            const noexcept;
+
+        /// How many tasks are waiting for a worker.
+        [[nodiscard]]
+        std::size_t
+        get_pending()
+            const noexcept;
+
+    }; // class thread_pool
+
+} // namespace sdl
+
+#endif
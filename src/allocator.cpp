@@ -25,6 +25,17 @@ namespace sdl::malloc_allocator {
     }
 
 
+    void*
+    reallocate(void* ptr,
+               std::size_t size)
+    {
+        void* new_ptr = SDL_realloc(ptr, size);
+        if (!new_ptr)
+            throw std::bad_alloc{};
+        return new_ptr;
+    }
+
+
     void
     deallocate(void* ptr)
         noexcept
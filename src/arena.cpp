@@ -0,0 +1,180 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "arena.hpp"
+
+#include "allocator.hpp"
+
+
+namespace sdl {
+
+    arena::arena(std::size_t block_size)
+        noexcept :
+        block_size{block_size ? block_size : default_block_size}
+    {}
+
+
+    arena::arena(arena&& other)
+        noexcept :
+        blocks{std::move(other.blocks)},
+        block_size{other.block_size},
+        current{std::exchange(other.current, 0)},
+        offset{std::exchange(other.offset, 0)}
+    {
+        other.blocks.clear();
+    }
+
+
+    arena::~arena()
+        noexcept
+    {
+        release();
+    }
+
+
+    arena&
+    arena::operator =(arena&& other)
+        noexcept
+    {
+        if (this != &other) {
+            release();
+            blocks = std::move(other.blocks);
+            other.blocks.clear();
+            block_size = other.block_size;
+            current = std::exchange(other.current, 0);
+            offset = std::exchange(other.offset, 0);
+        }
+        return *this;
+    }
+
+
+    void*
+    arena::allocate(std::size_t size,
+                    std::size_t alignment)
+    {
+        if (!alignment)
+            alignment = 1;
+
+        // Try the current block, then any blocks kept from earlier frames.
+        for (; current < blocks.size(); ++current, offset = 0) {
+            auto& b = blocks[current];
+            auto base = reinterpret_cast<std::uintptr_t>(b.data);
+            auto aligned = (base + offset + alignment - 1) & ~(alignment - 1);
+            std::size_t start = aligned - base;
+            if (start <= b.size && size <= b.size - start) {
+                offset = start + size;
+                return b.data + start;
+            }
+        }
+
+        // Oversized requests get a block of their own, which is also kept.
+        std::size_t new_size = std::max(block_size, size + alignment);
+        auto data = malloc_allocator::allocate_as<Uint8*>(new_size);
+        try {
+            blocks.push_back(block{data, new_size});
+        }
+        catch (...) {
+            malloc_allocator::deallocate(data);
+            throw;
+        }
+        current = blocks.size() - 1;
+        offset = 0;
+        return allocate(size, alignment);
+    }
+
+
+    arena::marker
+    arena::mark()
+        const noexcept
+    {
+        return {current, offset};
+    }
+
+
+    void
+    arena::rewind(marker m)
+        noexcept
+    {
+        current = m.block;
+        offset = m.offset;
+    }
+
+
+    void
+    arena::reset()
+        noexcept
+    {
+        current = 0;
+        offset = 0;
+    }
+
+
+    void
+    arena::release()
+        noexcept
+    {
+        for (auto& b : blocks)
+            malloc_allocator::deallocate(b.data);
+        blocks.clear();
+        current = 0;
+        offset = 0;
+    }
+
+
+    std::size_t
+    arena::get_used()
+        const noexcept
+    {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < current && i < blocks.size(); ++i)
+            total += blocks[i].size;
+        return total + offset;
+    }
+
+
+    std::size_t
+    arena::get_capacity()
+        const noexcept
+    {
+        std::size_t total = 0;
+        for (auto& b : blocks)
+            total += b.size;
+        return total;
+    }
+
+
+    namespace frame {
+
+        arena&
+        get_arena()
+            noexcept
+        {
+            thread_local arena frame_arena;
+            return frame_arena;
+        }
+
+
+        scope::scope()
+            noexcept :
+            saved{get_arena().mark()}
+        {}
+
+
+        scope::~scope()
+            noexcept
+        {
+            get_arena().rewind(saved);
+        }
+
+    } // namespace frame
+
+} // namespace sdl
@@ -0,0 +1,488 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <SDL_error.h>
+
+#include "async_rwops.hpp"
+
+#include "blob.hpp"
+#include "unique_ptr.hpp"
+#include "vector.hpp"
+
+
+namespace sdl {
+
+    namespace {
+
+        struct chunk {
+            blob data;
+            std::size_t size = 0;
+        };
+
+
+        struct async_state {
+
+            SDL_RWops* src;
+            bool close_src;
+
+            Sint64 src_size = -1;
+
+            vector<chunk> ring;
+
+            mutable std::mutex mutex;
+            std::condition_variable io_cv;
+            std::condition_variable reader_cv;
+
+            // All fields below are guarded by the mutex.
+
+            unsigned head = 0;  // first filled chunk
+            unsigned count = 0; // how many chunks are filled
+            std::size_t head_pos = 0; // read position inside the head chunk
+
+            // File offset of the first byte in the head chunk.
+            Sint64 head_offset = 0;
+
+            // File offset the I/O thread will read next.
+            Sint64 next_offset = 0;
+
+            // Incremented on every seek that discards the ring.
+            unsigned generation = 0;
+            bool seek_pending = false;
+
+            bool eof = false;
+            bool failed = false;
+            bool stop = false;
+
+            char error_msg[128] = {};
+
+            std::thread io_thread;
+
+
+            async_state(SDL_RWops* src,
+                        bool close_src,
+                        std::size_t chunk_size,
+                        unsigned num_chunks) :
+                src{src},
+                close_src{close_src}
+            {
+                ring.reserve(num_chunks);
+                for (unsigned i = 0; i < num_chunks; ++i)
+                    ring.push_back(chunk{blob{chunk_size}});
+            }
+
+
+            std::size_t
+            chunk_size()
+                const noexcept
+            {
+                return ring.front().data.data().size();
+            }
+
+
+            std::size_t
+            available()
+                const noexcept
+            {
+                std::size_t total = 0;
+                for (unsigned i = 0; i < count; ++i)
+                    total += ring[(head + i) % ring.size()].size;
+                return total - head_pos;
+            }
+
+
+            Sint64
+            position()
+                const noexcept
+            {
+                return head_offset + head_pos;
+            }
+
+
+            void
+            pop_head()
+                noexcept
+            {
+                head_offset += ring[head].size;
+                head = (head + 1) % ring.size();
+                --count;
+                head_pos = 0;
+            }
+
+
+            void
+            run()
+                noexcept
+            {
+                std::unique_lock guard{mutex};
+                for (;;) {
+                    io_cv.wait(guard,
+                               [this]
+                               {
+                                   return stop
+                                       || seek_pending
+                                       || (count < ring.size() && !eof && !failed);
+                               });
+                    if (stop)
+                        return;
+
+                    unsigned gen = generation;
+
+                    if (seek_pending) {
+                        Sint64 target = next_offset;
+                        guard.unlock();
+                        auto result = SDL_RWseek(src, target, RW_SEEK_SET);
+                        guard.lock();
+                        // Another seek was requested meanwhile.
+                        if (gen != generation)
+                            continue;
+                        seek_pending = false;
+                        if (result < 0)
+                            set_failed();
+                        reader_cv.notify_all();
+                        continue;
+                    }
+
+                    unsigned slot = (head + count) % ring.size();
+                    Uint8* dst = ring[slot].data.data().data();
+                    std::size_t size = chunk_size();
+
+                    // The slot is not visible to the reader, so it's safe to fill it unlocked.
+                    guard.unlock();
+                    SDL_ClearError();
+                    std::size_t r = SDL_RWread(src, dst, 1, size);
+                    guard.lock();
+
+                    // A seek happened while reading; the data is stale.
+                    if (gen != generation)
+                        continue;
+
+                    if (r) {
+                        ring[slot].size = r;
+                        ++count;
+                        next_offset += r;
+                    }
+                    if (r < size) {
+                        // Short reads are either EOF or an error.
+                        const char* msg = SDL_GetError();
+                        if (r == 0 && msg && msg[0])
+                            set_failed();
+                        eof = true;
+                    }
+                    reader_cv.notify_all();
+                }
+            }
+
+
+            void
+            set_failed()
+                noexcept
+            {
+                failed = true;
+                const char* msg = SDL_GetError();
+                std::strncpy(error_msg, msg ? msg : "", sizeof error_msg - 1);
+            }
+
+
+            std::size_t
+            read(Uint8* dst,
+                 std::size_t size)
+                noexcept
+            {
+                std::size_t done = 0;
+                std::unique_lock guard{mutex};
+                while (done < size) {
+                    reader_cv.wait(guard,
+                                   [this]
+                                   {
+                                       return !seek_pending && (count || eof || failed);
+                                   });
+                    if (!count) {
+                        if (failed)
+                            SDL_SetError("%s", error_msg);
+                        break;
+                    }
+
+                    const chunk& c = ring[head];
+                    std::size_t n = std::min(c.size - head_pos, size - done);
+                    // Filled chunks are never touched by the I/O thread.
+                    guard.unlock();
+                    std::memcpy(dst + done, c.data.data().data() + head_pos, n);
+                    guard.lock();
+                    done += n;
+                    head_pos += n;
+                    if (head_pos == c.size) {
+                        pop_head();
+                        io_cv.notify_one();
+                    }
+                }
+                return done;
+            }
+
+
+            Sint64
+            seek(Sint64 offset,
+                 int whence)
+                noexcept
+            {
+                std::unique_lock guard{mutex};
+                Sint64 target;
+                switch (whence) {
+                    case RW_SEEK_SET:
+                        target = offset;
+                        break;
+                    case RW_SEEK_CUR:
+                        target = position() + offset;
+                        break;
+                    case RW_SEEK_END:
+                        if (src_size < 0)
+                            return SDL_SetError("async_rwops: source size is unknown");
+                        target = src_size + offset;
+                        break;
+                    default:
+                        return SDL_SetError("async_seek(): unknown value for 'whence'");
+                }
+                if (target < 0)
+                    return SDL_Error(SDL_EFSEEK);
+                if (target == position())
+                    return target;
+
+                // Forward seeks into prefetched data just drop chunks.
+                if (target > position()) {
+                    while (count && target >= head_offset + static_cast<Sint64>(ring[head].size))
+                        pop_head();
+                    if (count && target >= head_offset) {
+                        head_pos = target - head_offset;
+                        io_cv.notify_one();
+                        return target;
+                    }
+                }
+
+                ++generation;
+                count = 0;
+                head_pos = 0;
+                head_offset = target;
+                next_offset = target;
+                eof = false;
+                failed = false;
+                seek_pending = true;
+                io_cv.notify_one();
+                return target;
+            }
+
+
+            void
+            start()
+            {
+                io_thread = std::thread{&async_state::run, this};
+            }
+
+
+            void
+            finish()
+                noexcept
+            {
+                {
+                    std::lock_guard guard{mutex};
+                    stop = true;
+                }
+                io_cv.notify_one();
+                if (io_thread.joinable())
+                    io_thread.join();
+            }
+
+        }; // struct async_state
+
+
+        async_state*
+        get_state(SDL_RWops* ctx)
+            noexcept
+        {
+            return static_cast<async_state*>(ctx->hidden.unknown.data1);
+        }
+
+
+        Sint64
+        async_size(SDL_RWops* ctx)
+            noexcept
+        {
+            return get_state(ctx)->src_size;
+        }
+
+
+        Sint64
+        async_seek(SDL_RWops* ctx,
+                   Sint64 offset,
+                   int whence)
+            noexcept
+        {
+            return get_state(ctx)->seek(offset, whence);
+        }
+
+
+        std::size_t
+        async_read(SDL_RWops* ctx,
+                   void* buf,
+                   std::size_t elem_size,
+                   std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto r = get_state(ctx)->read(static_cast<Uint8*>(buf), elem_size * count);
+            return r / elem_size;
+        }
+
+
+        std::size_t
+        async_write(SDL_RWops*,
+                    const void*,
+                    std::size_t,
+                    std::size_t)
+            noexcept
+        {
+            SDL_SetError("async_rwops is read-only");
+            return 0;
+        }
+
+
+        int
+        async_close(SDL_RWops* ctx)
+            noexcept
+        {
+            unique_ptr<async_state> state{get_state(ctx)};
+            SDL_FreeRW(ctx);
+            state->finish();
+            if (state->close_src)
+                return SDL_RWclose(state->src);
+            return 0;
+        }
+
+    } // namespace
+
+
+    async_rwops::async_rwops(rwops& src,
+                             std::size_t chunk_size,
+                             unsigned num_chunks)
+    {
+        create(src, chunk_size, num_chunks);
+    }
+
+
+    async_rwops::async_rwops(rwops&& src,
+                             std::size_t chunk_size,
+                             unsigned num_chunks)
+    {
+        create(std::move(src), chunk_size, num_chunks);
+    }
+
+
+    async_rwops::async_rwops(SDL_RWops* src,
+                             bool close_src,
+                             std::size_t chunk_size,
+                             unsigned num_chunks)
+    {
+        create(src, close_src, chunk_size, num_chunks);
+    }
+
+
+    async_rwops::async_rwops(const path& filename,
+                             std::size_t chunk_size,
+                             unsigned num_chunks)
+    {
+        create(filename, chunk_size, num_chunks);
+    }
+
+
+    void
+    async_rwops::create(rwops& src,
+                        std::size_t chunk_size,
+                        unsigned num_chunks)
+    {
+        create(src.data(), false, chunk_size, num_chunks);
+    }
+
+
+    void
+    async_rwops::create(rwops&& src,
+                        std::size_t chunk_size,
+                        unsigned num_chunks)
+    {
+        create(src.data(), true, chunk_size, num_chunks);
+        src.release();
+    }
+
+
+    void
+    async_rwops::create(SDL_RWops* src,
+                        bool close_src,
+                        std::size_t chunk_size,
+                        unsigned num_chunks)
+    {
+        if (!src)
+            throw error{"async_rwops: invalid source"};
+        if (!chunk_size || !num_chunks)
+            throw error{"async_rwops: chunk size and number of chunks must be greater than zero"};
+
+        auto state = make_unique<async_state>(src, close_src, chunk_size, num_chunks);
+        state->src_size = SDL_RWsize(src);
+        auto pos = SDL_RWtell(src);
+        if (pos > 0)
+            state->head_offset = state->next_offset = pos;
+
+        auto new_raw = SDL_AllocRW();
+        if (!new_raw)
+            throw error{};
+
+        try {
+            state->start();
+        }
+        catch (...) {
+            SDL_FreeRW(new_raw);
+            throw;
+        }
+
+        new_raw->size = async_size;
+        new_raw->seek = async_seek;
+        new_raw->read = async_read;
+        new_raw->write = async_write;
+        new_raw->close = async_close;
+        new_raw->type = SDL_RWOPS_UNKNOWN;
+        new_raw->hidden.unknown.data1 = state.release();
+
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    async_rwops::create(const path& filename,
+                        std::size_t chunk_size,
+                        unsigned num_chunks)
+    {
+        rwops src{filename, "rb"};
+        create(std::move(src), chunk_size, num_chunks);
+    }
+
+
+    std::size_t
+    async_rwops::get_available()
+        const noexcept
+    {
+        auto state = get_state(raw);
+        std::lock_guard guard{state->mutex};
+        return state->available();
+    }
+
+} // namespace sdl
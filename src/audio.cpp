@@ -9,6 +9,7 @@
 #include "audio.hpp"
 
 #include "error.hpp"
+#include "memory_stats.hpp"
 
 
 namespace sdl::audio {
@@ -159,6 +160,7 @@ namespace sdl::audio {
                    const spec& desired,
                    Uint32 allowed_changes)
     {
+        memory::tag_scope tag{memory::tag::audio};
         destroy();
         auto id = SDL_OpenAudioDevice(name,
                                       is_capture,
@@ -187,6 +189,7 @@ namespace sdl::audio {
                    spec& obtained,
                    Uint32 allowed_changes)
     {
+        memory::tag_scope tag{memory::tag::audio};
         destroy();
         auto id = SDL_OpenAudioDevice(name,
                                       is_capture,
@@ -254,6 +257,7 @@ namespace sdl::audio {
     device::play(const void* samples,
                 std::size_t size)
     {
+        memory::tag_scope tag{memory::tag::audio};
         if (SDL_QueueAudio(raw, samples, size) < 0)
             throw error{};
     }
@@ -346,6 +350,7 @@ namespace sdl::audio {
     load_wav(SDL_RWops* src,
              bool close_src)
     {
+        memory::tag_scope tag{memory::tag::audio};
         spec sp;
         Uint8* buf;
         Uint32 size;
@@ -378,6 +383,7 @@ namespace sdl::audio {
                          Uint8 dst_channels,
                          int dst_rate)
     {
+        memory::tag_scope tag{memory::tag::audio};
         int result = SDL_BuildAudioCVT(this,
                                        src_format, src_channels, src_rate,
                                        dst_format, dst_channels, dst_rate);
@@ -390,6 +396,7 @@ namespace sdl::audio {
     void
     converter::convert()
     {
+        memory::tag_scope tag{memory::tag::audio};
         if (SDL_ConvertAudio(this) < 0)
             throw error{};
     }
@@ -429,6 +436,7 @@ namespace sdl::audio {
                    Uint8 dst_channels,
                    int dst_rate)
     {
+        memory::tag_scope tag{memory::tag::audio};
         auto str = SDL_NewAudioStream(src_format, src_channels, src_rate,
                                       dst_format, dst_channels, dst_rate);
         if (!str)
@@ -451,6 +459,7 @@ namespace sdl::audio {
     stream::put(const void* buf,
                 std::size_t size)
     {
+        memory::tag_scope tag{memory::tag::audio};
         if (SDL_AudioStreamPut(raw, buf, size) < 0)
             throw error{};
     }
@@ -467,6 +476,7 @@ namespace sdl::audio {
     stream::get(void* buf,
                 std::size_t size)
     {
+        memory::tag_scope tag{memory::tag::audio};
         int result = SDL_AudioStreamGet(raw, buf, size);
         if (result < 0)
             throw error{};
@@ -477,6 +487,7 @@ namespace sdl::audio {
     vector<Uint8>
     stream::get(std::size_t size)
     {
+        memory::tag_scope tag{memory::tag::audio};
         vector<Uint8> result(size);
         std::size_t rs = get(std::span(result));
         result.resize(rs);
@@ -495,6 +506,7 @@ namespace sdl::audio {
     void
     stream::flush()
     {
+        memory::tag_scope tag{memory::tag::audio};
         if (SDL_AudioStreamFlush(raw) < 0)
             throw error{};
     }
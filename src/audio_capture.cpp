@@ -0,0 +1,409 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+#include <SDL_cpuinfo.h>
+#include <SDL_timer.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SDL2XX_CAPTURE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define SDL2XX_CAPTURE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "audio_capture.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::audio {
+
+    namespace {
+
+        struct sums {
+            float peak;
+            float squares;
+        };
+
+
+        sums
+        measure_scalar(const float* x,
+                       std::size_t n)
+            noexcept
+        {
+            sums s{0, 0};
+            for (std::size_t i = 0; i < n; ++i) {
+                s.peak = std::max(s.peak, std::abs(x[i]));
+                s.squares += x[i] * x[i];
+            }
+            return s;
+        }
+
+
+#ifdef SDL2XX_CAPTURE_AVX2
+
+        __attribute__((target("avx2,fma")))
+        sums
+        measure_avx2(const float* x,
+                     std::size_t n)
+            noexcept
+        {
+            const __m256 sign = _mm256_set1_ps(-0.0f);
+            __m256 peak = _mm256_setzero_ps();
+            __m256 sq = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 v = _mm256_loadu_ps(x + i);
+                peak = _mm256_max_ps(peak, _mm256_andnot_ps(sign, v));
+                sq = _mm256_fmadd_ps(v, v, sq);
+            }
+            alignas(32) float p[8];
+            alignas(32) float q[8];
+            _mm256_store_ps(p, peak);
+            _mm256_store_ps(q, sq);
+            sums s = measure_scalar(x + i, n - i);
+            for (int k = 0; k < 8; ++k) {
+                s.peak = std::max(s.peak, p[k]);
+                s.squares += q[k];
+            }
+            return s;
+        }
+
+#endif // SDL2XX_CAPTURE_AVX2
+
+
+#ifdef SDL2XX_CAPTURE_NEON
+
+        sums
+        measure_neon(const float* x,
+                     std::size_t n)
+            noexcept
+        {
+            float32x4_t peak = vdupq_n_f32(0);
+            float32x4_t sq = vdupq_n_f32(0);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                float32x4_t v = vld1q_f32(x + i);
+                peak = vmaxq_f32(peak, vabsq_f32(v));
+                sq = vmlaq_f32(sq, v, v);
+            }
+            float p[4];
+            float q[4];
+            vst1q_f32(p, peak);
+            vst1q_f32(q, sq);
+            sums s = measure_scalar(x + i, n - i);
+            for (int k = 0; k < 4; ++k) {
+                s.peak = std::max(s.peak, p[k]);
+                s.squares += q[k];
+            }
+            return s;
+        }
+
+#endif // SDL2XX_CAPTURE_NEON
+
+
+        using measure_func = sums (*)(const float*, std::size_t) noexcept;
+
+
+        measure_func
+        select_measure()
+            noexcept
+        {
+#ifdef SDL2XX_CAPTURE_AVX2
+            // AVX2 doesn't imply FMA on every CPU or VM, and SDL has no check for it.
+            if (SDL_HasAVX2() && __builtin_cpu_supports("fma"))
+                return measure_avx2;
+#endif
+#ifdef SDL2XX_CAPTURE_NEON
+            return measure_neon;
+#else
+            return measure_scalar;
+#endif
+        }
+
+
+        Uint64
+        now_ns()
+            noexcept
+        {
+            static const double ns_per_tick = 1e9 / SDL_GetPerformanceFrequency();
+            return SDL_GetPerformanceCounter() * ns_per_tick;
+        }
+
+    } // namespace
+
+
+    level
+    measure(std::span<const float> samples)
+        noexcept
+    {
+        static const measure_func f = select_measure();
+        if (samples.empty())
+            return {};
+        sums s = f(samples.data(), samples.size());
+        return {s.peak, std::sqrt(s.squares / samples.size())};
+    }
+
+
+    spectrum::spectrum(std::size_t size) :
+        size{size}
+    {
+        if (size < 2 || !std::has_single_bit(size))
+            throw error{"audio::spectrum: size must be a power of two"};
+
+        window.resize(size);
+        float sum = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            window[i] = 0.5f - 0.5f * std::cos(2 * std::numbers::pi_v<float> * i / size);
+            sum += window[i];
+        }
+        // A sine's energy is split between the positive and negative bins.
+        scale = 2 / sum;
+
+        twiddles.resize(size / 2);
+        for (std::size_t i = 0; i < size / 2; ++i)
+            twiddles[i] = std::polar(1.0f, -2 * std::numbers::pi_v<float> * i / size);
+
+        unsigned bits = std::countr_zero(size);
+        bit_reversed.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            unsigned r = 0;
+            for (unsigned b = 0; b < bits; ++b)
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            bit_reversed[i] = r;
+        }
+
+        buf.resize(size);
+        magnitudes.resize(size / 2 + 1);
+    }
+
+
+    std::span<const float>
+    spectrum::process(std::span<const float> samples,
+                      unsigned channels)
+        noexcept
+    {
+        channels = std::max(channels, 1u);
+        std::size_t frames = samples.size() / channels;
+        std::size_t used = std::min(frames, size);
+        const float* src = samples.data() + (frames - used) * channels;
+        std::size_t pad = size - used;
+
+        for (std::size_t i = 0; i < size; ++i) {
+            float v = 0;
+            if (i >= pad) {
+                const float* f = src + (i - pad) * channels;
+                for (unsigned c = 0; c < channels; ++c)
+                    v += f[c];
+                v /= channels;
+            }
+            buf[bit_reversed[i]] = v * window[i];
+        }
+
+        for (std::size_t len = 2; len <= size; len *= 2) {
+            std::size_t half = len / 2;
+            std::size_t stride = size / len;
+            for (std::size_t start = 0; start < size; start += len)
+                for (std::size_t k = 0; k < half; ++k) {
+                    auto t = twiddles[k * stride] * buf[start + k + half];
+                    buf[start + k + half] = buf[start + k] - t;
+                    buf[start + k] += t;
+                }
+        }
+
+        for (std::size_t i = 0; i <= size / 2; ++i)
+            magnitudes[i] = std::abs(buf[i]) * scale;
+        return magnitudes;
+    }
+
+
+    std::size_t
+    spectrum::get_size()
+        const noexcept
+    {
+        return size;
+    }
+
+
+    void
+    capture::sink::operator ()(std::span<float> samples)
+        noexcept
+    {
+        self->push(samples);
+    }
+
+
+    capture::capture(const char* name,
+                     const spec& desired,
+                     std::size_t num_blocks) :
+        num_blocks{num_blocks},
+        dev{name, true, desired, sink{this}}
+    {
+        if (!num_blocks)
+            throw error{"audio::capture: number of blocks must be greater than zero"};
+        // The device starts paused, so the callback can't run yet.
+        const spec& obtained = dev.get_spec();
+        block_size = std::max<std::size_t>(obtained.samples, 1) * obtained.channels;
+        headers.resize(num_blocks);
+        storage.resize(num_blocks * block_size);
+    }
+
+
+    capture::capture(const spec& desired,
+                     std::size_t num_blocks) :
+        capture{nullptr, desired, num_blocks}
+    {}
+
+
+    void
+    capture::push(std::span<const float> samples)
+        noexcept
+    {
+        const Uint64 now = now_ns();
+        const unsigned channels = dev.get_spec().channels;
+        const double ns_per_frame = 1e9 / dev.get_spec().freq;
+        const std::size_t total_frames = samples.size() / channels;
+
+        std::size_t offset = 0;
+        while (offset < samples.size()) {
+            std::size_t n = std::min(block_size, samples.size() - offset);
+            auto chunk = samples.subspan(offset, n);
+
+            // The last frame of the callback arrived just now.
+            std::size_t frames_left = total_frames - offset / channels;
+            Uint64 timestamp = now - Uint64(frames_left * ns_per_frame);
+
+            auto w = write_index.load(std::memory_order_relaxed);
+            auto r = read_index.load(std::memory_order_acquire);
+            if (w - r == num_blocks) {
+                overruns.fetch_add(1, std::memory_order_relaxed);
+                position += (samples.size() - offset) / channels;
+                return;
+            }
+
+            std::size_t slot = w % num_blocks;
+            std::ranges::copy(chunk, storage.begin() + slot * block_size);
+            level lv = measure(chunk);
+            headers[slot] = {timestamp, position, n, lv};
+            write_index.store(w + 1, std::memory_order_release);
+
+            last_peak.store(lv.peak, std::memory_order_relaxed);
+            last_rms.store(lv.rms, std::memory_order_relaxed);
+            position += n / channels;
+            offset += n;
+        }
+    }
+
+
+    void
+    capture::start()
+        noexcept
+    {
+        dev.unpause();
+    }
+
+
+    void
+    capture::stop()
+        noexcept
+    {
+        dev.pause();
+    }
+
+
+    std::optional<capture::block>
+    capture::front()
+        const noexcept
+    {
+        auto r = read_index.load(std::memory_order_relaxed);
+        auto w = write_index.load(std::memory_order_acquire);
+        if (r == w)
+            return {};
+        std::size_t slot = r % num_blocks;
+        const header& h = headers[slot];
+        return block{
+            h.timestamp,
+            h.position,
+            {storage.data() + slot * block_size, h.size},
+            h.levels
+        };
+    }
+
+
+    void
+    capture::pop()
+        noexcept
+    {
+        auto r = read_index.load(std::memory_order_relaxed);
+        if (r != write_index.load(std::memory_order_acquire))
+            read_index.store(r + 1, std::memory_order_release);
+    }
+
+
+    void
+    capture::clear()
+        noexcept
+    {
+        read_index.store(write_index.load(std::memory_order_acquire),
+                         std::memory_order_release);
+    }
+
+
+    std::size_t
+    capture::get_available()
+        const noexcept
+    {
+        auto r = read_index.load(std::memory_order_acquire);
+        auto w = write_index.load(std::memory_order_acquire);
+        return w - r;
+    }
+
+
+    level
+    capture::get_level()
+        const noexcept
+    {
+        return {
+            last_peak.load(std::memory_order_relaxed),
+            last_rms.load(std::memory_order_relaxed)
+        };
+    }
+
+
+    Uint64
+    capture::get_overruns()
+        const noexcept
+    {
+        return overruns.load(std::memory_order_relaxed);
+    }
+
+
+    const spec&
+    capture::get_spec()
+        const noexcept
+    {
+        return dev.get_spec();
+    }
+
+
+    device&
+    capture::get_device()
+        noexcept
+    {
+        return dev;
+    }
+
+} // namespace sdl::audio
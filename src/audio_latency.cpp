@@ -0,0 +1,323 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <SDL_timer.h>
+
+#include "audio_latency.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::audio {
+
+    namespace {
+
+        double
+        ms_per_tick()
+            noexcept
+        {
+            static const double result = 1000.0 / SDL_GetPerformanceFrequency();
+            return result;
+        }
+
+    } // namespace
+
+
+    void
+    SDLCALL
+    latency_monitor::trampoline(void* ctx,
+                                Uint8* stream,
+                                int len)
+        noexcept
+    {
+        auto self = static_cast<latency_monitor*>(ctx);
+        const double period = self->period_ms.load(std::memory_order_relaxed);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (self->restart.exchange(false, std::memory_order_acquire))
+            self->last_call = 0;
+        // Only this thread writes num_calls, so a reset from another thread can't be lost.
+        if (self->reset_pending.load(std::memory_order_acquire)) {
+            self->num_calls.store(0, std::memory_order_relaxed);
+            self->late_calls.store(0, std::memory_order_relaxed);
+            self->reset_pending.store(false, std::memory_order_release);
+        }
+        double interval = self->last_call ? (start - self->last_call) * ms_per_tick() : period;
+        self->last_call = start;
+
+        self->user_callback(self->user_data, stream, len);
+
+        double elapsed = (SDL_GetPerformanceCounter() - start) * ms_per_tick();
+        std::size_t n = self->num_calls.load(std::memory_order_relaxed);
+        self->intervals[n % history_size].store(interval, std::memory_order_relaxed);
+        self->busy[n % history_size].store(elapsed, std::memory_order_relaxed);
+        self->num_calls.store(n + 1, std::memory_order_release);
+        if (interval > 1.5 * period)
+            self->late_calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+
+    void
+    latency_monitor::instrument(spec& desired)
+        noexcept
+    {
+        if (!desired.callback || desired.callback == trampoline)
+            return;
+        user_callback = desired.callback;
+        user_data = desired.userdata;
+        desired.callback = trampoline;
+        desired.userdata = this;
+    }
+
+
+    void
+    latency_monitor::set_spec(const spec& obtained)
+        noexcept
+    {
+        if (obtained.freq > 0)
+            period_ms.store(obtained.samples * 1000.0 / obtained.freq,
+                            std::memory_order_relaxed);
+        bytes_per_second.store(obtained.freq * obtained.channels
+                               * SDL_AUDIO_BITSIZE(obtained.format) / 8,
+                               std::memory_order_relaxed);
+    }
+
+
+    void
+    latency_monitor::sample(const device& dev)
+        noexcept
+    {
+        int bps = bytes_per_second.load(std::memory_order_relaxed);
+        if (!bps)
+            return;
+        std::size_t queued = dev.get_size();
+        queued_ms = queued * 1000.0 / bps;
+        queued_max_ms = std::max(queued_max_ms, queued_ms);
+        if (!queued && had_queued
+            && SDL_GetAudioDeviceStatus(dev.data()) == SDL_AUDIO_PLAYING)
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        had_queued = queued;
+    }
+
+
+    void
+    latency_monitor::add_underrun()
+        noexcept
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+
+    void
+    latency_monitor::pause(device& dev)
+        noexcept
+    {
+        dev.pause();
+        restart.store(true, std::memory_order_release);
+    }
+
+
+    void
+    latency_monitor::unpause(device& dev)
+        noexcept
+    {
+        restart.store(true, std::memory_order_release);
+        dev.unpause();
+    }
+
+
+    latency_monitor::stats
+    latency_monitor::get_stats()
+        const noexcept
+    {
+        stats result;
+        result.period_ms = period_ms.load(std::memory_order_relaxed);
+        result.underruns = underruns.load(std::memory_order_relaxed);
+        result.queued_ms = queued_ms;
+        result.queued_max_ms = queued_max_ms;
+        result.latency_ms = result.period_ms + queued_ms;
+        // Until the audio thread handles the reset, the counters are stale.
+        if (reset_pending.load(std::memory_order_acquire))
+            return result;
+        result.callbacks = num_calls.load(std::memory_order_acquire);
+        result.late_callbacks = late_calls.load(std::memory_order_relaxed);
+
+        std::size_t n = std::min<std::size_t>(result.callbacks, history_size);
+        if (!n)
+            return result;
+        double sum = 0;
+        double sum_sq = 0;
+        double busy_sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            double x = intervals[i].load(std::memory_order_relaxed);
+            double b = busy[i].load(std::memory_order_relaxed);
+            sum += x;
+            sum_sq += x * x;
+            result.interval_max_ms = std::max(result.interval_max_ms, x);
+            busy_sum += b;
+            result.busy_max_ms = std::max(result.busy_max_ms, b);
+        }
+        result.interval_mean_ms = sum / n;
+        result.interval_jitter_ms
+            = std::sqrt(std::max(0.0, sum_sq / n - result.interval_mean_ms * result.interval_mean_ms));
+        result.busy_mean_ms = busy_sum / n;
+        return result;
+    }
+
+
+    void
+    latency_monitor::reset()
+        noexcept
+    {
+        restart.store(true, std::memory_order_release);
+        reset_pending.store(true, std::memory_order_release);
+        underruns.store(0, std::memory_order_relaxed);
+        queued_ms = 0;
+        queued_max_ms = 0;
+        had_queued = false;
+    }
+
+
+    auto_tuner::auto_tuner(device& dev,
+                           const char* name,
+                           const spec& desired,
+                           Uint16 min_samples,
+                           Uint16 max_samples,
+                           Uint64 settle_ms) :
+        dev(dev),
+        name{name ? name : ""},
+        desired{desired},
+        min_samples{min_samples},
+        max_samples{max_samples},
+        settle_ms{settle_ms}
+    {
+        if (!min_samples || min_samples > max_samples)
+            throw error{"audio::auto_tuner: invalid buffer size range"};
+        monitor.instrument(this->desired);
+        reopen(std::clamp<Uint16>(desired.samples ? desired.samples : 1024,
+                                  min_samples, max_samples));
+    }
+
+
+    auto_tuner::auto_tuner(device& dev,
+                           const spec& desired,
+                           Uint16 min_samples,
+                           Uint16 max_samples,
+                           Uint64 settle_ms) :
+        auto_tuner{dev, nullptr, desired, min_samples, max_samples, settle_ms}
+    {}
+
+
+    auto_tuner::~auto_tuner()
+        noexcept
+    {
+        dev.destroy();
+    }
+
+
+    void
+    auto_tuner::reopen(Uint16 samples)
+    {
+        bool playing = dev.is_valid()
+            && SDL_GetAudioDeviceStatus(dev.data()) == SDL_AUDIO_PLAYING;
+        desired.samples = samples;
+        dev.create(name.empty() ? nullptr : name.c_str(),
+                   false,
+                   desired,
+                   obtained,
+                   convert(allow_change::samples));
+        monitor.set_spec(obtained);
+        monitor.reset();
+        last_failures = 0;
+        last_change = SDL_GetTicks64();
+        if (playing)
+            monitor.unpause(dev);
+    }
+
+
+    bool
+    auto_tuner::update()
+    {
+        monitor.sample(dev);
+        auto s = monitor.get_stats();
+        Uint64 now = SDL_GetTicks64();
+        unsigned current = obtained.samples;
+
+        Uint64 failures = s.late_callbacks + s.underruns;
+        if (failures > last_failures) {
+            last_failures = failures;
+            last_failure = now;
+            if (current < max_samples) {
+                fail_floor = std::min(current * 2, unsigned{max_samples});
+                reopen(fail_floor);
+                return true;
+            }
+            last_change = now;
+            return false;
+        }
+
+        // The load may have dropped since the last failure, so allow probing again.
+        if (fail_floor && now - last_failure >= 10 * settle_ms)
+            fail_floor = 0;
+
+        if (now - last_change < settle_ms)
+            return false;
+        unsigned smaller = current / 2;
+        if (smaller < min_samples || smaller < fail_floor)
+            return false;
+        // The callback must fit comfortably in the smaller period.
+        if (s.callbacks && s.busy_max_ms > s.period_ms / 4)
+            return false;
+        reopen(smaller);
+        return true;
+    }
+
+
+    void
+    auto_tuner::pause()
+        noexcept
+    {
+        monitor.pause(dev);
+    }
+
+
+    void
+    auto_tuner::unpause()
+        noexcept
+    {
+        monitor.unpause(dev);
+    }
+
+
+    const spec&
+    auto_tuner::get_spec()
+        const noexcept
+    {
+        return obtained;
+    }
+
+
+    latency_monitor&
+    auto_tuner::get_monitor()
+        noexcept
+    {
+        return monitor;
+    }
+
+
+    const latency_monitor&
+    auto_tuner::get_monitor()
+        const noexcept
+    {
+        return monitor;
+    }
+
+} // namespace sdl::audio
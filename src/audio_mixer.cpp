@@ -0,0 +1,679 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include <SDL_cpuinfo.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SDL2XX_MIXER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define SDL2XX_MIXER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "audio_mixer.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::audio {
+
+    namespace {
+
+        // Voice ids carry the slot index in the low bits, and a serial number in the
+        // high bits, so stale ids don't match a reused slot.
+        constexpr unsigned index_bits = 16;
+        constexpr unsigned index_mask = (1u << index_bits) - 1;
+
+
+        struct kernels {
+
+            // Add a mono source to the bus, with gains ramping by `dl` and `dr` per frame.
+            void (*mix_mono)(float* l, float* r, const float* src, std::size_t n,
+                             float gl, float dl, float gr, float dr) noexcept;
+
+            // Same, for an interleaved stereo source.
+            void (*mix_stereo)(float* l, float* r, const float* src, std::size_t n,
+                               float gl, float dl, float gr, float dr) noexcept;
+
+            // Clamp and interleave the bus.
+            void (*to_f32)(float* out, const float* l, const float* r, std::size_t n) noexcept;
+            void (*to_s16)(Sint16* out, const float* l, const float* r, std::size_t n) noexcept;
+
+        };
+
+
+        void
+        mix_mono_scalar(float* l,
+                        float* r,
+                        const float* src,
+                        std::size_t n,
+                        float gl,
+                        float dl,
+                        float gr,
+                        float dr)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                float s = src[i];
+                l[i] += s * (gl + i * dl);
+                r[i] += s * (gr + i * dr);
+            }
+        }
+
+
+        void
+        mix_stereo_scalar(float* l,
+                          float* r,
+                          const float* src,
+                          std::size_t n,
+                          float gl,
+                          float dl,
+                          float gr,
+                          float dr)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                l[i] += src[2 * i + 0] * (gl + i * dl);
+                r[i] += src[2 * i + 1] * (gr + i * dr);
+            }
+        }
+
+
+        void
+        to_f32_scalar(float* out,
+                      const float* l,
+                      const float* r,
+                      std::size_t n)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                out[2 * i + 0] = std::clamp(l[i], -1.0f, 1.0f);
+                out[2 * i + 1] = std::clamp(r[i], -1.0f, 1.0f);
+            }
+        }
+
+
+        void
+        to_s16_scalar(Sint16* out,
+                      const float* l,
+                      const float* r,
+                      std::size_t n)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                out[2 * i + 0] = static_cast<Sint16>(std::clamp(l[i], -1.0f, 1.0f) * 32767.0f);
+                out[2 * i + 1] = static_cast<Sint16>(std::clamp(r[i], -1.0f, 1.0f) * 32767.0f);
+            }
+        }
+
+
+#ifdef SDL2XX_MIXER_AVX2
+
+        __attribute__((target("avx2")))
+        void
+        mix_mono_avx2(float* l,
+                      float* r,
+                      const float* src,
+                      std::size_t n,
+                      float gl,
+                      float dl,
+                      float gr,
+                      float dr)
+            noexcept
+        {
+            const __m256 idx = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256 vdl = _mm256_set1_ps(dl);
+            const __m256 vdr = _mm256_set1_ps(dr);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 fi = _mm256_add_ps(_mm256_set1_ps(i), idx);
+                __m256 vgl = _mm256_add_ps(_mm256_set1_ps(gl), _mm256_mul_ps(fi, vdl));
+                __m256 vgr = _mm256_add_ps(_mm256_set1_ps(gr), _mm256_mul_ps(fi, vdr));
+                __m256 s = _mm256_loadu_ps(src + i);
+                _mm256_storeu_ps(l + i, _mm256_add_ps(_mm256_loadu_ps(l + i), _mm256_mul_ps(s, vgl)));
+                _mm256_storeu_ps(r + i, _mm256_add_ps(_mm256_loadu_ps(r + i), _mm256_mul_ps(s, vgr)));
+            }
+            mix_mono_scalar(l + i, r + i, src + i, n - i, gl + i * dl, dl, gr + i * dr, dr);
+        }
+
+
+        __attribute__((target("avx2")))
+        void
+        mix_stereo_avx2(float* l,
+                        float* r,
+                        const float* src,
+                        std::size_t n,
+                        float gl,
+                        float dl,
+                        float gr,
+                        float dr)
+            noexcept
+        {
+            const __m256 idx = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256 vdl = _mm256_set1_ps(dl);
+            const __m256 vdr = _mm256_set1_ps(dr);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 fi = _mm256_add_ps(_mm256_set1_ps(i), idx);
+                __m256 vgl = _mm256_add_ps(_mm256_set1_ps(gl), _mm256_mul_ps(fi, vdl));
+                __m256 vgr = _mm256_add_ps(_mm256_set1_ps(gr), _mm256_mul_ps(fi, vdr));
+                // Deinterleave 8 frames: the shuffle leaves pairs out of order, the
+                // permute fixes that.
+                __m256 a = _mm256_loadu_ps(src + 2 * i);
+                __m256 b = _mm256_loadu_ps(src + 2 * i + 8);
+                __m256 sl = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                __m256 sr = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                sl = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sl),
+                                                            _MM_SHUFFLE(3, 1, 2, 0)));
+                sr = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sr),
+                                                            _MM_SHUFFLE(3, 1, 2, 0)));
+                _mm256_storeu_ps(l + i, _mm256_add_ps(_mm256_loadu_ps(l + i), _mm256_mul_ps(sl, vgl)));
+                _mm256_storeu_ps(r + i, _mm256_add_ps(_mm256_loadu_ps(r + i), _mm256_mul_ps(sr, vgr)));
+            }
+            mix_stereo_scalar(l + i, r + i, src + 2 * i, n - i, gl + i * dl, dl, gr + i * dr, dr);
+        }
+
+
+        __attribute__((target("avx2")))
+        void
+        to_f32_avx2(float* out,
+                    const float* l,
+                    const float* r,
+                    std::size_t n)
+            noexcept
+        {
+            const __m256 lo = _mm256_set1_ps(-1.0f);
+            const __m256 hi = _mm256_set1_ps(1.0f);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 vl = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(l + i), lo), hi);
+                __m256 vr = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(r + i), lo), hi);
+                __m256 a = _mm256_unpacklo_ps(vl, vr);
+                __m256 b = _mm256_unpackhi_ps(vl, vr);
+                _mm256_storeu_ps(out + 2 * i,     _mm256_permute2f128_ps(a, b, 0x20));
+                _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(a, b, 0x31));
+            }
+            to_f32_scalar(out + 2 * i, l + i, r + i, n - i);
+        }
+
+
+        __attribute__((target("avx2")))
+        void
+        to_s16_avx2(Sint16* out,
+                    const float* l,
+                    const float* r,
+                    std::size_t n)
+            noexcept
+        {
+            const __m256 lo = _mm256_set1_ps(-1.0f);
+            const __m256 hi = _mm256_set1_ps(1.0f);
+            const __m256 scale = _mm256_set1_ps(32767.0f);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 vl = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(l + i), lo), hi);
+                __m256 vr = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(r + i), lo), hi);
+                __m256i il = _mm256_cvttps_epi32(_mm256_mul_ps(vl, scale));
+                __m256i ir = _mm256_cvttps_epi32(_mm256_mul_ps(vr, scale));
+                // The per-lane unpack and pack cancel out, leaving frames in order.
+                __m256i a = _mm256_unpacklo_epi32(il, ir);
+                __m256i b = _mm256_unpackhi_epi32(il, ir);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i),
+                                    _mm256_packs_epi32(a, b));
+            }
+            to_s16_scalar(out + 2 * i, l + i, r + i, n - i);
+        }
+
+#endif // SDL2XX_MIXER_AVX2
+
+
+#ifdef SDL2XX_MIXER_NEON
+
+        void
+        mix_mono_neon(float* l,
+                      float* r,
+                      const float* src,
+                      std::size_t n,
+                      float gl,
+                      float dl,
+                      float gr,
+                      float dr)
+            noexcept
+        {
+            const float idx_init[4] = {0, 1, 2, 3};
+            const float32x4_t idx = vld1q_f32(idx_init);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                float32x4_t fi = vaddq_f32(vdupq_n_f32(i), idx);
+                float32x4_t vgl = vmlaq_n_f32(vdupq_n_f32(gl), fi, dl);
+                float32x4_t vgr = vmlaq_n_f32(vdupq_n_f32(gr), fi, dr);
+                float32x4_t s = vld1q_f32(src + i);
+                vst1q_f32(l + i, vmlaq_f32(vld1q_f32(l + i), s, vgl));
+                vst1q_f32(r + i, vmlaq_f32(vld1q_f32(r + i), s, vgr));
+            }
+            mix_mono_scalar(l + i, r + i, src + i, n - i, gl + i * dl, dl, gr + i * dr, dr);
+        }
+
+
+        void
+        mix_stereo_neon(float* l,
+                        float* r,
+                        const float* src,
+                        std::size_t n,
+                        float gl,
+                        float dl,
+                        float gr,
+                        float dr)
+            noexcept
+        {
+            const float idx_init[4] = {0, 1, 2, 3};
+            const float32x4_t idx = vld1q_f32(idx_init);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                float32x4_t fi = vaddq_f32(vdupq_n_f32(i), idx);
+                float32x4_t vgl = vmlaq_n_f32(vdupq_n_f32(gl), fi, dl);
+                float32x4_t vgr = vmlaq_n_f32(vdupq_n_f32(gr), fi, dr);
+                float32x4x2_t s = vld2q_f32(src + 2 * i);
+                vst1q_f32(l + i, vmlaq_f32(vld1q_f32(l + i), s.val[0], vgl));
+                vst1q_f32(r + i, vmlaq_f32(vld1q_f32(r + i), s.val[1], vgr));
+            }
+            mix_stereo_scalar(l + i, r + i, src + 2 * i, n - i, gl + i * dl, dl, gr + i * dr, dr);
+        }
+
+
+        void
+        to_f32_neon(float* out,
+                    const float* l,
+                    const float* r,
+                    std::size_t n)
+            noexcept
+        {
+            const float32x4_t lo = vdupq_n_f32(-1.0f);
+            const float32x4_t hi = vdupq_n_f32(1.0f);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                float32x4x2_t v;
+                v.val[0] = vminq_f32(vmaxq_f32(vld1q_f32(l + i), lo), hi);
+                v.val[1] = vminq_f32(vmaxq_f32(vld1q_f32(r + i), lo), hi);
+                vst2q_f32(out + 2 * i, v);
+            }
+            to_f32_scalar(out + 2 * i, l + i, r + i, n - i);
+        }
+
+
+        void
+        to_s16_neon(Sint16* out,
+                    const float* l,
+                    const float* r,
+                    std::size_t n)
+            noexcept
+        {
+            const float32x4_t lo = vdupq_n_f32(-1.0f);
+            const float32x4_t hi = vdupq_n_f32(1.0f);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                float32x4_t vl = vminq_f32(vmaxq_f32(vld1q_f32(l + i), lo), hi);
+                float32x4_t vr = vminq_f32(vmaxq_f32(vld1q_f32(r + i), lo), hi);
+                int16x4x2_t v;
+                v.val[0] = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(vl, 32767.0f)));
+                v.val[1] = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(vr, 32767.0f)));
+                vst2_s16(out + 2 * i, v);
+            }
+            to_s16_scalar(out + 2 * i, l + i, r + i, n - i);
+        }
+
+#endif // SDL2XX_MIXER_NEON
+
+
+        const kernels&
+        get_kernels(mixer::simd path)
+            noexcept
+        {
+            static const kernels scalar{mix_mono_scalar,
+                                        mix_stereo_scalar,
+                                        to_f32_scalar,
+                                        to_s16_scalar};
+#ifdef SDL2XX_MIXER_AVX2
+            static const kernels avx2{mix_mono_avx2, mix_stereo_avx2, to_f32_avx2, to_s16_avx2};
+            if (path == mixer::simd::avx2)
+                return avx2;
+#endif
+#ifdef SDL2XX_MIXER_NEON
+            static const kernels neon{mix_mono_neon, mix_stereo_neon, to_f32_neon, to_s16_neon};
+            if (path == mixer::simd::neon)
+                return neon;
+#endif
+            return scalar;
+        }
+
+
+        mixer::simd
+        best_simd()
+            noexcept
+        {
+            if (mixer::is_supported(mixer::simd::avx2))
+                return mixer::simd::avx2;
+            if (mixer::is_supported(mixer::simd::neon))
+                return mixer::simd::neon;
+            return mixer::simd::scalar;
+        }
+
+    } // namespace
+
+
+    mixer::mixer(std::size_t block_frames,
+                 unsigned ramp_frames) :
+        bus_l(block_frames ? block_frames : default_block_frames),
+        bus_r(bus_l.size()),
+        ramp_frames{ramp_frames},
+        path{best_simd()}
+    {}
+
+
+    void
+    mixer::retarget(voice& v)
+        noexcept
+    {
+        float pan = std::clamp(v.pan, -1.0f, 1.0f);
+        if (v.stopping) {
+            v.target_l = v.target_r = 0;
+        } else if (v.channels == 1) {
+            // Constant-power pan law.
+            float angle = (pan + 1) * std::numbers::pi_v<float> / 4;
+            v.target_l = v.gain * std::cos(angle);
+            v.target_r = v.gain * std::sin(angle);
+        } else {
+            // Balance: only attenuate the opposite side.
+            v.target_l = v.gain * std::min(1.0f, 1 - pan);
+            v.target_r = v.gain * std::min(1.0f, 1 + pan);
+        }
+        v.ramp_left = ramp_frames;
+        if (!v.ramp_left) {
+            v.cur_l = v.target_l;
+            v.cur_r = v.target_r;
+        }
+    }
+
+
+    void
+    mixer::deactivate(voice& v)
+        noexcept
+    {
+        v.active = false;
+        v.samples = {};
+        --num_active;
+    }
+
+
+    void
+    mixer::mix_voice(voice& v,
+                     std::size_t frames)
+        noexcept
+    {
+        const kernels& k = get_kernels(path);
+        std::size_t done = 0;
+        while (done < frames && v.active) {
+            std::size_t n = std::min(frames - done, v.frames - v.pos);
+            float dl = 0;
+            float dr = 0;
+            if (v.ramp_left) {
+                n = std::min<std::size_t>(n, v.ramp_left);
+                dl = (v.target_l - v.cur_l) / v.ramp_left;
+                dr = (v.target_r - v.cur_r) / v.ramp_left;
+            }
+
+            // Silent voices only advance.
+            if (v.ramp_left || v.cur_l != 0 || v.cur_r != 0) {
+                const float* src = v.samples.data() + v.pos * v.channels;
+                if (v.channels == 1)
+                    k.mix_mono(bus_l.data() + done, bus_r.data() + done, src, n,
+                               v.cur_l, dl, v.cur_r, dr);
+                else
+                    k.mix_stereo(bus_l.data() + done, bus_r.data() + done, src, n,
+                                 v.cur_l, dl, v.cur_r, dr);
+            }
+
+            if (v.ramp_left) {
+                v.ramp_left -= n;
+                if (v.ramp_left) {
+                    v.cur_l += dl * n;
+                    v.cur_r += dr * n;
+                } else {
+                    v.cur_l = v.target_l;
+                    v.cur_r = v.target_r;
+                    if (v.stopping) {
+                        deactivate(v);
+                        break;
+                    }
+                }
+            }
+
+            v.pos += n;
+            done += n;
+            if (v.pos == v.frames) {
+                if (v.loop)
+                    v.pos = 0;
+                else
+                    deactivate(v);
+            }
+        }
+    }
+
+
+    void
+    mixer::mix_block(std::size_t frames)
+        noexcept
+    {
+        std::fill_n(bus_l.begin(), frames, 0.0f);
+        std::fill_n(bus_r.begin(), frames, 0.0f);
+        for (auto& v : voices)
+            if (v.active)
+                mix_voice(v, frames);
+    }
+
+
+    mixer::voice*
+    mixer::find(voice_id id)
+        noexcept
+    {
+        unsigned index = id & index_mask;
+        if (index >= voices.size())
+            return nullptr;
+        voice& v = voices[index];
+        if (!v.active || v.serial != id >> index_bits)
+            return nullptr;
+        return &v;
+    }
+
+
+    const mixer::voice*
+    mixer::find(voice_id id)
+        const noexcept
+    {
+        return const_cast<mixer*>(this)->find(id);
+    }
+
+
+    mixer::voice_id
+    mixer::play(std::span<const float> samples,
+                unsigned channels,
+                float gain,
+                float pan,
+                bool loop)
+    {
+        if (channels != 1 && channels != 2)
+            throw error{"audio::mixer: only mono and stereo voices are supported"};
+        if (samples.size() < channels)
+            throw error{"audio::mixer: no samples to play"};
+
+        auto it = std::ranges::find(voices, false, &voice::active);
+        if (it == voices.end()) {
+            if (voices.size() >= index_mask)
+                throw error{"audio::mixer: too many voices"};
+            voices.emplace_back();
+            it = voices.end() - 1;
+        }
+        voice& v = *it;
+        v = voice{};
+        v.samples = samples;
+        v.serial = next_serial++ & (~0u >> index_bits);
+        v.channels = channels;
+        v.frames = samples.size() / channels;
+        v.loop = loop;
+        v.active = true;
+        v.gain = gain;
+        v.pan = pan;
+        // Fade in from silence.
+        retarget(v);
+        ++num_active;
+
+        unsigned index = it - voices.begin();
+        return v.serial << index_bits | index;
+    }
+
+
+    void
+    mixer::stop(voice_id id)
+        noexcept
+    {
+        if (auto v = find(id)) {
+            v->stopping = true;
+            retarget(*v);
+            if (!v->ramp_left)
+                deactivate(*v);
+        }
+    }
+
+
+    void
+    mixer::clear()
+        noexcept
+    {
+        for (auto& v : voices)
+            if (v.active)
+                deactivate(v);
+    }
+
+
+    void
+    mixer::set_gain(voice_id id,
+                    float gain)
+        noexcept
+    {
+        if (auto v = find(id)) {
+            v->gain = gain;
+            retarget(*v);
+        }
+    }
+
+
+    void
+    mixer::set_pan(voice_id id,
+                   float pan)
+        noexcept
+    {
+        if (auto v = find(id)) {
+            v->pan = pan;
+            retarget(*v);
+        }
+    }
+
+
+    bool
+    mixer::is_playing(voice_id id)
+        const noexcept
+    {
+        return find(id);
+    }
+
+
+    std::size_t
+    mixer::get_num_voices()
+        const noexcept
+    {
+        return num_active;
+    }
+
+
+    bool
+    mixer::is_supported(simd s)
+        noexcept
+    {
+        switch (s) {
+            case simd::scalar:
+                return true;
+            case simd::avx2:
+#ifdef SDL2XX_MIXER_AVX2
+                return SDL_HasAVX2();
+#else
+                return false;
+#endif
+            case simd::neon:
+#ifdef SDL2XX_MIXER_NEON
+                return true;
+#else
+                return false;
+#endif
+        }
+        return false;
+    }
+
+
+    void
+    mixer::set_simd(simd s)
+    {
+        if (!is_supported(s))
+            throw error{"audio::mixer: SIMD kernels are not supported"};
+        path = s;
+    }
+
+
+    mixer::simd
+    mixer::get_simd()
+        const noexcept
+    {
+        return path;
+    }
+
+
+    void
+    mixer::mix(std::span<float> out)
+        noexcept
+    {
+        const kernels& k = get_kernels(path);
+        std::size_t frames = out.size() / 2;
+        for (std::size_t done = 0; done < frames;) {
+            std::size_t n = std::min(frames - done, bus_l.size());
+            mix_block(n);
+            k.to_f32(out.data() + 2 * done, bus_l.data(), bus_r.data(), n);
+            done += n;
+        }
+    }
+
+
+    void
+    mixer::mix(std::span<Sint16> out)
+        noexcept
+    {
+        const kernels& k = get_kernels(path);
+        std::size_t frames = out.size() / 2;
+        for (std::size_t done = 0; done < frames;) {
+            std::size_t n = std::min(frames - done, bus_l.size());
+            mix_block(n);
+            k.to_s16(out.data() + 2 * done, bus_l.data(), bus_r.data(), n);
+            done += n;
+        }
+    }
+
+} // namespace sdl::audio
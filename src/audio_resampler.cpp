@@ -0,0 +1,434 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#include <SDL_cpuinfo.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SDL2XX_RESAMPLER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define SDL2XX_RESAMPLER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "audio_resampler.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::audio {
+
+    namespace {
+
+        // Above this, the filter table is interpolated instead of having one row per
+        // phase.
+        constexpr Uint64 max_table_phases = 256;
+
+        constexpr std::size_t max_taps = 1024;
+
+
+        struct filter_params {
+            std::size_t taps;
+            double rolloff;
+            double beta;
+        };
+
+
+        filter_params
+        get_params(resampler::quality q)
+            noexcept
+        {
+            switch (q) {
+                case resampler::quality::linear:
+                    return {2, 1, 0};
+                case resampler::quality::low:
+                    return {16, 0.85, 6};
+                case resampler::quality::high:
+                    return {64, 0.94, 10};
+                case resampler::quality::medium:
+                default:
+                    return {32, 0.9, 8};
+            }
+        }
+
+
+        // Modified Bessel function of the first kind, order 0.
+        double
+        bessel_i0(double x)
+            noexcept
+        {
+            double sum = 1;
+            double term = 1;
+            double y = x * x / 4;
+            for (int k = 1; term > sum * 1e-12; ++k) {
+                term *= y / (double(k) * k);
+                sum += term;
+            }
+            return sum;
+        }
+
+
+        double
+        sinc(double x)
+            noexcept
+        {
+            if (x == 0)
+                return 1;
+            double px = std::numbers::pi * x;
+            return std::sin(px) / px;
+        }
+
+
+        float
+        dot_scalar(const float* a,
+                   const float* b,
+                   std::size_t n)
+            noexcept
+        {
+            float sum = 0;
+            for (std::size_t i = 0; i < n; ++i)
+                sum += a[i] * b[i];
+            return sum;
+        }
+
+
+#ifdef SDL2XX_RESAMPLER_AVX2
+
+        __attribute__((target("avx2,fma")))
+        float
+        dot_avx2(const float* a,
+                 const float* b,
+                 std::size_t n)
+            noexcept
+        {
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                                       _mm256_loadu_ps(b + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                                       _mm256_loadu_ps(b + i + 8), acc1);
+            }
+            for (; i + 8 <= n; i += 8)
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                                       _mm256_loadu_ps(b + i), acc0);
+            __m256 acc = _mm256_add_ps(acc0, acc1);
+            __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc),
+                                  _mm256_extractf128_ps(acc, 1));
+            s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+            s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+            return _mm_cvtss_f32(s) + dot_scalar(a + i, b + i, n - i);
+        }
+
+#endif // SDL2XX_RESAMPLER_AVX2
+
+
+#ifdef SDL2XX_RESAMPLER_NEON
+
+        float
+        dot_neon(const float* a,
+                 const float* b,
+                 std::size_t n)
+            noexcept
+        {
+            float32x4_t acc = vdupq_n_f32(0);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+#ifdef __aarch64__
+            float sum = vaddvq_f32(acc);
+#else
+            float32x2_t s = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+            float sum = vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+            return sum + dot_scalar(a + i, b + i, n - i);
+        }
+
+#endif // SDL2XX_RESAMPLER_NEON
+
+
+        using dot_func = float (*)(const float*, const float*, std::size_t) noexcept;
+
+
+        dot_func
+        select_dot()
+            noexcept
+        {
+#ifdef SDL2XX_RESAMPLER_AVX2
+            // The kernel also uses FMA, which some AVX2 CPUs lack.
+            if (SDL_HasAVX2() && __builtin_cpu_supports("fma"))
+                return dot_avx2;
+#endif
+#ifdef SDL2XX_RESAMPLER_NEON
+            return dot_neon;
+#else
+            return dot_scalar;
+#endif
+        }
+
+
+        dot_func
+        get_dot()
+            noexcept
+        {
+            static const dot_func f = select_dot();
+            return f;
+        }
+
+    } // namespace
+
+
+    resampler::resampler(unsigned channels,
+                         int src_rate,
+                         int dst_rate,
+                         quality q) :
+        channels{channels},
+        src_rate{src_rate},
+        dst_rate{dst_rate}
+    {
+        if (!channels)
+            throw error{"audio::resampler: channels must be greater than zero"};
+        if (src_rate <= 0 || dst_rate <= 0)
+            throw error{"audio::resampler: invalid sample rate"};
+
+        Uint64 g = std::gcd(src_rate, dst_rate);
+        step = src_rate / g;
+        phases = dst_rate / g;
+        table_phases = std::min(phases, max_table_phases);
+
+        auto params = get_params(q);
+        double ratio = double(phases) / step;
+        double cutoff = params.rolloff * std::min(1.0, ratio);
+        if (q == quality::linear)
+            taps = params.taps;
+        else {
+            // When downsampling, the filter gets wider to keep the same transition band.
+            double wanted = std::ceil(params.taps * std::max(1.0, 1 / ratio));
+            taps = std::min(max_taps, (static_cast<std::size_t>(wanted) + 7) & ~std::size_t{7});
+        }
+
+        // Tap k of row p sits at distance k - (half - 1) - p / table_phases from the
+        // output position.
+        const double half = taps / 2;
+        const double i0_beta = bessel_i0(params.beta);
+        table.resize((table_phases + 1) * taps);
+        for (std::size_t p = 0; p <= table_phases; ++p) {
+            double d = double(p) / table_phases;
+            float* row = table.data() + p * taps;
+            double sum = 0;
+            for (std::size_t k = 0; k < taps; ++k) {
+                double x = k - (half - 1) - d;
+                double h;
+                if (q == quality::linear)
+                    h = std::max(0.0, 1 - std::abs(x));
+                else {
+                    double u = x / half;
+                    double w = std::abs(u) < 1
+                        ? bessel_i0(params.beta * std::sqrt(1 - u * u)) / i0_beta
+                        : 0;
+                    h = cutoff * sinc(cutoff * x) * w;
+                }
+                row[k] = h;
+                sum += h;
+            }
+            // Unity gain at DC for every phase.
+            for (std::size_t k = 0; k < taps; ++k)
+                row[k] /= sum;
+        }
+
+        if (table_phases != phases) {
+            deltas.resize(table_phases * taps);
+            for (std::size_t i = 0; i < deltas.size(); ++i)
+                deltas[i] = table[i + taps] - table[i];
+        }
+
+        planes.resize(channels);
+        reset_planes();
+    }
+
+
+    void
+    resampler::reset_planes()
+    {
+        // Pad the front so the first output lines up with the first input frame.
+        for (auto& plane : planes)
+            plane.assign(taps / 2 - 1, 0.0f);
+        pos = 0;
+        frac = 0;
+    }
+
+
+    void
+    resampler::compact()
+    {
+        // When downsampling, pos may have skipped past the end.
+        std::size_t drop = std::min(pos, planes.front().size());
+        if (!drop)
+            return;
+        for (auto& plane : planes)
+            plane.erase(plane.begin(), plane.begin() + drop);
+        pos -= drop;
+    }
+
+
+    std::size_t
+    resampler::available_frames()
+        const noexcept
+    {
+        std::size_t size = planes.front().size();
+        if (size < pos + taps)
+            return 0;
+        // Count outputs whose first tap stays within the buffered frames.
+        Uint64 spare = size - taps - pos;
+        Uint64 result = ((spare + 1) * phases - frac + step - 1) / step;
+        if (flushed) {
+            Uint64 expected = (total_in * phases + step - 1) / step;
+            result = std::min(result, expected - std::min(expected, total_out));
+        }
+        return result;
+    }
+
+
+    void
+    resampler::put(const float* samples,
+                   std::size_t count)
+    {
+        if (flushed) {
+            // The flush padding becomes part of the stream.
+            flushed = false;
+            total_in += taps / 2;
+        }
+        compact();
+        std::size_t frames = count / channels;
+        std::size_t old_size = planes.front().size();
+        for (unsigned c = 0; c < channels; ++c) {
+            auto& plane = planes[c];
+            plane.resize(old_size + frames);
+            float* dst = plane.data() + old_size;
+            for (std::size_t i = 0; i < frames; ++i)
+                dst[i] = samples[i * channels + c];
+        }
+        total_in += frames;
+    }
+
+
+    std::size_t
+    resampler::get(float* samples,
+                   std::size_t count)
+        noexcept
+    {
+        const dot_func dot = get_dot();
+        std::size_t frames = std::min(count / channels, available_frames());
+        for (std::size_t i = 0; i < frames; ++i) {
+            std::size_t row;
+            float w = 0;
+            if (deltas.empty())
+                row = frac;
+            else {
+                Uint64 t = frac * table_phases;
+                row = t / phases;
+                w = float(t % phases) / phases;
+            }
+            const float* h = table.data() + row * taps;
+            for (unsigned c = 0; c < channels; ++c) {
+                const float* x = planes[c].data() + pos;
+                float s = dot(h, x, taps);
+                if (w != 0)
+                    s += w * dot(deltas.data() + row * taps, x, taps);
+                samples[i * channels + c] = s;
+            }
+            frac += step;
+            pos += frac / phases;
+            frac %= phases;
+        }
+        total_out += frames;
+        return frames * channels;
+    }
+
+
+    vector<float>
+    resampler::get(std::size_t count)
+    {
+        vector<float> result(std::min(count, get_available()));
+        std::size_t rs = get(std::span(result));
+        result.resize(rs);
+        return result;
+    }
+
+
+    std::size_t
+    resampler::get_available()
+        const noexcept
+    {
+        return available_frames() * channels;
+    }
+
+
+    void
+    resampler::flush()
+    {
+        if (flushed)
+            return;
+        // Enough silence for the last input frame to reach the middle of the filter.
+        for (auto& plane : planes)
+            plane.resize(plane.size() + taps / 2, 0.0f);
+        flushed = true;
+    }
+
+
+    void
+    resampler::clear()
+        noexcept
+    {
+        reset_planes();
+        flushed = false;
+        total_in = 0;
+        total_out = 0;
+    }
+
+
+    std::size_t
+    resampler::get_latency()
+        const noexcept
+    {
+        return (taps / 2 * phases + step - 1) / step;
+    }
+
+
+    unsigned
+    resampler::get_channels()
+        const noexcept
+    {
+        return channels;
+    }
+
+
+    int
+    resampler::get_src_rate()
+        const noexcept
+    {
+        return src_rate;
+    }
+
+
+    int
+    resampler::get_dst_rate()
+        const noexcept
+    {
+        return dst_rate;
+    }
+
+} // namespace sdl::audio
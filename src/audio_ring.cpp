@@ -0,0 +1,198 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "audio_ring.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::audio {
+
+    ring::ring(std::size_t capacity_frames,
+               std::size_t frame_size,
+               Uint8 silence) :
+        storage{nullptr, 0},
+        capacity{0},
+        frame_size{frame_size},
+        silence{silence}
+    {
+        if (!capacity_frames || !frame_size)
+            throw error{"audio::ring: capacity must be greater than zero"};
+        if (capacity_frames > SIZE_MAX / frame_size)
+            throw error{"audio::ring: capacity is too large"};
+        capacity = capacity_frames * frame_size;
+        storage = blob{capacity};
+    }
+
+
+    ring::ring(const spec& s,
+               std::size_t capacity_frames) :
+        ring{capacity_frames,
+             SDL_AUDIO_BITSIZE(s.format) / 8u * s.channels,
+             s.silence}
+    {}
+
+
+    std::size_t
+    ring::push(const void* frames,
+               std::size_t count)
+        noexcept
+    {
+        auto w = write_pos.load(std::memory_order_relaxed);
+        auto r = read_pos.load(std::memory_order_acquire);
+        std::size_t space = capacity - (w - r);
+        std::size_t wanted = count * frame_size;
+        std::size_t size = std::min(wanted, space / frame_size * frame_size);
+
+        auto src = static_cast<const Uint8*>(frames);
+        auto dst = storage.data().data();
+        std::size_t start = w % capacity;
+        std::size_t first = std::min(size, capacity - start);
+        std::memcpy(dst + start, src, first);
+        std::memcpy(dst, src + first, size - first);
+
+        write_pos.store(w + size, std::memory_order_release);
+        if (size < wanted)
+            overruns.fetch_add(1, std::memory_order_relaxed);
+        return size / frame_size;
+    }
+
+
+    std::size_t
+    ring::pop(void* frames,
+              std::size_t count)
+        noexcept
+    {
+        auto r = read_pos.load(std::memory_order_relaxed);
+        auto w = write_pos.load(std::memory_order_acquire);
+        std::size_t size = std::min(count * frame_size, w - r);
+
+        auto src = storage.data().data();
+        auto dst = static_cast<Uint8*>(frames);
+        std::size_t start = r % capacity;
+        std::size_t first = std::min(size, capacity - start);
+        std::memcpy(dst, src + start, first);
+        std::memcpy(dst + first, src, size - first);
+
+        read_pos.store(r + size, std::memory_order_release);
+        return size / frame_size;
+    }
+
+
+    void
+    ring::fill(Uint8* stream,
+               std::size_t size)
+        noexcept
+    {
+        std::size_t got = pop(stream, size / frame_size) * frame_size;
+        if (got < size) {
+            std::memset(stream + got, silence, size - got);
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+
+    void
+    ring::attach(spec& s)
+        noexcept
+    {
+        s.callback = callback;
+        s.userdata = this;
+    }
+
+
+    void
+    SDLCALL
+    ring::callback(void* ctx,
+                   Uint8* stream,
+                   int len)
+        noexcept
+    {
+        static_cast<ring*>(ctx)->fill(stream, len);
+    }
+
+
+    std::size_t
+    ring::get_size()
+        const noexcept
+    {
+        auto r = read_pos.load(std::memory_order_acquire);
+        auto w = write_pos.load(std::memory_order_acquire);
+        return (w - r) / frame_size;
+    }
+
+
+    std::size_t
+    ring::get_free()
+        const noexcept
+    {
+        return get_capacity() - get_size();
+    }
+
+
+    std::size_t
+    ring::get_capacity()
+        const noexcept
+    {
+        return capacity / frame_size;
+    }
+
+
+    std::size_t
+    ring::get_frame_size()
+        const noexcept
+    {
+        return frame_size;
+    }
+
+
+    float
+    ring::get_fill_level()
+        const noexcept
+    {
+        return static_cast<float>(get_size()) / get_capacity();
+    }
+
+
+    Uint64
+    ring::get_underruns()
+        const noexcept
+    {
+        return underruns.load(std::memory_order_relaxed);
+    }
+
+
+    Uint64
+    ring::get_overruns()
+        const noexcept
+    {
+        return overruns.load(std::memory_order_relaxed);
+    }
+
+
+    void
+    ring::reset_counters()
+        noexcept
+    {
+        underruns.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+    }
+
+
+    void
+    ring::clear()
+        noexcept
+    {
+        read_pos.store(write_pos.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+} // namespace sdl::audio
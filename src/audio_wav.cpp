@@ -0,0 +1,474 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+#include "audio_wav.hpp"
+
+#include "endian.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::audio {
+
+    namespace {
+
+        constexpr Uint16 tag_pcm = 1;
+        constexpr Uint16 tag_float = 3;
+        constexpr Uint16 tag_extensible = 0xfffe;
+
+
+        template<typename T>
+        T
+        load_le(const Uint8* src)
+            noexcept
+        {
+            T value;
+            std::memcpy(&value, src, sizeof value);
+            return endian::from_le(value);
+        }
+
+
+        void
+        read_exact(SDL_RWops* src,
+                   void* buf,
+                   std::size_t size)
+        {
+            if (SDL_RWread(src, buf, 1, size) != size)
+                throw error{"audio::wav_reader: truncated header"};
+        }
+
+
+        template<typename T>
+        void
+        store(Uint8* out,
+              T value,
+              bool big_endian)
+            noexcept
+        {
+            value = big_endian ? endian::to_be(value) : endian::to_le(value);
+            std::memcpy(out, &value, sizeof value);
+        }
+
+    } // namespace
+
+
+    wav_reader::wav_reader(rwops& src,
+                           std::size_t block_frames) :
+        wav_reader{src.data(), false, block_frames}
+    {}
+
+
+    wav_reader::wav_reader(rwops&& src,
+                           std::size_t block_frames) :
+        wav_reader{src.data(), false, block_frames}
+    {
+        owner = std::move(src);
+    }
+
+
+    wav_reader::wav_reader(SDL_RWops* src,
+                           bool close_src,
+                           std::size_t block_frames) :
+        src{src},
+        block_frames{std::max<std::size_t>(block_frames, 1)}
+    {
+        if (close_src)
+            owner.acquire(src);
+        if (!src)
+            throw error{"audio::wav_reader: null source"};
+        parse_header();
+        set_output(file_spec.format, file_spec.channels, file_spec.freq);
+    }
+
+
+    wav_reader::wav_reader(const path& filename,
+                           std::size_t block_frames) :
+        wav_reader{rwops{filename, "rb"}, block_frames}
+    {}
+
+
+    void
+    wav_reader::parse_header()
+    {
+        Uint8 riff[12];
+        read_exact(src, riff, sizeof riff);
+        if (std::memcmp(riff, "RIFF", 4) || std::memcmp(riff + 8, "WAVE", 4))
+            throw error{"audio::wav_reader: not a WAV file"};
+
+        bool have_fmt = false;
+        Uint16 tag = 0;
+        Uint64 data_size = 0;
+        for (;;) {
+            Uint8 chunk[8];
+            read_exact(src, chunk, sizeof chunk);
+            Uint32 size = load_le<Uint32>(chunk + 4);
+
+            if (!std::memcmp(chunk, "fmt ", 4)) {
+                if (size < 16)
+                    throw error{"audio::wav_reader: invalid fmt chunk"};
+                Uint8 fmt[40] = {};
+                Uint32 used = std::min<Uint32>(size, sizeof fmt);
+                read_exact(src, fmt, used);
+                if (SDL_RWseek(src, size - used + (size & 1), RW_SEEK_CUR) < 0)
+                    throw error{};
+
+                tag = load_le<Uint16>(fmt);
+                file_spec.channels = load_le<Uint16>(fmt + 2);
+                file_spec.freq = load_le<Uint32>(fmt + 4);
+                frame_size = load_le<Uint16>(fmt + 12);
+                bits = load_le<Uint16>(fmt + 14);
+                if (tag == tag_extensible && size >= 40)
+                    tag = load_le<Uint16>(fmt + 24);
+                have_fmt = true;
+                continue;
+            }
+
+            if (!std::memcmp(chunk, "data", 4)) {
+                if (!have_fmt)
+                    throw error{"audio::wav_reader: data chunk before fmt chunk"};
+                data_start = SDL_RWtell(src);
+                if (data_start < 0)
+                    throw error{};
+                data_size = size;
+                // Streamed files may have a bogus size here.
+                Sint64 total = SDL_RWsize(src);
+                if (total >= data_start)
+                    data_size = std::min<Uint64>(data_size, total - data_start);
+                break;
+            }
+
+            if (SDL_RWseek(src, size + (size & 1), RW_SEEK_CUR) < 0)
+                throw error{};
+        }
+
+        is_float = tag == tag_float;
+        if (tag == tag_pcm) {
+            switch (bits) {
+                case 8:
+                    file_spec.format = AUDIO_U8;
+                    break;
+                case 16:
+                    file_spec.format = AUDIO_S16LSB;
+                    break;
+                case 24:
+                    file_spec.format = AUDIO_S32SYS;
+                    break;
+                case 32:
+                    file_spec.format = AUDIO_S32LSB;
+                    break;
+                default:
+                    throw error{"audio::wav_reader: unsupported PCM sample size"};
+            }
+        } else if (tag == tag_float) {
+            switch (bits) {
+                case 32:
+                    file_spec.format = AUDIO_F32LSB;
+                    break;
+                case 64:
+                    file_spec.format = AUDIO_F32SYS;
+                    break;
+                default:
+                    throw error{"audio::wav_reader: unsupported float sample size"};
+            }
+        } else
+            throw error{"audio::wav_reader: unsupported encoding"};
+
+        if (!file_spec.channels || !file_spec.freq)
+            throw error{"audio::wav_reader: invalid fmt chunk"};
+        if (frame_size != file_spec.channels * bits / 8u)
+            throw error{"audio::wav_reader: unsupported block alignment"};
+        file_spec.silence = bits == 8 ? 0x80 : 0;
+
+        num_frames = data_size / frame_size;
+        frame_pos = 0;
+    }
+
+
+    std::size_t
+    wav_reader::decode_block(std::size_t frames)
+        noexcept
+    {
+        std::size_t n = std::min<Uint64>(frames, num_frames - frame_pos);
+        if (!n)
+            return 0;
+        std::size_t got = SDL_RWread(src, raw.data(), frame_size, n);
+        if (got < n)
+            // Treat a truncated file as ending early.
+            num_frames = frame_pos + got;
+        frame_pos += got;
+
+        const unsigned in_ch = file_spec.channels;
+        const unsigned out_ch = out_spec.channels;
+        const std::size_t count = got * in_ch;
+        const Uint8* p = raw.data();
+        float* w = work.data();
+        switch (bits) {
+            case 8:
+                for (std::size_t i = 0; i < count; ++i)
+                    w[i] = (p[i] - 128) * (1.0f / 128);
+                break;
+            case 16:
+                for (std::size_t i = 0; i < count; ++i)
+                    w[i] = load_le<Sint16>(p + 2 * i) * (1.0f / 32768);
+                break;
+            case 24:
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Uint8* s = p + 3 * i;
+                    Sint32 v = Uint32(s[0]) << 8 | Uint32(s[1]) << 16 | Uint32(s[2]) << 24;
+                    w[i] = v * (1.0f / 2147483648.0f);
+                }
+                break;
+            case 32:
+                if (is_float)
+                    for (std::size_t i = 0; i < count; ++i)
+                        w[i] = load_le<float>(p + 4 * i);
+                else
+                    for (std::size_t i = 0; i < count; ++i)
+                        w[i] = load_le<Sint32>(p + 4 * i) * (1.0f / 2147483648.0f);
+                break;
+            case 64:
+                for (std::size_t i = 0; i < count; ++i)
+                    w[i] = std::bit_cast<double>(load_le<Uint64>(p + 8 * i));
+                break;
+        }
+
+        // Channel mapping, in place.
+        if (out_ch == 1 && in_ch > 1) {
+            for (std::size_t f = 0; f < got; ++f) {
+                float sum = 0;
+                for (unsigned c = 0; c < in_ch; ++c)
+                    sum += w[f * in_ch + c];
+                w[f] = sum / in_ch;
+            }
+        } else if (in_ch == 1 && out_ch > 1) {
+            for (std::size_t f = got; f-- > 0;)
+                for (unsigned c = 0; c < out_ch; ++c)
+                    w[f * out_ch + c] = w[f];
+        }
+
+        return got;
+    }
+
+
+    void
+    wav_reader::encode(const float* in,
+                       std::size_t frames,
+                       Uint8* out)
+        const noexcept
+    {
+        const format fmt = out_spec.format;
+        const std::size_t count = frames * out_spec.channels;
+        const bool is_signed = SDL_AUDIO_ISSIGNED(fmt);
+        const bool big_endian = SDL_AUDIO_ISBIGENDIAN(fmt);
+        switch (SDL_AUDIO_BITSIZE(fmt)) {
+            case 8:
+                for (std::size_t i = 0; i < count; ++i) {
+                    int v = std::clamp(in[i], -1.0f, 1.0f) * 127;
+                    out[i] = is_signed ? Uint8(Sint8(v)) : Uint8(v + 128);
+                }
+                break;
+            case 16:
+                for (std::size_t i = 0; i < count; ++i) {
+                    int v = std::clamp(in[i], -1.0f, 1.0f) * 32767;
+                    store(out + 2 * i, Uint16(is_signed ? v : v + 32768), big_endian);
+                }
+                break;
+            case 32:
+                if (SDL_AUDIO_ISFLOAT(fmt))
+                    for (std::size_t i = 0; i < count; ++i)
+                        store(out + 4 * i, in[i], big_endian);
+                else
+                    for (std::size_t i = 0; i < count; ++i) {
+                        double v = std::clamp(in[i], -1.0f, 1.0f) * 2147483647.0;
+                        store(out + 4 * i, Sint32(v), big_endian);
+                    }
+                break;
+        }
+    }
+
+
+    const spec&
+    wav_reader::get_file_spec()
+        const noexcept
+    {
+        return file_spec;
+    }
+
+
+    Uint64
+    wav_reader::get_length()
+        const noexcept
+    {
+        return num_frames;
+    }
+
+
+    void
+    wav_reader::set_output(format fmt,
+                           Uint8 channels,
+                           int rate,
+                           resampler::quality q)
+    {
+        unsigned fbits = SDL_AUDIO_BITSIZE(fmt);
+        if (fbits != 8 && fbits != 16 && fbits != 32)
+            throw error{"audio::wav_reader: unsupported output format"};
+        if (SDL_AUDIO_ISFLOAT(fmt) && fbits != 32)
+            throw error{"audio::wav_reader: unsupported output format"};
+        if (!channels
+            || (channels != file_spec.channels && channels != 1 && file_spec.channels != 1))
+            throw error{"audio::wav_reader: unsupported channel conversion"};
+        if (rate <= 0)
+            throw error{"audio::wav_reader: invalid sample rate"};
+
+        out_spec.format = fmt;
+        out_spec.channels = channels;
+        out_spec.freq = rate;
+        out_spec.silence = fmt == AUDIO_U8 ? 0x80 : 0;
+        out_frame_size = fbits / 8 * channels;
+
+        // 24-bit and 64-bit files never match an SDL format exactly.
+        passthrough = fmt == file_spec.format
+            && channels == file_spec.channels
+            && rate == file_spec.freq
+            && bits != 24
+            && bits != 64;
+
+        if (rate != file_spec.freq)
+            rs.emplace(channels, file_spec.freq, rate, q);
+        else
+            rs.reset();
+
+        if (passthrough) {
+            raw = {};
+            work = {};
+        } else {
+            raw.resize(block_frames * frame_size);
+            work.resize(block_frames * std::max<unsigned>(channels, file_spec.channels));
+        }
+    }
+
+
+    const spec&
+    wav_reader::get_output_spec()
+        const noexcept
+    {
+        return out_spec;
+    }
+
+
+    std::size_t
+    wav_reader::read(void* buf,
+                     std::size_t size)
+    {
+        auto result = try_read(buf, size);
+        if (!result)
+            throw result.error();
+        return *result;
+    }
+
+
+    expected<std::size_t, error>
+    wav_reader::try_read(void* buf,
+                         std::size_t size)
+        noexcept
+    {
+        if (passthrough) {
+            std::size_t n = std::min<Uint64>(size / frame_size, num_frames - frame_pos);
+            if (!n)
+                return 0;
+            std::size_t got = SDL_RWread(src, buf, frame_size, n);
+            if (got < n)
+                num_frames = frame_pos + got;
+            frame_pos += got;
+            return got * frame_size;
+        }
+
+        auto out = static_cast<Uint8*>(buf);
+        const unsigned ch = out_spec.channels;
+        const std::size_t wanted = size / out_frame_size;
+        std::size_t done = 0;
+        while (done < wanted) {
+            if (!rs) {
+                if (frame_pos >= num_frames)
+                    break;
+                std::size_t got = decode_block(std::min(block_frames, wanted - done));
+                encode(work.data(), got, out + done * out_frame_size);
+                done += got;
+                continue;
+            }
+
+            std::size_t n = rs->get(work.data(), std::min(block_frames, wanted - done) * ch) / ch;
+            if (n) {
+                encode(work.data(), n, out + done * out_frame_size);
+                done += n;
+                continue;
+            }
+            if (frame_pos >= num_frames)
+                break;
+
+            std::size_t got = decode_block(block_frames);
+            try {
+                rs->put(work.data(), got * ch);
+                if (frame_pos >= num_frames)
+                    rs->flush();
+            }
+            catch (std::exception& e) {
+                return unexpected{error{e}};
+            }
+        }
+        return done * out_frame_size;
+    }
+
+
+    void
+    wav_reader::seek(Uint64 frame)
+    {
+        auto result = try_seek(frame);
+        if (!result)
+            throw result.error();
+    }
+
+
+    expected<void, error>
+    wav_reader::try_seek(Uint64 frame)
+        noexcept
+    {
+        frame = std::min(frame, num_frames);
+        if (SDL_RWseek(src, data_start + frame * frame_size, RW_SEEK_SET) < 0)
+            return unexpected{error{}};
+        frame_pos = frame;
+        if (rs)
+            rs->clear();
+        return {};
+    }
+
+
+    Uint64
+    wav_reader::tell()
+        const noexcept
+    {
+        return frame_pos;
+    }
+
+
+    bool
+    wav_reader::is_eof()
+        const noexcept
+    {
+        return frame_pos >= num_frames && (!rs || !rs->get_available());
+    }
+
+} // namespace sdl::audio
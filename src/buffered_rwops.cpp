@@ -0,0 +1,431 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <SDL_error.h>
+
+#include "buffered_rwops.hpp"
+
+#include "blob.hpp"
+#include "unique_ptr.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl {
+
+    namespace {
+
+        struct buffered_state {
+
+            SDL_RWops* src;
+            bool close_src;
+
+            blob buffer;
+
+            // Read mode: buffer[read_pos, read_end) holds bytes not consumed yet.
+            std::size_t read_pos = 0;
+            std::size_t read_end = 0;
+
+            // Write mode: buffer[0, write_len) holds bytes not written yet.
+            std::size_t write_len = 0;
+
+            // Position of the source, or -1 if unknown.
+            Sint64 src_pos = -1;
+
+
+            buffered_state(SDL_RWops* src,
+                           bool close_src,
+                           std::size_t buffer_size) :
+                src{src},
+                close_src{close_src},
+                buffer{buffer_size}
+            {}
+
+
+            std::size_t
+            capacity()
+                const noexcept
+            {
+                return buffer.data().size();
+            }
+
+
+            Uint8*
+            buf()
+                noexcept
+            {
+                return buffer.data().data();
+            }
+
+
+            std::size_t
+            available()
+                const noexcept
+            {
+                return read_end - read_pos;
+            }
+
+
+            Sint64
+            logical_pos()
+                const noexcept
+            {
+                if (src_pos < 0)
+                    return -1;
+                return src_pos - static_cast<Sint64>(available()) + static_cast<Sint64>(write_len);
+            }
+
+
+            int
+            flush()
+                noexcept
+            {
+                std::size_t done = 0;
+                while (done < write_len) {
+                    auto w = SDL_RWwrite(src, buf() + done, 1, write_len - done);
+                    if (!w)
+                        break;
+                    done += w;
+                }
+                if (src_pos >= 0)
+                    src_pos += done;
+                if (done < write_len) {
+                    std::memmove(buf(), buf() + done, write_len - done);
+                    write_len -= done;
+                    return SDL_Error(SDL_EFWRITE);
+                }
+                write_len = 0;
+                return 0;
+            }
+
+
+            // Give back the unread part of the read buffer to the source.
+            int
+            drop_read_buffer()
+                noexcept
+            {
+                if (available()) {
+                    auto result = SDL_RWseek(src, -static_cast<Sint64>(available()), RW_SEEK_CUR);
+                    if (result < 0)
+                        return -1;
+                    src_pos = result;
+                }
+                read_pos = read_end = 0;
+                return 0;
+            }
+
+
+            std::size_t
+            read(Uint8* dst,
+                 std::size_t size)
+                noexcept
+            {
+                std::size_t done = 0;
+                while (done < size) {
+                    if (available()) {
+                        std::size_t n = std::min(available(), size - done);
+                        std::memcpy(dst + done, buf() + read_pos, n);
+                        read_pos += n;
+                        done += n;
+                        continue;
+                    }
+                    // Big reads go straight to the destination.
+                    if (size - done >= capacity()) {
+                        auto r = SDL_RWread(src, dst + done, 1, size - done);
+                        if (src_pos >= 0)
+                            src_pos += r;
+                        done += r;
+                        break;
+                    }
+                    auto r = SDL_RWread(src, buf(), 1, capacity());
+                    if (!r)
+                        break;
+                    if (src_pos >= 0)
+                        src_pos += r;
+                    read_pos = 0;
+                    read_end = r;
+                }
+                return done;
+            }
+
+
+            std::size_t
+            write(const Uint8* src_buf,
+                  std::size_t size)
+                noexcept
+            {
+                if (size >= capacity()) {
+                    if (flush() < 0)
+                        return 0;
+                    auto w = SDL_RWwrite(src, src_buf, 1, size);
+                    if (src_pos >= 0)
+                        src_pos += w;
+                    return w;
+                }
+                if (write_len + size > capacity())
+                    if (flush() < 0)
+                        return 0;
+                std::memcpy(buf() + write_len, src_buf, size);
+                write_len += size;
+                return size;
+            }
+
+
+            Sint64
+            seek(Sint64 offset,
+                 int whence)
+                noexcept
+            {
+                if (whence == RW_SEEK_CUR && offset == 0 && src_pos >= 0)
+                    return logical_pos();
+
+                // Try to stay inside the read buffer.
+                if (read_end && src_pos >= 0) {
+                    Sint64 target = -1;
+                    if (whence == RW_SEEK_SET)
+                        target = offset;
+                    else if (whence == RW_SEEK_CUR)
+                        target = logical_pos() + offset;
+                    Sint64 buf_start = src_pos - static_cast<Sint64>(read_end);
+                    if (target >= buf_start && target <= src_pos) {
+                        read_pos = target - buf_start;
+                        return target;
+                    }
+                }
+
+                if (flush() < 0)
+                    return -1;
+                if (whence == RW_SEEK_CUR)
+                    offset -= available();
+                read_pos = read_end = 0;
+
+                auto result = SDL_RWseek(src, offset, whence);
+                src_pos = result;
+                return result;
+            }
+
+        }; // struct buffered_state
+
+
+        buffered_state*
+        get_state(SDL_RWops* ctx)
+            noexcept
+        {
+            return static_cast<buffered_state*>(ctx->hidden.unknown.data1);
+        }
+
+
+        Sint64
+        buffered_size(SDL_RWops* ctx)
+            noexcept
+        {
+            auto state = get_state(ctx);
+            if (state->flush() < 0)
+                return -1;
+            return SDL_RWsize(state->src);
+        }
+
+
+        Sint64
+        buffered_seek(SDL_RWops* ctx,
+                      Sint64 offset,
+                      int whence)
+            noexcept
+        {
+            switch (whence) {
+                case RW_SEEK_SET:
+                case RW_SEEK_CUR:
+                case RW_SEEK_END:
+                    break;
+                default:
+                    return SDL_SetError("buffered_seek(): unknown value for 'whence'");
+            }
+            return get_state(ctx)->seek(offset, whence);
+        }
+
+
+        std::size_t
+        buffered_read(SDL_RWops* ctx,
+                      void* buf,
+                      std::size_t elem_size,
+                      std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto state = get_state(ctx);
+            if (state->write_len)
+                if (state->flush() < 0)
+                    return 0;
+            auto r = state->read(static_cast<Uint8*>(buf), elem_size * count);
+            return r / elem_size;
+        }
+
+
+        std::size_t
+        buffered_write(SDL_RWops* ctx,
+                       const void* buf,
+                       std::size_t elem_size,
+                       std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto state = get_state(ctx);
+            if (state->read_end)
+                if (state->drop_read_buffer() < 0)
+                    return 0;
+            auto w = state->write(static_cast<const Uint8*>(buf), elem_size * count);
+            return w / elem_size;
+        }
+
+
+        int
+        buffered_close(SDL_RWops* ctx)
+            noexcept
+        {
+            unique_ptr<buffered_state> state{get_state(ctx)};
+            SDL_FreeRW(ctx);
+            int status = state->flush();
+            if (state->close_src)
+                if (SDL_RWclose(state->src) < 0)
+                    status = -1;
+            return status;
+        }
+
+    } // namespace
+
+
+    buffered_rwops::buffered_rwops(rwops& src,
+                                   std::size_t buffer_size)
+    {
+        create(src, buffer_size);
+    }
+
+
+    buffered_rwops::buffered_rwops(rwops&& src,
+                                   std::size_t buffer_size)
+    {
+        create(std::move(src), buffer_size);
+    }
+
+
+    buffered_rwops::buffered_rwops(SDL_RWops* src,
+                                   bool close_src,
+                                   std::size_t buffer_size)
+    {
+        create(src, close_src, buffer_size);
+    }
+
+
+    buffered_rwops::buffered_rwops(const path& filename,
+                                   const char* mode,
+                                   std::size_t buffer_size)
+    {
+        create(filename, mode, buffer_size);
+    }
+
+
+    void
+    buffered_rwops::create(rwops& src,
+                           std::size_t buffer_size)
+    {
+        create(src.data(), false, buffer_size);
+    }
+
+
+    void
+    buffered_rwops::create(rwops&& src,
+                           std::size_t buffer_size)
+    {
+        create(src.data(), true, buffer_size);
+        src.release();
+    }
+
+
+    void
+    buffered_rwops::create(SDL_RWops* src,
+                           bool close_src,
+                           std::size_t buffer_size)
+    {
+        if (!src)
+            throw error{"buffered_rwops: invalid source"};
+        if (!buffer_size)
+            throw error{"buffered_rwops: buffer size must be greater than zero"};
+
+        auto state = make_unique<buffered_state>(src, close_src, buffer_size);
+        state->src_pos = SDL_RWtell(src);
+
+        auto new_raw = SDL_AllocRW();
+        if (!new_raw)
+            throw error{};
+
+        new_raw->size = buffered_size;
+        new_raw->seek = buffered_seek;
+        new_raw->read = buffered_read;
+        new_raw->write = buffered_write;
+        new_raw->close = buffered_close;
+        new_raw->type = SDL_RWOPS_UNKNOWN;
+        new_raw->hidden.unknown.data1 = state.release();
+
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    buffered_rwops::create(const path& filename,
+                           const char* mode,
+                           std::size_t buffer_size)
+    {
+        rwops src{filename, mode};
+        create(std::move(src), buffer_size);
+    }
+
+
+    void
+    buffered_rwops::flush()
+    {
+        auto result = try_flush();
+        if (!result)
+            throw result.error();
+    }
+
+
+    expected<void, error>
+    buffered_rwops::try_flush()
+        noexcept
+    {
+        if (get_state(raw)->flush() < 0)
+            return unexpected{error{}};
+        return {};
+    }
+
+
+    std::size_t
+    buffered_rwops::get_buffer_size()
+        const noexcept
+    {
+        return get_state(raw)->capacity();
+    }
+
+
+    SDL_RWops*
+    buffered_rwops::get_source()
+        noexcept
+    {
+        return get_state(raw)->src;
+    }
+
+} // namespace sdl
@@ -0,0 +1,1151 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+#include <SDL_error.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "compressed_rwops.hpp"
+
+#include "blob.hpp"
+#include "unique_ptr.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl {
+
+    bool
+    is_supported(codec c)
+        noexcept
+    {
+        switch (c) {
+            case codec::deflate:
+            case codec::gzip:
+#ifdef HAVE_ZLIB
+                return true;
+#else
+                return false;
+#endif
+            case codec::zstd:
+#ifdef HAVE_ZSTD
+                return true;
+#else
+                return false;
+#endif
+            case codec::lz4:
+#ifdef HAVE_LZ4
+                return true;
+#else
+                return false;
+#endif
+        }
+        return false;
+    }
+
+
+    namespace {
+
+        int
+        unsupported_codec()
+            noexcept
+        {
+            return SDL_SetError("codec not supported in this build of sdl2xx");
+        }
+
+
+        struct decompress_state {
+
+            SDL_RWops* src;
+            bool close_src;
+            codec method;
+
+            // Where the compressed stream starts in the source.
+            Sint64 src_start = 0;
+
+            Sint64 size;
+            Sint64 pos = 0;
+
+            blob window;
+            std::size_t in_pos = 0;
+            std::size_t in_end = 0;
+            bool src_eof = false;
+            bool finished = false;
+
+#ifdef HAVE_ZLIB
+            z_stream zs{};
+            bool zs_ready = false;
+#endif
+#ifdef HAVE_ZSTD
+            ZSTD_DCtx* zstd_ctx = nullptr;
+#endif
+#ifdef HAVE_LZ4
+            LZ4F_dctx* lz4_ctx = nullptr;
+#endif
+
+
+            decompress_state(SDL_RWops* src,
+                             bool close_src,
+                             codec method,
+                             Sint64 size,
+                             std::size_t window_size) :
+                src{src},
+                close_src{close_src},
+                method{method},
+                size{size},
+                window{window_size}
+            {}
+
+
+            ~decompress_state()
+                noexcept
+            {
+#ifdef HAVE_ZLIB
+                if (zs_ready)
+                    inflateEnd(&zs);
+#endif
+#ifdef HAVE_ZSTD
+                ZSTD_freeDCtx(zstd_ctx);
+#endif
+#ifdef HAVE_LZ4
+                if (lz4_ctx)
+                    LZ4F_freeDecompressionContext(lz4_ctx);
+#endif
+            }
+
+
+            Uint8*
+            in_buf()
+                noexcept
+            {
+                return window.data().data();
+            }
+
+
+            int
+            init()
+                noexcept
+            {
+                switch (method) {
+#ifdef HAVE_ZLIB
+                    case codec::deflate:
+                    case codec::gzip:
+                        // Accept both zlib and gzip headers.
+                        if (inflateInit2(&zs, 15 + 32) != Z_OK)
+                            return SDL_SetError("inflateInit2() failed");
+                        zs_ready = true;
+                        return 0;
+#endif
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        zstd_ctx = ZSTD_createDCtx();
+                        if (!zstd_ctx)
+                            return SDL_OutOfMemory();
+                        return 0;
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        if (LZ4F_isError(LZ4F_createDecompressionContext(&lz4_ctx, LZ4F_VERSION)))
+                            return SDL_OutOfMemory();
+                        return 0;
+#endif
+                    default:
+                        return unsupported_codec();
+                }
+            }
+
+
+            void
+            reset_codec()
+                noexcept
+            {
+                switch (method) {
+#ifdef HAVE_ZLIB
+                    case codec::deflate:
+                    case codec::gzip:
+                        inflateReset(&zs);
+                        break;
+#endif
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        ZSTD_DCtx_reset(zstd_ctx, ZSTD_reset_session_only);
+                        break;
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        LZ4F_resetDecompressionContext(lz4_ctx);
+                        break;
+#endif
+                    default:
+                        break;
+                }
+            }
+
+
+            void
+            refill()
+                noexcept
+            {
+                std::size_t r = SDL_RWread(src, in_buf(), 1, window.data().size());
+                if (!r)
+                    src_eof = true;
+                in_pos = 0;
+                in_end = r;
+            }
+
+
+            // Read a little-endian value of `count` bytes at `offset` in the source.
+            bool
+            read_at(Sint64 offset,
+                    std::size_t count,
+                    Uint32& value)
+                noexcept
+            {
+                Uint8 buf[4];
+                if (SDL_RWseek(src, offset, RW_SEEK_SET) < 0
+                    || SDL_RWread(src, buf, 1, count) != count)
+                    return false;
+                value = 0;
+                for (std::size_t i = 0; i < count; ++i)
+                    value |= Uint32{buf[i]} << (8 * i);
+                return true;
+            }
+
+
+#ifdef HAVE_ZSTD
+            // Where the first zstd frame ends, found by skipping over its blocks.
+            Sint64
+            zstd_frame_end(const Uint8* in,
+                           std::size_t in_size,
+                           Sint64 src_size)
+                noexcept
+            {
+                if (in_size < 5 || in[0] != 0x28 || in[1] != 0xb5
+                    || in[2] != 0x2f || in[3] != 0xfd)
+                    return -1;
+                const unsigned desc = in[4];
+                const bool single_segment = desc & 0x20;
+                const bool checksum = desc & 0x04;
+                static const int dict_id_size[] = {0, 1, 2, 4};
+                static const int content_size_size[] = {0, 2, 4, 8};
+                int fcs = content_size_size[desc >> 6];
+                if (!fcs && single_segment)
+                    fcs = 1;
+                Sint64 offset = src_start + 5 + !single_segment
+                    + dict_id_size[desc & 3] + fcs;
+                for (;;) {
+                    Uint32 header;
+                    if (offset + 3 > src_size || !read_at(offset, 3, header))
+                        return -1;
+                    const unsigned type = (header >> 1) & 3;
+                    if (type == 3)
+                        return -1;
+                    // An RLE block stores a single byte.
+                    offset += 3 + (type == 1 ? 1 : header >> 3);
+                    if (header & 1)
+                        break;
+                }
+                return offset + (checksum ? 4 : 0);
+            }
+#endif
+
+
+#ifdef HAVE_LZ4
+            // Where the first LZ4 frame ends, found by skipping over its blocks.
+            Sint64
+            lz4_frame_end(std::size_t header_size,
+                          const LZ4F_frameInfo_t& info,
+                          Sint64 src_size)
+                noexcept
+            {
+                const Sint64 block_checksum = info.blockChecksumFlag ? 4 : 0;
+                Sint64 offset = src_start + header_size;
+                for (;;) {
+                    Uint32 block_size;
+                    if (offset + 4 > src_size || !read_at(offset, 4, block_size))
+                        return -1;
+                    offset += 4;
+                    // A zero size is the end mark.
+                    if (!block_size)
+                        break;
+                    offset += (block_size & 0x7fffffff) + block_checksum;
+                }
+                return offset + (info.contentChecksumFlag ? 4 : 0);
+            }
+#endif
+
+
+            /*
+             * The frame header only holds the size of its own frame, so it's only the
+             * size of the stream when that frame is the last thing in the source. The
+             * blocks are skipped through to check it; gzip can't be checked without
+             * decoding it, so its size is only known after decoding it to the end.
+             */
+            void
+            detect_size()
+                noexcept
+            {
+                if (size >= 0 || in_pos == in_end)
+                    return;
+                [[maybe_unused]] const Uint8* in = in_buf() + in_pos;
+                [[maybe_unused]] std::size_t in_size = in_end - in_pos;
+                const Sint64 src_size = SDL_RWsize(src);
+                const Sint64 here = SDL_RWtell(src);
+                if (src_size < 0 || here < 0)
+                    return;
+                Sint64 content = -1;
+                Sint64 end = -1;
+                switch (method) {
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        {
+                            auto sz = ZSTD_getFrameContentSize(in, in_size);
+                            if (sz == ZSTD_CONTENTSIZE_UNKNOWN || sz == ZSTD_CONTENTSIZE_ERROR)
+                                return;
+                            content = sz;
+                            end = zstd_frame_end(in, in_size, src_size);
+                        }
+                        break;
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        {
+                            // Use a scratch context, so the real one is not advanced.
+                            LZ4F_dctx* tmp = nullptr;
+                            if (LZ4F_isError(LZ4F_createDecompressionContext(&tmp, LZ4F_VERSION)))
+                                return;
+                            LZ4F_frameInfo_t info{};
+                            std::size_t used = in_size;
+                            bool ok = !LZ4F_isError(LZ4F_getFrameInfo(tmp, &info, in, &used))
+                                && info.contentSize;
+                            LZ4F_freeDecompressionContext(tmp);
+                            if (!ok)
+                                return;
+                            content = info.contentSize;
+                            end = lz4_frame_end(used, info, src_size);
+                        }
+                        break;
+#endif
+                    default:
+                        return;
+                }
+                if (SDL_RWseek(src, here, RW_SEEK_SET) < 0) {
+                    // Can't continue reading where the window stopped.
+                    src_eof = true;
+                    return;
+                }
+                if (end == src_size)
+                    size = content;
+            }
+
+
+            // Decode from the window into the output, returns -1 on error.
+            int
+            step([[maybe_unused]] Uint8* out,
+                 [[maybe_unused]] std::size_t out_size,
+                 std::size_t& produced,
+                 bool& frame_end)
+                noexcept
+            {
+                [[maybe_unused]] const Uint8* in = in_buf() + in_pos;
+                [[maybe_unused]] std::size_t in_size = in_end - in_pos;
+                produced = 0;
+                frame_end = false;
+                switch (method) {
+#ifdef HAVE_ZLIB
+                    case codec::deflate:
+                    case codec::gzip:
+                        {
+                            out_size = std::min<std::size_t>(out_size, UINT_MAX);
+                            zs.next_in = const_cast<Bytef*>(in);
+                            zs.avail_in = in_size;
+                            zs.next_out = out;
+                            zs.avail_out = out_size;
+                            int r = inflate(&zs, Z_NO_FLUSH);
+                            in_pos += in_size - zs.avail_in;
+                            produced = out_size - zs.avail_out;
+                            if (r == Z_STREAM_END)
+                                frame_end = true;
+                            else if (r != Z_OK && r != Z_BUF_ERROR)
+                                return SDL_SetError("inflate(): %s", zs.msg ? zs.msg : "failed");
+                            return 0;
+                        }
+#endif
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        {
+                            ZSTD_inBuffer ib{in, in_size, 0};
+                            ZSTD_outBuffer ob{out, out_size, 0};
+                            auto r = ZSTD_decompressStream(zstd_ctx, &ob, &ib);
+                            if (ZSTD_isError(r))
+                                return SDL_SetError("ZSTD_decompressStream(): %s",
+                                                    ZSTD_getErrorName(r));
+                            in_pos += ib.pos;
+                            produced = ob.pos;
+                            frame_end = r == 0;
+                            return 0;
+                        }
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        {
+                            std::size_t used = in_size;
+                            std::size_t made = out_size;
+                            auto r = LZ4F_decompress(lz4_ctx, out, &made, in, &used, nullptr);
+                            if (LZ4F_isError(r))
+                                return SDL_SetError("LZ4F_decompress(): %s",
+                                                    LZ4F_getErrorName(r));
+                            in_pos += used;
+                            produced = made;
+                            frame_end = r == 0;
+                            return 0;
+                        }
+#endif
+                    default:
+                        return unsupported_codec();
+                }
+            }
+
+
+            std::size_t
+            read(Uint8* dst,
+                 std::size_t dst_size)
+                noexcept
+            {
+                std::size_t done = 0;
+                while (done < dst_size && !finished) {
+                    if (in_pos == in_end && !src_eof)
+                        refill();
+
+                    std::size_t produced;
+                    bool frame_end;
+                    if (step(dst + done, dst_size - done, produced, frame_end) < 0)
+                        break;
+                    done += produced;
+                    pos += produced;
+
+                    if (frame_end) {
+                        // Another frame may follow.
+                        if (in_pos == in_end && !src_eof)
+                            refill();
+                        if (in_pos == in_end) {
+                            finished = true;
+                            if (size < 0)
+                                size = pos;
+                            break;
+                        }
+                        reset_codec();
+                        continue;
+                    }
+
+                    if (!produced && in_pos == in_end && src_eof) {
+                        SDL_SetError("decompress_rwops: compressed stream is truncated");
+                        break;
+                    }
+                }
+                return done;
+            }
+
+
+            int
+            rewind()
+                noexcept
+            {
+                if (SDL_RWseek(src, src_start, RW_SEEK_SET) < 0)
+                    return -1;
+                reset_codec();
+                in_pos = in_end = 0;
+                src_eof = false;
+                finished = false;
+                pos = 0;
+                return 0;
+            }
+
+
+            Sint64
+            seek(Sint64 offset,
+                 int whence)
+                noexcept
+            {
+                Sint64 target;
+                switch (whence) {
+                    case RW_SEEK_SET:
+                        target = offset;
+                        break;
+                    case RW_SEEK_CUR:
+                        target = pos + offset;
+                        break;
+                    case RW_SEEK_END:
+                        if (size < 0) {
+                            // Decode to the end, to learn the size.
+                            Uint8 scratch[4096];
+                            while (!finished)
+                                if (!read(scratch, sizeof scratch))
+                                    break;
+                            if (size < 0)
+                                return SDL_SetError("decompress_rwops: size is unknown");
+                        }
+                        target = size + offset;
+                        break;
+                    default:
+                        return SDL_SetError("decompress_seek(): unknown value for 'whence'");
+                }
+                if (target < 0)
+                    return SDL_Error(SDL_EFSEEK);
+
+                if (target < pos)
+                    if (rewind() < 0)
+                        return -1;
+
+                // Decode and discard, until the target is reached.
+                Uint8 scratch[4096];
+                while (pos < target && !finished) {
+                    std::size_t n = std::min<Sint64>(target - pos, sizeof scratch);
+                    if (!read(scratch, n))
+                        break;
+                }
+                return pos;
+            }
+
+        }; // struct decompress_state
+
+
+        decompress_state*
+        get_decompress_state(SDL_RWops* ctx)
+            noexcept
+        {
+            return static_cast<decompress_state*>(ctx->hidden.unknown.data1);
+        }
+
+
+        Sint64
+        decompress_size(SDL_RWops* ctx)
+            noexcept
+        {
+            return get_decompress_state(ctx)->size;
+        }
+
+
+        Sint64
+        decompress_seek(SDL_RWops* ctx,
+                        Sint64 offset,
+                        int whence)
+            noexcept
+        {
+            return get_decompress_state(ctx)->seek(offset, whence);
+        }
+
+
+        std::size_t
+        decompress_read(SDL_RWops* ctx,
+                        void* buf,
+                        std::size_t elem_size,
+                        std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto r = get_decompress_state(ctx)->read(static_cast<Uint8*>(buf), elem_size * count);
+            return r / elem_size;
+        }
+
+
+        std::size_t
+        decompress_write(SDL_RWops*,
+                         const void*,
+                         std::size_t,
+                         std::size_t)
+            noexcept
+        {
+            SDL_SetError("decompress_rwops is read-only");
+            return 0;
+        }
+
+
+        int
+        decompress_close(SDL_RWops* ctx)
+            noexcept
+        {
+            unique_ptr<decompress_state> state{get_decompress_state(ctx)};
+            SDL_FreeRW(ctx);
+            if (state->close_src)
+                return SDL_RWclose(state->src);
+            return 0;
+        }
+
+
+        struct compress_state {
+
+            SDL_RWops* dst;
+            bool close_dst;
+            codec method;
+
+            Sint64 pos = 0;
+
+            blob out;
+            std::size_t chunk_size;
+
+            bool finished = false;
+
+#ifdef HAVE_ZLIB
+            z_stream zs{};
+            bool zs_ready = false;
+#endif
+#ifdef HAVE_ZSTD
+            ZSTD_CCtx* zstd_ctx = nullptr;
+#endif
+#ifdef HAVE_LZ4
+            LZ4F_cctx* lz4_ctx = nullptr;
+#endif
+
+
+            compress_state(SDL_RWops* dst,
+                           bool close_dst,
+                           codec method,
+                           std::size_t out_size,
+                           std::size_t chunk_size) :
+                dst{dst},
+                close_dst{close_dst},
+                method{method},
+                out{out_size},
+                chunk_size{chunk_size}
+            {}
+
+
+            ~compress_state()
+                noexcept
+            {
+#ifdef HAVE_ZLIB
+                if (zs_ready)
+                    deflateEnd(&zs);
+#endif
+#ifdef HAVE_ZSTD
+                ZSTD_freeCCtx(zstd_ctx);
+#endif
+#ifdef HAVE_LZ4
+                if (lz4_ctx)
+                    LZ4F_freeCompressionContext(lz4_ctx);
+#endif
+            }
+
+
+            Uint8*
+            out_buf()
+                noexcept
+            {
+                return out.data().data();
+            }
+
+
+            std::size_t
+            out_capacity()
+                const noexcept
+            {
+                return out.data().size();
+            }
+
+
+            int
+            emit(std::size_t size)
+                noexcept
+            {
+                std::size_t done = 0;
+                while (done < size) {
+                    auto w = SDL_RWwrite(dst, out_buf() + done, 1, size - done);
+                    if (!w)
+                        return SDL_Error(SDL_EFWRITE);
+                    done += w;
+                }
+                return 0;
+            }
+
+
+#ifdef HAVE_LZ4
+            static
+            LZ4F_preferences_t
+            lz4_prefs(int level)
+                noexcept
+            {
+                LZ4F_preferences_t prefs{};
+                prefs.compressionLevel = level < 0 ? 0 : level;
+                return prefs;
+            }
+#endif
+
+
+            int
+            init([[maybe_unused]] int level)
+                noexcept
+            {
+                switch (method) {
+#ifdef HAVE_ZLIB
+                    case codec::deflate:
+                    case codec::gzip:
+                        {
+                            int bits = method == codec::gzip ? 15 + 16 : 15;
+                            if (deflateInit2(&zs, level, Z_DEFLATED, bits, 8,
+                                             Z_DEFAULT_STRATEGY) != Z_OK)
+                                return SDL_SetError("deflateInit2() failed");
+                            zs_ready = true;
+                            return 0;
+                        }
+#endif
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        zstd_ctx = ZSTD_createCCtx();
+                        if (!zstd_ctx)
+                            return SDL_OutOfMemory();
+                        if (ZSTD_isError(ZSTD_CCtx_setParameter(zstd_ctx,
+                                                                ZSTD_c_compressionLevel,
+                                                                level < 0 ? 0 : level)))
+                            return SDL_SetError("ZSTD_CCtx_setParameter() failed");
+                        return 0;
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        {
+                            if (LZ4F_isError(LZ4F_createCompressionContext(&lz4_ctx,
+                                                                           LZ4F_VERSION)))
+                                return SDL_OutOfMemory();
+                            auto prefs = lz4_prefs(level);
+                            auto n = LZ4F_compressBegin(lz4_ctx, out_buf(), out_capacity(), &prefs);
+                            if (LZ4F_isError(n))
+                                return SDL_SetError("LZ4F_compressBegin(): %s",
+                                                    LZ4F_getErrorName(n));
+                            return emit(n);
+                        }
+#endif
+                    default:
+                        return unsupported_codec();
+                }
+            }
+
+
+            int
+            write([[maybe_unused]] const Uint8* data,
+                  [[maybe_unused]] std::size_t size)
+                noexcept
+            {
+                if (finished)
+                    return SDL_SetError("compress_rwops: stream is already finished");
+                switch (method) {
+#ifdef HAVE_ZLIB
+                    case codec::deflate:
+                    case codec::gzip:
+                        while (size > 0) {
+                            std::size_t piece = std::min<std::size_t>(size, UINT_MAX);
+                            zs.next_in = const_cast<Bytef*>(data);
+                            zs.avail_in = piece;
+                            do {
+                                zs.next_out = out_buf();
+                                zs.avail_out = out_capacity();
+                                if (deflate(&zs, Z_NO_FLUSH) == Z_STREAM_ERROR)
+                                    return SDL_SetError("deflate() failed");
+                                if (emit(out_capacity() - zs.avail_out) < 0)
+                                    return -1;
+                            } while (zs.avail_out == 0);
+                            data += piece;
+                            size -= piece;
+                        }
+                        return 0;
+#endif
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        {
+                            ZSTD_inBuffer ib{data, size, 0};
+                            while (ib.pos < ib.size) {
+                                ZSTD_outBuffer ob{out_buf(), out_capacity(), 0};
+                                auto r = ZSTD_compressStream2(zstd_ctx, &ob, &ib, ZSTD_e_continue);
+                                if (ZSTD_isError(r))
+                                    return SDL_SetError("ZSTD_compressStream2(): %s",
+                                                        ZSTD_getErrorName(r));
+                                if (emit(ob.pos) < 0)
+                                    return -1;
+                            }
+                            return 0;
+                        }
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        while (size > 0) {
+                            // The output buffer is only big enough for one chunk.
+                            std::size_t piece = std::min(size, chunk_size);
+                            auto n = LZ4F_compressUpdate(lz4_ctx,
+                                                         out_buf(), out_capacity(),
+                                                         data, piece,
+                                                         nullptr);
+                            if (LZ4F_isError(n))
+                                return SDL_SetError("LZ4F_compressUpdate(): %s",
+                                                    LZ4F_getErrorName(n));
+                            if (emit(n) < 0)
+                                return -1;
+                            data += piece;
+                            size -= piece;
+                        }
+                        return 0;
+#endif
+                    default:
+                        return unsupported_codec();
+                }
+            }
+
+
+            int
+            finish()
+                noexcept
+            {
+                if (finished)
+                    return 0;
+                finished = true;
+                switch (method) {
+#ifdef HAVE_ZLIB
+                    case codec::deflate:
+                    case codec::gzip:
+                        {
+                            zs.next_in = nullptr;
+                            zs.avail_in = 0;
+                            int r;
+                            do {
+                                zs.next_out = out_buf();
+                                zs.avail_out = out_capacity();
+                                r = deflate(&zs, Z_FINISH);
+                                if (r == Z_STREAM_ERROR)
+                                    return SDL_SetError("deflate() failed");
+                                if (emit(out_capacity() - zs.avail_out) < 0)
+                                    return -1;
+                            } while (r != Z_STREAM_END);
+                            return 0;
+                        }
+#endif
+#ifdef HAVE_ZSTD
+                    case codec::zstd:
+                        {
+                            ZSTD_inBuffer ib{nullptr, 0, 0};
+                            std::size_t r;
+                            do {
+                                ZSTD_outBuffer ob{out_buf(), out_capacity(), 0};
+                                r = ZSTD_compressStream2(zstd_ctx, &ob, &ib, ZSTD_e_end);
+                                if (ZSTD_isError(r))
+                                    return SDL_SetError("ZSTD_compressStream2(): %s",
+                                                        ZSTD_getErrorName(r));
+                                if (emit(ob.pos) < 0)
+                                    return -1;
+                            } while (r != 0);
+                            return 0;
+                        }
+#endif
+#ifdef HAVE_LZ4
+                    case codec::lz4:
+                        {
+                            auto n = LZ4F_compressEnd(lz4_ctx, out_buf(), out_capacity(), nullptr);
+                            if (LZ4F_isError(n))
+                                return SDL_SetError("LZ4F_compressEnd(): %s",
+                                                    LZ4F_getErrorName(n));
+                            return emit(n);
+                        }
+#endif
+                    default:
+                        return unsupported_codec();
+                }
+            }
+
+        }; // struct compress_state
+
+
+        compress_state*
+        get_compress_state(SDL_RWops* ctx)
+            noexcept
+        {
+            return static_cast<compress_state*>(ctx->hidden.unknown.data1);
+        }
+
+
+        Sint64
+        compress_size(SDL_RWops* ctx)
+            noexcept
+        {
+            return get_compress_state(ctx)->pos;
+        }
+
+
+        Sint64
+        compress_seek(SDL_RWops* ctx,
+                      Sint64 offset,
+                      int whence)
+            noexcept
+        {
+            // Only tell() is supported.
+            if (whence == RW_SEEK_CUR && offset == 0)
+                return get_compress_state(ctx)->pos;
+            return SDL_SetError("compress_rwops can't seek");
+        }
+
+
+        std::size_t
+        compress_read(SDL_RWops*,
+                      void*,
+                      std::size_t,
+                      std::size_t)
+            noexcept
+        {
+            SDL_SetError("compress_rwops is write-only");
+            return 0;
+        }
+
+
+        std::size_t
+        compress_write(SDL_RWops* ctx,
+                       const void* buf,
+                       std::size_t elem_size,
+                       std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto state = get_compress_state(ctx);
+            if (state->write(static_cast<const Uint8*>(buf), elem_size * count) < 0)
+                return 0;
+            state->pos += elem_size * count;
+            return count;
+        }
+
+
+        int
+        compress_close(SDL_RWops* ctx)
+            noexcept
+        {
+            unique_ptr<compress_state> state{get_compress_state(ctx)};
+            SDL_FreeRW(ctx);
+            int status = state->finish();
+            if (state->close_dst)
+                if (SDL_RWclose(state->dst) < 0)
+                    status = -1;
+            return status;
+        }
+
+    } // namespace
+
+
+    decompress_rwops::decompress_rwops(rwops& src,
+                                       codec c,
+                                       Sint64 size,
+                                       std::size_t window_size)
+    {
+        create(src, c, size, window_size);
+    }
+
+
+    decompress_rwops::decompress_rwops(rwops&& src,
+                                       codec c,
+                                       Sint64 size,
+                                       std::size_t window_size)
+    {
+        create(std::move(src), c, size, window_size);
+    }
+
+
+    decompress_rwops::decompress_rwops(SDL_RWops* src,
+                                       bool close_src,
+                                       codec c,
+                                       Sint64 size,
+                                       std::size_t window_size)
+    {
+        create(src, close_src, c, size, window_size);
+    }
+
+
+    void
+    decompress_rwops::create(rwops& src,
+                             codec c,
+                             Sint64 size,
+                             std::size_t window_size)
+    {
+        create(src.data(), false, c, size, window_size);
+    }
+
+
+    void
+    decompress_rwops::create(rwops&& src,
+                             codec c,
+                             Sint64 size,
+                             std::size_t window_size)
+    {
+        create(src.data(), true, c, size, window_size);
+        src.release();
+    }
+
+
+    void
+    decompress_rwops::create(SDL_RWops* src,
+                             bool close_src,
+                             codec c,
+                             Sint64 size,
+                             std::size_t window_size)
+    {
+        if (!src)
+            throw error{"decompress_rwops: invalid source"};
+        if (!window_size)
+            throw error{"decompress_rwops: window size must be greater than zero"};
+
+        auto state = make_unique<decompress_state>(src, close_src, c, size, window_size);
+        if (state->init() < 0)
+            throw error{};
+        state->src_start = std::max<Sint64>(SDL_RWtell(src), 0);
+        state->refill();
+        state->detect_size();
+
+        auto new_raw = SDL_AllocRW();
+        if (!new_raw)
+            throw error{};
+
+        new_raw->size = decompress_size;
+        new_raw->seek = decompress_seek;
+        new_raw->read = decompress_read;
+        new_raw->write = decompress_write;
+        new_raw->close = decompress_close;
+        new_raw->type = SDL_RWOPS_UNKNOWN;
+        new_raw->hidden.unknown.data1 = state.release();
+
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    compress_rwops::compress_rwops(rwops& dst,
+                                   codec c,
+                                   int level,
+                                   std::size_t window_size)
+    {
+        create(dst, c, level, window_size);
+    }
+
+
+    compress_rwops::compress_rwops(rwops&& dst,
+                                   codec c,
+                                   int level,
+                                   std::size_t window_size)
+    {
+        create(std::move(dst), c, level, window_size);
+    }
+
+
+    compress_rwops::compress_rwops(SDL_RWops* dst,
+                                   bool close_dst,
+                                   codec c,
+                                   int level,
+                                   std::size_t window_size)
+    {
+        create(dst, close_dst, c, level, window_size);
+    }
+
+
+    void
+    compress_rwops::create(rwops& dst,
+                           codec c,
+                           int level,
+                           std::size_t window_size)
+    {
+        create(dst.data(), false, c, level, window_size);
+    }
+
+
+    void
+    compress_rwops::create(rwops&& dst,
+                           codec c,
+                           int level,
+                           std::size_t window_size)
+    {
+        create(dst.data(), true, c, level, window_size);
+        dst.release();
+    }
+
+
+    void
+    compress_rwops::create(SDL_RWops* dst,
+                           bool close_dst,
+                           codec c,
+                           int level,
+                           std::size_t window_size)
+    {
+        if (!dst)
+            throw error{"compress_rwops: invalid destination"};
+        if (!window_size)
+            throw error{"compress_rwops: window size must be greater than zero"};
+        if (!is_supported(c)) {
+            unsupported_codec();
+            throw error{};
+        }
+
+        std::size_t out_size = window_size;
+#ifdef HAVE_LZ4
+        if (c == codec::lz4) {
+            auto prefs = compress_state::lz4_prefs(level);
+            out_size = LZ4F_compressBound(window_size, &prefs);
+        }
+#endif
+
+        auto state = make_unique<compress_state>(dst, close_dst, c, out_size, window_size);
+        if (state->init(level) < 0)
+            throw error{};
+
+        auto new_raw = SDL_AllocRW();
+        if (!new_raw)
+            throw error{};
+
+        new_raw->size = compress_size;
+        new_raw->seek = compress_seek;
+        new_raw->read = compress_read;
+        new_raw->write = compress_write;
+        new_raw->close = compress_close;
+        new_raw->type = SDL_RWOPS_UNKNOWN;
+        new_raw->hidden.unknown.data1 = state.release();
+
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    compress_rwops::finish()
+    {
+        auto result = try_finish();
+        if (!result)
+            throw result.error();
+    }
+
+
+    expected<void, error>
+    compress_rwops::try_finish()
+        noexcept
+    {
+        if (get_compress_state(raw)->finish() < 0)
+            return unexpected{error{}};
+        return {};
+    }
+
+} // namespace sdl
@@ -6,11 +6,16 @@
  * SPDX-License-Identifier: Zlib
  */
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <stdexcept>
+#include <string_view>
 #include <utility>
 
 #include "img.hpp"
 
+#include "memory_stats.hpp"
 #include "renderer.hpp"
 
 
@@ -92,6 +97,7 @@ namespace sdl::img {
              const char* type)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadTyped_RW(src, close_src, type);
         if (!surf)
             return unexpected{error{}};
@@ -122,10 +128,28 @@ namespace sdl::img {
     try_load(const path& filename)
         noexcept
     {
-        auto surf = IMG_Load(filename.c_str());
-        if (!surf)
-            return unexpected{error{}};
-        return surface{surf};
+        try {
+            rwops src{filename, "rb"};
+            format fmt = detect(src);
+            if (fmt != format::unknown)
+                return try_load(src, fmt);
+            // Formats without a signature, like TGA, are found by the extension, like
+            // IMG_Load() does.
+            auto ext = filename.extension().string();
+            memory::tag_scope tag{memory::tag::img};
+            auto surf = IMG_LoadTyped_RW(src.data(),
+                                         false,
+                                         ext.empty() ? nullptr : ext.c_str() + 1);
+            if (!surf)
+                return unexpected{error{}};
+            return surface{surf};
+        }
+        catch (error& e) {
+            return unexpected{e};
+        }
+        catch (std::exception& e) {
+            return unexpected{error{e}};
+        }
     }
 
 
@@ -152,11 +176,7 @@ namespace sdl::img {
              bool close_src)
         noexcept
     {
-        auto surf = IMG_Load_RW(src, close_src);
-        if (!surf)
-            return unexpected{error{}};
-        return surface{surf};
-
+        return try_load(src, close_src, detect(src));
     }
 
 
@@ -184,6 +204,7 @@ namespace sdl::img {
                      const path& filename)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto tex = IMG_LoadTexture(ren.data(), filename.c_str());
         if (!tex)
             return unexpected{error{}};
@@ -217,7 +238,7 @@ namespace sdl::img {
                      bool close_src)
         noexcept
     {
-
+        memory::tag_scope tag{memory::tag::img};
         auto tex = IMG_LoadTexture_RW(ren.data(), src, close_src);
         if (!tex)
             return unexpected{error{}};
@@ -263,6 +284,7 @@ namespace sdl::img {
                      const char* type)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto tex = IMG_LoadTextureTyped_RW(ren.data(), src, close_src, type);
         if (!tex)
             return unexpected{error{}};
@@ -584,6 +606,247 @@ namespace sdl::img {
     }
 
 
+    namespace {
+
+        using namespace std::literals;
+
+
+        bool
+        matches(std::span<const Uint8> header,
+                std::size_t offset,
+                std::string_view magic)
+            noexcept
+        {
+            if (magic.empty())
+                return true;
+            if (header.size() < offset + magic.size())
+                return false;
+            return !std::memcmp(header.data() + offset, magic.data(), magic.size());
+        }
+
+
+        // An ISO BMFF "ftyp" box, with AVIF as the major or a compatible brand.
+        bool
+        has_avif_brand(std::span<const Uint8> header)
+            noexcept
+        {
+            std::size_t size = header.size() < 4 ? 0
+                : std::size_t(header[0]) << 24 | header[1] << 16 | header[2] << 8 | header[3];
+            size = std::min(size, header.size());
+            for (std::size_t i = 8; i + 4 <= size; i += 4) {
+                if (i == 12) // minor version
+                    continue;
+                if (matches(header, i, "avif"sv) || matches(header, i, "avis"sv))
+                    return true;
+            }
+            return false;
+        }
+
+
+        bool
+        has_icon_count(std::span<const Uint8> header)
+            noexcept
+        {
+            return header.size() >= 6 && (header[4] || header[5]);
+        }
+
+
+        bool
+        is_pnm_header(std::span<const Uint8> header)
+            noexcept
+        {
+            constexpr std::string_view spaces = " \t\r\n\v\f";
+            return header.size() >= 3
+                && header[1] >= '1' && header[1] <= '6'
+                && spaces.find(header[2]) != std::string_view::npos;
+        }
+
+
+        bool
+        has_svg_tag(std::span<const Uint8> header)
+            noexcept
+        {
+            std::string_view text{reinterpret_cast<const char*>(header.data()), header.size()};
+            return text.find("<svg"sv) != std::string_view::npos;
+        }
+
+
+        struct signature {
+            format fmt;
+            std::string_view magic;
+            // A second magic, further into the header.
+            std::size_t offset = 0;
+            std::string_view magic2 = {};
+            // For the parts that aren't just fixed bytes.
+            bool (*check)(std::span<const Uint8>) noexcept = nullptr;
+        };
+
+
+        // Longer signatures go first, so they're not mistaken for a shorter one.
+        constexpr signature signatures[] = {
+            {format::png,  "\x89PNG\r\n\x1a\n"sv},
+            {format::jxl,  "\0\0\0\x0cJXL \r\n\x87\n"sv},
+            {format::avif, ""sv, 4, "ftyp"sv, has_avif_brand},
+            {format::webp, "RIFF"sv, 8, "WEBP"sv},
+            {format::lbm,  "FORM"sv, 8, "ILBM"sv},
+            {format::lbm,  "FORM"sv, 8, "PBM "sv},
+            {format::xcf,  "gimp xcf "sv},
+            {format::xpm,  "/* XPM */"sv},
+            {format::gif,  "GIF87a"sv},
+            {format::gif,  "GIF89a"sv},
+            {format::xv,   "P7 332"sv},
+            {format::qoi,  "qoif"sv},
+            {format::tif,  "II*\0"sv},
+            {format::tif,  "MM\0*"sv},
+            {format::ico,  "\0\0\1\0"sv, 0, {}, has_icon_count},
+            {format::cur,  "\0\0\2\0"sv, 0, {}, has_icon_count},
+            {format::pcx,  "\x0a\x05\x00"sv},
+            {format::pcx,  "\x0a\x05\x01"sv},
+            {format::jxl,  "\xff\x0a"sv},
+            {format::jpg,  "\xff\xd8"sv},
+            {format::bmp,  "BM"sv},
+            {format::pnm,  "P"sv, 0, {}, is_pnm_header},
+            {format::svg,  ""sv, 0, {}, has_svg_tag},
+        };
+
+    } // namespace
+
+
+    format
+    detect(std::span<const Uint8> header)
+        noexcept
+    {
+        for (auto& sig : signatures)
+            if (matches(header, 0, sig.magic)
+                && matches(header, sig.offset, sig.magic2)
+                && (!sig.check || sig.check(header)))
+                return sig.fmt;
+        return format::unknown;
+    }
+
+
+    format
+    detect(SDL_RWops* src)
+        noexcept
+    {
+        if (!src)
+            return format::unknown;
+        Sint64 start = SDL_RWtell(src);
+        if (start < 0)
+            return format::unknown;
+        std::array<Uint8, detect_size> header;
+        std::size_t size = SDL_RWread(src, header.data(), 1, header.size());
+        SDL_RWseek(src, start, RW_SEEK_SET);
+        return detect(std::span{header.data(), size});
+    }
+
+
+    format
+    detect(rwops& src)
+        noexcept
+    {
+        return detect(src.data());
+    }
+
+
+    surface
+    load(SDL_RWops* src,
+         bool close_src,
+         format fmt)
+    {
+        auto result = try_load(src, close_src, fmt);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    surface
+    load(rwops& src,
+         format fmt)
+    {
+        return load(src.data(), false, fmt);
+    }
+
+
+    expected<surface, error>
+    try_load(SDL_RWops* src,
+             bool close_src,
+             format fmt)
+        noexcept
+    {
+        auto result = [src, fmt]() -> expected<surface, error>
+        {
+            switch (fmt) {
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+                case format::avif:
+                    return try_load_avif(src);
+#endif
+                case format::bmp:
+                    return try_load_bmp(src);
+                case format::cur:
+                    return try_load_cur(src);
+                case format::gif:
+                    return try_load_gif(src);
+                case format::ico:
+                    return try_load_ico(src);
+                case format::jpg:
+                    return try_load_jpg(src);
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+                case format::jxl:
+                    return try_load_jxl(src);
+#endif
+                case format::lbm:
+                    return try_load_lbm(src);
+                case format::pcx:
+                    return try_load_pcx(src);
+                case format::png:
+                    return try_load_png(src);
+                case format::pnm:
+                    return try_load_pnm(src);
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+                case format::qoi:
+                    return try_load_qoi(src);
+#endif
+#if SDL_IMAGE_VERSION_ATLEAST(2, 0, 2)
+                case format::svg:
+                    return try_load_svg(src);
+#endif
+                case format::tif:
+                    return try_load_tif(src);
+                case format::webp:
+                    return try_load_webp(src);
+                case format::xcf:
+                    return try_load_xcf(src);
+                case format::xpm:
+                    return try_load_xpm(src);
+                case format::xv:
+                    return try_load_xv(src);
+                default: {
+                    // Let SDL_image probe every format.
+                    memory::tag_scope tag{memory::tag::img};
+                    auto surf = IMG_Load_RW(src, false);
+                    if (!surf)
+                        return unexpected{error{}};
+                    return surface{surf};
+                }
+            }
+        }();
+        if (close_src && src)
+            SDL_RWclose(src);
+        return result;
+    }
+
+
+    expected<surface, error>
+    try_load(rwops& src,
+             format fmt)
+        noexcept
+    {
+        return try_load(src.data(), false, fmt);
+    }
+
+
 #if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
 
     surface
@@ -617,6 +880,7 @@ namespace sdl::img {
     try_load_avif(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadAVIF_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -679,6 +943,7 @@ namespace sdl::img {
     try_load_bmp(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadBMP_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -739,6 +1004,7 @@ namespace sdl::img {
     try_load_cur(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadCUR_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -799,6 +1065,7 @@ namespace sdl::img {
     try_load_gif(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadGIF_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -859,6 +1126,7 @@ namespace sdl::img {
     try_load_ico(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadICO_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -919,6 +1187,7 @@ namespace sdl::img {
     try_load_jpg(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadJPG_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -981,6 +1250,7 @@ namespace sdl::img {
     try_load_jxl(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadJXL_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1043,6 +1313,7 @@ namespace sdl::img {
     try_load_lbm(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadLBM_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1103,6 +1374,7 @@ namespace sdl::img {
     try_load_pcx(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadPCX_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1163,6 +1435,7 @@ namespace sdl::img {
     try_load_png(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadPNG_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1223,6 +1496,7 @@ namespace sdl::img {
     try_load_pnm(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadPNM_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1285,6 +1559,7 @@ namespace sdl::img {
     try_load_svg(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadSVG_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1381,6 +1656,7 @@ namespace sdl::img {
                  int height)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadSizedSVG_RW(src, width, height);
         if (!surf)
             return unexpected{error{}};
@@ -1476,6 +1752,7 @@ namespace sdl::img {
     try_load_qoi(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadQOI_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1538,6 +1815,7 @@ namespace sdl::img {
     try_load_tif(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadTIF_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1598,6 +1876,7 @@ namespace sdl::img {
     try_load_webp(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadWEBP_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1658,6 +1937,7 @@ namespace sdl::img {
     try_load_xcf(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadXCF_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1728,6 +2008,7 @@ namespace sdl::img {
     try_load_xpm(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadXPM_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -1761,6 +2042,7 @@ namespace sdl::img {
     try_load_xpm(char* xpm[])
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_ReadXPMFromArray(xpm);
         if (!surf)
             return unexpected{error{}};
@@ -1784,6 +2066,7 @@ namespace sdl::img {
     try_load_xpm_to_rgb888(char* xpm[])
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_ReadXPMFromArrayToRGB888(xpm);
         if (!surf)
             return unexpected{error{}};
@@ -1824,6 +2107,7 @@ namespace sdl::img {
     try_load_xv(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto surf = IMG_LoadXV_RW(src);
         if (!surf)
             return unexpected{error{}};
@@ -2027,6 +2311,7 @@ namespace sdl::img {
     animation
     load_animation(const path& filename)
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadAnimation(filename.c_str());
         if (!anim)
             throw unexpected{error{}};
@@ -2038,6 +2323,7 @@ namespace sdl::img {
     load_animation(SDL_RWops* src,
                    bool close_src)
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadAnimation_RW(src, close_src);
         if (!anim)
             throw error{};
@@ -2057,6 +2343,7 @@ namespace sdl::img {
                    bool close_src,
                    const char* type)
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadAnimationTyped_RW(src, close_src, type);
         if (!anim)
             throw error{};
@@ -2076,6 +2363,7 @@ namespace sdl::img {
     try_load_animation(const path& filename)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadAnimation(filename.c_str());
         if (!anim)
             return unexpected{error{}};
@@ -2093,6 +2381,7 @@ namespace sdl::img {
                        bool close_src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadAnimation_RW(src, close_src);
         if (!anim)
             return unexpected{error{}};
@@ -2119,6 +2408,7 @@ namespace sdl::img {
                        const char* type)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadAnimationTyped_RW(src, close_src, type);
         if (!anim)
             return unexpected{error{}};
@@ -2143,6 +2433,7 @@ namespace sdl::img {
     animation
     load_gif_animation(SDL_RWops* src)
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadGIFAnimation_RW(src);
         if (!anim)
             throw error{};
@@ -2161,6 +2452,7 @@ namespace sdl::img {
     try_load_gif_animation(SDL_RWops* src)
         noexcept
     {
+        memory::tag_scope tag{memory::tag::img};
         auto anim = IMG_LoadGIFAnimation_RW(src);
         if (!anim)
             return unexpected{error{}};
@@ -0,0 +1,807 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "img_animation.hpp"
+
+
+namespace sdl::img {
+
+    namespace {
+
+        constexpr milliseconds min_delay{20};
+        constexpr milliseconds default_delay{100};
+
+        constexpr unsigned max_codes = 4096;
+
+
+        Uint16
+        load_u16(const Uint8* src)
+            noexcept
+        {
+            return src[0] | (src[1] << 8);
+        }
+
+
+        // Bounds-checked cursor over the file.
+        struct reader {
+
+            std::span<const Uint8> data;
+            std::size_t pos = 0;
+
+
+            void
+            need(std::size_t n)
+                const
+            {
+                if (n > data.size() - pos)
+                    throw error{"img::gif_source: truncated file"};
+            }
+
+
+            Uint8
+            u8()
+            {
+                need(1);
+                return data[pos++];
+            }
+
+
+            Uint16
+            u16()
+            {
+                need(2);
+                Uint16 result = load_u16(data.data() + pos);
+                pos += 2;
+                return result;
+            }
+
+
+            void
+            skip(std::size_t n)
+            {
+                need(n);
+                pos += n;
+            }
+
+
+            void
+            skip_sub_blocks()
+            {
+                while (Uint8 size = u8())
+                    skip(size);
+            }
+
+
+            // Returns false if the data ends first.
+            bool
+            try_skip_sub_blocks()
+                noexcept
+            {
+                while (pos < data.size()) {
+                    Uint8 size = data[pos++];
+                    if (!size)
+                        return true;
+                    if (size > data.size() - pos)
+                        break;
+                    pos += size;
+                }
+                pos = data.size();
+                return false;
+            }
+
+
+            [[nodiscard]]
+            bool
+            at_end()
+                const noexcept
+            {
+                return pos == data.size();
+            }
+
+        };
+
+
+        // Reads LZW codes, LSB first, from a chain of data sub-blocks.
+        struct code_reader {
+
+            reader& src;
+            std::size_t block_left = 0;
+            Uint32 bits = 0;
+            unsigned num_bits = 0;
+            bool done = false;
+
+
+            // Returns -1 when the data ends.
+            int
+            next(unsigned width)
+            {
+                while (num_bits < width) {
+                    if (done || src.at_end()) {
+                        // Truncated files are decoded as far as they go.
+                        done = true;
+                        return -1;
+                    }
+                    if (!block_left) {
+                        block_left = src.u8();
+                        if (!block_left || src.at_end()) {
+                            done = true;
+                            return -1;
+                        }
+                    }
+                    bits |= Uint32{src.u8()} << num_bits;
+                    num_bits += 8;
+                    --block_left;
+                }
+                int code = bits & ((1u << width) - 1);
+                bits >>= width;
+                num_bits -= width;
+                return code;
+            }
+
+
+            // Skip whatever is left, up to the block terminator.
+            void
+            finish()
+                noexcept
+            {
+                if (done)
+                    return;
+                src.pos += std::min(block_left, src.data.size() - src.pos);
+                src.try_skip_sub_blocks();
+            }
+
+        };
+
+
+        // Returns how many indices were decoded.
+        std::size_t
+        decode_lzw(reader& src,
+                   Uint8* out,
+                   std::size_t out_size)
+        {
+            const unsigned min_size = src.u8();
+            if (min_size < 2 || min_size > 11)
+                throw error{"img::gif_source: invalid LZW code size"};
+
+            const unsigned clear = 1u << min_size;
+            const unsigned end = clear + 1;
+
+            std::array<Uint16, max_codes> prefix;
+            std::array<Uint8, max_codes> suffix;
+            std::array<Uint8, max_codes + 1> stack;
+            for (unsigned i = 0; i < clear; ++i)
+                suffix[i] = i;
+
+            code_reader codes{src};
+            unsigned width = min_size + 1;
+            unsigned next = end + 1;
+            int old = -1;
+            Uint8 first = 0;
+            std::size_t count = 0;
+
+            for (;;) {
+                int code = codes.next(width);
+                if (code < 0 || unsigned(code) == end)
+                    break;
+                if (unsigned(code) == clear) {
+                    width = min_size + 1;
+                    next = end + 1;
+                    old = -1;
+                    continue;
+                }
+                if (old < 0) {
+                    if (unsigned(code) > clear)
+                        break;
+                    first = code;
+                    if (count < out_size)
+                        out[count++] = first;
+                    old = code;
+                    continue;
+                }
+
+                const int in_code = code;
+                unsigned sp = 0;
+                if (unsigned(code) >= next) {
+                    if (unsigned(code) > next)
+                        break;
+                    stack[sp++] = first;
+                    code = old;
+                }
+                while (unsigned(code) > clear) {
+                    stack[sp++] = suffix[code];
+                    code = prefix[code];
+                }
+                first = suffix[code];
+                stack[sp++] = first;
+                while (sp && count < out_size)
+                    out[count++] = stack[--sp];
+
+                if (next < max_codes) {
+                    prefix[next] = old;
+                    suffix[next] = first;
+                    ++next;
+                    if (next == (1u << width) && width < 12)
+                        ++width;
+                }
+                old = in_code;
+            }
+            codes.finish();
+            return count;
+        }
+
+    } // namespace
+
+
+    frame_source::~frame_source()
+        noexcept = default;
+
+
+    gif_source::gif_source(blob data) :
+        data{std::move(data)}
+    {
+        parse();
+    }
+
+
+    gif_source::gif_source(const path& filename) :
+        gif_source{load_file(filename)}
+    {}
+
+
+    gif_source::gif_source(rwops& src) :
+        gif_source{src.load()}
+    {}
+
+
+    gif_source::gif_source(const pack::archive& archive,
+                           std::string_view name) :
+        gif_source{archive.load(name)}
+    {}
+
+
+    void
+    gif_source::parse()
+    {
+        reader r{data.data()};
+        r.need(13);
+        if (std::memcmp(r.data.data(), "GIF87a", 6) && std::memcmp(r.data.data(), "GIF89a", 6))
+            throw error{"img::gif_source: not a GIF file"};
+        r.skip(6);
+        width = r.u16();
+        height = r.u16();
+        Uint8 flags = r.u8();
+        r.skip(2); // background color, aspect ratio
+        if (!width || !height)
+            throw error{"img::gif_source: invalid size"};
+        if (flags & 0x80) {
+            std::size_t size = 3u << ((flags & 7) + 1);
+            r.need(size);
+            std::memcpy(global_palette.data(), r.data.data() + r.pos, size);
+            r.skip(size);
+        }
+
+        frame_info pending;
+        try {
+            for (bool more = true; more;) {
+                switch (r.u8()) {
+
+                    case 0x21: // extension
+                        if (r.u8() == 0xf9) {
+                            Uint8 size = r.u8();
+                            r.need(size);
+                            if (size >= 4) {
+                                const Uint8* gce = r.data.data() + r.pos;
+                                pending.disposal = (gce[0] >> 2) & 7;
+                                pending.delay = milliseconds{load_u16(gce + 1) * 10};
+                                pending.transparent = (gce[0] & 1) ? gce[3] : -1;
+                            }
+                            r.skip(size);
+                        }
+                        r.skip_sub_blocks();
+                        break;
+
+                    case 0x2c: { // image
+                        frame_info f = pending;
+                        pending = {};
+                        f.offset = r.pos;
+                        f.left = r.u16();
+                        f.top = r.u16();
+                        f.width = r.u16();
+                        f.height = r.u16();
+                        Uint8 img_flags = r.u8();
+                        if (img_flags & 0x80)
+                            r.skip(3u << ((img_flags & 7) + 1));
+                        r.skip(1); // LZW code size
+                        // A truncated last image is kept, and decoded as far as it goes.
+                        more = r.try_skip_sub_blocks();
+                        if (f.delay < min_delay)
+                            f.delay = default_delay;
+                        f.keyframe = frames.empty()
+                            || (f.left == 0 && f.top == 0
+                                && f.width >= width && f.height >= height
+                                && f.transparent < 0);
+                        frames.push_back(f);
+                        break;
+                    }
+
+                    case 0x3b: // trailer
+                        more = false;
+                        break;
+
+                    default:
+                        throw error{"img::gif_source: corrupted file"};
+                }
+            }
+        }
+        catch (error&) {
+            // Keep the frames that are complete.
+            if (frames.empty())
+                throw;
+        }
+        if (frames.empty())
+            throw error{"img::gif_source: no frames"};
+
+        const std::size_t size = std::size_t(width) * height * 4;
+        canvas.resize(size);
+        indices.resize(std::size_t(width) * height);
+    }
+
+
+    void
+    gif_source::render(unsigned index)
+    {
+        const frame_info& f = frames[index];
+
+        if (decoded >= 0 && unsigned(decoded) + 1 == index) {
+            const frame_info& prev = frames[decoded];
+            if (prev.disposal == 2) {
+                // Restore to background, which is transparent.
+                const int x0 = std::min(prev.left, width);
+                const int x1 = std::min(prev.left + prev.width, width);
+                const int y1 = std::min(prev.top + prev.height, height);
+                for (int y = prev.top; y < y1; ++y)
+                    std::fill_n(canvas.data() + (std::size_t(y) * width + x0) * 4,
+                                (x1 - x0) * 4,
+                                0);
+            } else if (prev.disposal == 3 && saved.size() == canvas.size())
+                canvas = saved;
+        } else
+            std::ranges::fill(canvas, 0);
+
+        if (f.disposal == 3)
+            saved = canvas;
+
+        reader r{data.data(), f.offset + 8};
+        Uint8 img_flags = r.u8();
+        std::array<Uint8, 768> local_palette{};
+        const Uint8* palette = global_palette.data();
+        if (img_flags & 0x80) {
+            std::size_t size = 3u << ((img_flags & 7) + 1);
+            r.need(size);
+            std::memcpy(local_palette.data(), r.data.data() + r.pos, size);
+            r.skip(size);
+            palette = local_palette.data();
+        }
+
+        const std::size_t pixels = std::size_t(f.width) * f.height;
+        if (indices.size() < pixels)
+            indices.resize(pixels);
+        std::size_t count = decode_lzw(r, indices.data(), pixels);
+
+        const bool interlaced = img_flags & 0x40;
+        int row = 0;
+        int pass = 0;
+        constexpr int pass_start[4] = {0, 4, 2, 1};
+        constexpr int pass_step[4]  = {8, 8, 4, 2};
+        for (int i = 0; i < f.height && count; ++i) {
+            const int y = f.top + (interlaced ? row : i);
+            const Uint8* src = indices.data() + std::size_t(i) * f.width;
+            const int n = std::min<std::size_t>(f.width, count);
+            count -= n;
+            if (y < height) {
+                Uint8* dst = canvas.data() + std::size_t(y) * width * 4;
+                for (int x = 0; x < n; ++x) {
+                    const int cx = f.left + x;
+                    if (cx >= width)
+                        break;
+                    const Uint8 idx = src[x];
+                    if (idx == f.transparent)
+                        continue;
+                    Uint8* px = dst + cx * 4;
+                    px[0] = palette[idx * 3 + 0];
+                    px[1] = palette[idx * 3 + 1];
+                    px[2] = palette[idx * 3 + 2];
+                    px[3] = 255;
+                }
+            }
+            if (interlaced) {
+                row += pass_step[pass];
+                while (row >= f.height && pass < 3) {
+                    ++pass;
+                    row = pass_start[pass];
+                }
+            }
+        }
+
+        decoded = index;
+    }
+
+
+    int
+    gif_source::get_width()
+        const noexcept
+    {
+        return width;
+    }
+
+
+    int
+    gif_source::get_height()
+        const noexcept
+    {
+        return height;
+    }
+
+
+    unsigned
+    gif_source::get_count()
+        const noexcept
+    {
+        return frames.size();
+    }
+
+
+    milliseconds
+    gif_source::get_delay(unsigned index)
+        const noexcept
+    {
+        return index < frames.size() ? frames[index].delay : default_delay;
+    }
+
+
+    void
+    gif_source::decode(unsigned index,
+                       Uint8* dst)
+    {
+        if (index >= frames.size())
+            throw error{"img::gif_source: invalid frame index"};
+
+        if (decoded < 0 || unsigned(decoded) > index) {
+            unsigned start = index;
+            while (!frames[start].keyframe)
+                --start;
+            decoded = -1;
+            render(start);
+        }
+        while (unsigned(decoded) < index)
+            render(decoded + 1);
+
+        std::memcpy(dst, canvas.data(), canvas.size());
+    }
+
+
+    animation_player::animation_player(renderer& ren,
+                                       unique_ptr<frame_source> src,
+                                       unsigned window) :
+        source{std::move(src)},
+        tex{ren,
+            pixels::format_enum::rgba_32,
+            SDL_TEXTUREACCESS_STREAMING,
+            source->get_width(),
+            source->get_height()},
+        width{source->get_width()},
+        height{source->get_height()},
+        count{source->get_count()}
+    {
+        if (!count)
+            throw error{"img::animation_player: no frames"};
+        tex.set_blend_mode(SDL_BLENDMODE_BLEND);
+
+        // One slot holds the shown frame, so at least one more is needed to advance.
+        window = std::clamp(window, std::min(2u, count), count);
+        slots.resize(window);
+        for (auto& s : slots) {
+            s.pixels = blob{std::size_t(width) * height * 4};
+            if (s.pixels.empty())
+                throw error{"img::animation_player: out of memory"};
+        }
+        worker = std::thread{&animation_player::run, this};
+    }
+
+
+    animation_player::animation_player(renderer& ren,
+                                       const path& filename,
+                                       unsigned window) :
+        animation_player{ren,
+                         [&filename]
+                         {
+                             auto src = make_unique<gif_source>(filename);
+                             if (!src)
+                                 throw error{"img::animation_player: out of memory"};
+                             return unique_ptr<frame_source>{src.release()};
+                         }(),
+                         window}
+    {}
+
+
+    animation_player::~animation_player()
+        noexcept
+    {
+        {
+            std::lock_guard guard{mutex};
+            stop = true;
+        }
+        worker_cv.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+
+
+    unsigned
+    animation_player::distance(unsigned frame)
+        const noexcept
+    {
+        if (frame >= current)
+            return frame - current;
+        if (looping)
+            return frame + count - current;
+        return count; // behind the current frame, never needed
+    }
+
+
+    bool
+    animation_player::in_window(int frame)
+        const noexcept
+    {
+        return frame >= 0 && distance(frame) < slots.size();
+    }
+
+
+    animation_player::slot*
+    animation_player::find_ready(unsigned frame)
+        noexcept
+    {
+        for (auto& s : slots)
+            if (s.ready && s.frame == int(frame))
+                return &s;
+        return nullptr;
+    }
+
+
+    void
+    animation_player::show(slot& s)
+    {
+        tex.update(nullptr, s.pixels.data().data(), width * 4);
+        shown = s.frame;
+    }
+
+
+    void
+    animation_player::run()
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        for (;;) {
+            slot* target = nullptr;
+            unsigned frame = 0;
+            worker_cv.wait(guard,
+                           [&]
+                           {
+                               if (stop)
+                                   return true;
+                               if (failure)
+                                   return false;
+                               // The closest frame in the window that's missing.
+                               target = nullptr;
+                               for (unsigned d = 0; d < slots.size(); ++d) {
+                                   unsigned f = current + d;
+                                   if (f >= count) {
+                                       if (!looping)
+                                           break;
+                                       f -= count;
+                                   }
+                                   bool present = std::ranges::any_of(slots,
+                                                                      [f](const slot& s)
+                                                                      {
+                                                                          return s.frame == int(f);
+                                                                      });
+                                   if (present)
+                                       continue;
+                                   for (auto& s : slots)
+                                       if (!s.decoding && !in_window(s.frame)) {
+                                           target = &s;
+                                           frame = f;
+                                           return true;
+                                       }
+                                   return false;
+                               }
+                               return false;
+                           });
+            if (stop)
+                return;
+
+            target->frame = frame;
+            target->ready = false;
+            target->decoding = true;
+            guard.unlock();
+            try {
+                source->decode(frame, target->pixels.data().data());
+                guard.lock();
+                target->ready = true;
+            }
+            catch (error& e) {
+                guard.lock();
+                failure = std::move(e);
+            }
+            catch (std::exception& e) {
+                guard.lock();
+                failure = error{e};
+            }
+            target->decoding = false;
+            if (!target->ready || !in_window(target->frame)) {
+                target->frame = -1;
+                target->ready = false;
+            }
+        }
+    }
+
+
+    void
+    animation_player::play()
+        noexcept
+    {
+        playing = true;
+    }
+
+
+    void
+    animation_player::pause()
+        noexcept
+    {
+        playing = false;
+    }
+
+
+    bool
+    animation_player::is_playing()
+        const noexcept
+    {
+        return playing;
+    }
+
+
+    void
+    animation_player::set_looping(bool loop)
+        noexcept
+    {
+        {
+            std::lock_guard guard{mutex};
+            looping = loop;
+        }
+        worker_cv.notify_one();
+    }
+
+
+    bool
+    animation_player::is_looping()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return looping;
+    }
+
+
+    void
+    animation_player::seek(unsigned frame)
+        noexcept
+    {
+        {
+            std::lock_guard guard{mutex};
+            current = frame % count;
+        }
+        worker_cv.notify_one();
+        shown = -1;
+        elapsed = milliseconds{0};
+    }
+
+
+    void
+    animation_player::update(milliseconds dt)
+    {
+        std::unique_lock guard{mutex};
+        if (failure)
+            throw *failure;
+
+        if (shown != int(current)) {
+            slot* s = find_ready(current);
+            if (!s)
+                return;
+            show(*s);
+        }
+
+        if (!playing)
+            return;
+
+        elapsed += dt;
+        for (;;) {
+            const milliseconds delay = source->get_delay(current);
+            if (elapsed < delay)
+                break;
+            unsigned next = current + 1;
+            if (next == count) {
+                if (!looping) {
+                    playing = false;
+                    elapsed = milliseconds{0};
+                    break;
+                }
+                next = 0;
+            }
+            if (!find_ready(next)) {
+                // Hold the current frame, without building up a debt.
+                elapsed = delay;
+                ++stalls;
+                break;
+            }
+            elapsed -= delay;
+            current = next;
+            // The slot of the previous frame can be reused.
+            worker_cv.notify_one();
+        }
+
+        // When several frames are due, only the last one is uploaded.
+        if (shown != int(current))
+            show(*find_ready(current));
+    }
+
+
+    unsigned
+    animation_player::get_frame()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return current;
+    }
+
+
+    bool
+    animation_player::is_ready()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return shown == int(current);
+    }
+
+
+    unsigned
+    animation_player::get_count()
+        const noexcept
+    {
+        return count;
+    }
+
+
+    texture&
+    animation_player::get_texture()
+        noexcept
+    {
+        return tex;
+    }
+
+
+    Uint64
+    animation_player::get_stalls()
+        const noexcept
+    {
+        return stalls;
+    }
+
+} // namespace sdl::img
@@ -0,0 +1,389 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+#include "img_atlas.hpp"
+
+#include "error.hpp"
+#include "surface.hpp"
+
+
+namespace sdl::img {
+
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+    namespace {
+
+        // RGBA32 pixels, possibly a sub-area of a surface.
+        struct image {
+            const Uint8* pixels;
+            int pitch;
+            int width;
+            int height;
+            std::size_t hash = 0;
+        };
+
+
+        bool
+        is_transparent(const image& img,
+                       int x,
+                       int y,
+                       int w,
+                       int h)
+            noexcept
+        {
+            for (int j = y; j < y + h; ++j) {
+                const Uint8* row = img.pixels + j * img.pitch;
+                for (int i = x; i < x + w; ++i)
+                    if (row[i * 4 + 3])
+                        return false;
+            }
+            return true;
+        }
+
+
+        // Remove fully transparent rows and columns from the borders.
+        void
+        trim(image& img,
+             vec2& offset)
+            noexcept
+        {
+            int top = 0;
+            while (top < img.height && is_transparent(img, 0, top, img.width, 1))
+                ++top;
+            if (top == img.height) {
+                img.width = img.height = 0;
+                return;
+            }
+            int bottom = img.height;
+            while (is_transparent(img, 0, bottom - 1, img.width, 1))
+                --bottom;
+            int left = 0;
+            while (is_transparent(img, left, top, 1, bottom - top))
+                ++left;
+            int right = img.width;
+            while (is_transparent(img, right - 1, top, 1, bottom - top))
+                --right;
+
+            img.pixels += top * img.pitch + left * 4;
+            img.width = right - left;
+            img.height = bottom - top;
+            offset = {left, top};
+        }
+
+
+        std::size_t
+        hash_of(const image& img)
+            noexcept
+        {
+            std::hash<std::string_view> hasher;
+            std::size_t h = std::size_t(img.width) * 31 + img.height;
+            for (int y = 0; y < img.height; ++y) {
+                std::string_view row{reinterpret_cast<const char*>(img.pixels + y * img.pitch),
+                                     std::size_t(img.width) * 4};
+                h = (h ^ hasher(row)) * 0x100000001b3;
+            }
+            return h;
+        }
+
+
+        bool
+        same_pixels(const image& a,
+                    const image& b)
+            noexcept
+        {
+            if (a.width != b.width || a.height != b.height)
+                return false;
+            for (int y = 0; y < a.height; ++y)
+                if (std::memcmp(a.pixels + y * a.pitch,
+                                b.pixels + y * b.pitch,
+                                std::size_t(a.width) * 4))
+                    return false;
+            return true;
+        }
+
+
+        // Shelf packing, tallest first; returns the page height.
+        int
+        pack(const vector<image>& images,
+             const vector<unsigned>& order,
+             vector<rect>& areas,
+             int page_width,
+             int padding)
+            noexcept
+        {
+            int x = padding;
+            int y = padding;
+            int shelf = 0;
+            for (unsigned i : order) {
+                const image& img = images[i];
+                if (!img.width)
+                    continue;
+                if (x + img.width + padding > page_width) {
+                    y += shelf + padding;
+                    x = padding;
+                    shelf = 0;
+                }
+                areas[i] = rect{x, y, img.width, img.height};
+                x += img.width + padding;
+                shelf = std::max(shelf, img.height);
+            }
+            return y + shelf + padding;
+        }
+
+    } // namespace
+
+
+    animation_atlas::animation_atlas(renderer& ren,
+                                     const animation& anim) :
+        animation_atlas{ren, anim, options{}}
+    {}
+
+
+    animation_atlas::animation_atlas(renderer& ren,
+                                     const animation& anim,
+                                     const options& opt) :
+        width{anim.width},
+        height{anim.height}
+    {
+        if (anim.frames.empty() || width <= 0 || height <= 0)
+            throw error{"img::animation_atlas: no frames"};
+        const int padding = std::max(opt.padding, 0);
+
+        // Reserved, so the pointers into it stay valid.
+        vector<surface> converted;
+        converted.reserve(anim.frames.size());
+
+        vector<image> unique;
+        vector<unsigned> image_of;
+        std::unordered_multimap<std::size_t, unsigned> by_hash;
+        frames.reserve(anim.frames.size());
+        image_of.reserve(anim.frames.size());
+
+        for (std::size_t i = 0; i < anim.frames.size(); ++i) {
+            const surface* src = &anim.frames[i];
+            if (src->data()->format->format != SDL_PIXELFORMAT_RGBA32 || src->must_lock())
+                src = &converted.emplace_back(*src, pixels::format_enum::rgba_32);
+
+            image img{
+                src->get_pixels_as<Uint8>(),
+                src->get_pitch(),
+                src->get_width(),
+                src->get_height()
+            };
+            vec2 offset{0, 0};
+            if (opt.trim)
+                trim(img, offset);
+
+            unsigned index = unique.size();
+            if (opt.dedup) {
+                img.hash = hash_of(img);
+                auto [first, last] = by_hash.equal_range(img.hash);
+                for (; first != last; ++first)
+                    if (same_pixels(unique[first->second], img)) {
+                        index = first->second;
+                        break;
+                    }
+            }
+            if (index == unique.size()) {
+                unique.push_back(img);
+                if (opt.dedup)
+                    by_hash.emplace(img.hash, index);
+            }
+            image_of.push_back(index);
+
+            milliseconds delay{i < anim.delays.size() ? std::max(anim.delays[i], 0) : 0};
+            frames.push_back({rect{}, offset, duration, delay});
+            duration += delay;
+        }
+        images = unique.size();
+
+        vector<unsigned> order(unique.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::ranges::sort(order,
+                          [&unique](unsigned a, unsigned b)
+                          {
+                              if (unique[a].height != unique[b].height)
+                                  return unique[a].height > unique[b].height;
+                              return unique[a].width > unique[b].width;
+                          });
+
+        long long total = 0;
+        int widest = 0;
+        for (auto& img : unique) {
+            total += (img.width + padding) * (long long)(img.height + padding);
+            widest = std::max(widest, img.width);
+        }
+
+        auto info = ren.get_info();
+        const int max_width = info.max_texture_width > 0 ? info.max_texture_width : INT_MAX;
+        const int max_height = info.max_texture_height > 0 ? info.max_texture_height : INT_MAX;
+
+        // Start with a square-ish page, and widen it if it's too tall.
+        long long page_width = std::max<long long>(widest + 2 * padding,
+                                                   std::llround(std::sqrt(double(total))) + padding);
+        page_width = std::clamp<long long>(page_width, 1, max_width);
+        if (widest + 2 * padding > page_width)
+            throw error{"img::animation_atlas: frame is too large for a texture"};
+        vector<rect> areas(unique.size());
+        int page_height;
+        for (;;) {
+            page_height = pack(unique, order, areas, page_width, padding);
+            if (page_height <= max_height)
+                break;
+            if (page_width == max_width)
+                throw error{"img::animation_atlas: frames don't fit in one texture"};
+            page_width = std::min<long long>(page_width * 2, max_width);
+        }
+        page_height = std::max(page_height, 1);
+
+        // New surfaces are cleared, so the padding is transparent.
+        surface sheet{int(page_width), page_height, 32, pixels::format_enum::rgba_32};
+        Uint8* dst = sheet.get_pixels_as<Uint8>();
+        const int dst_pitch = sheet.get_pitch();
+        for (std::size_t i = 0; i < unique.size(); ++i) {
+            const image& img = unique[i];
+            const rect& area = areas[i];
+            for (int y = 0; y < img.height; ++y)
+                std::memcpy(dst + (area.y + y) * dst_pitch + area.x * 4,
+                            img.pixels + y * img.pitch,
+                            std::size_t(img.width) * 4);
+        }
+        page.create(ren, sheet);
+        page.set_blend_mode(SDL_BLENDMODE_BLEND);
+
+        for (std::size_t i = 0; i < frames.size(); ++i)
+            frames[i].area = areas[image_of[i]];
+    }
+
+
+    texture&
+    animation_atlas::get_texture()
+        noexcept
+    {
+        return page;
+    }
+
+
+    const texture&
+    animation_atlas::get_texture()
+        const noexcept
+    {
+        return page;
+    }
+
+
+    std::span<const animation_atlas::frame>
+    animation_atlas::get_frames()
+        const noexcept
+    {
+        return frames;
+    }
+
+
+    unsigned
+    animation_atlas::get_count()
+        const noexcept
+    {
+        return frames.size();
+    }
+
+
+    unsigned
+    animation_atlas::get_images()
+        const noexcept
+    {
+        return images;
+    }
+
+
+    int
+    animation_atlas::get_width()
+        const noexcept
+    {
+        return width;
+    }
+
+
+    int
+    animation_atlas::get_height()
+        const noexcept
+    {
+        return height;
+    }
+
+
+    milliseconds
+    animation_atlas::get_duration()
+        const noexcept
+    {
+        return duration;
+    }
+
+
+    unsigned
+    animation_atlas::find_frame(milliseconds t,
+                                bool loop)
+        const noexcept
+    {
+        if (duration <= milliseconds{0})
+            return 0;
+        t = std::max(t, milliseconds{0});
+        if (loop)
+            t %= duration;
+        else if (t >= duration)
+            return frames.size() - 1;
+        // The last frame that starts at or before t.
+        auto it = std::ranges::upper_bound(frames, t, {}, &frame::start);
+        return it - frames.begin() - 1;
+    }
+
+
+    void
+    animation_atlas::draw(renderer& ren,
+                          unsigned index,
+                          vec2 pos)
+        const
+    {
+        const frame& f = frames[index];
+        if (f.area.w <= 0 || f.area.h <= 0)
+            return;
+        rect dst{pos.x + f.offset.x, pos.y + f.offset.y, f.area.w, f.area.h};
+        ren.copy(page, &f.area, &dst);
+    }
+
+
+    void
+    animation_atlas::draw(renderer& ren,
+                          unsigned index,
+                          const rectf& dst)
+        const
+    {
+        const frame& f = frames[index];
+        if (f.area.w <= 0 || f.area.h <= 0)
+            return;
+        const float sx = dst.w / width;
+        const float sy = dst.h / height;
+        rectf area{dst.x + f.offset.x * sx,
+                   dst.y + f.offset.y * sy,
+                   f.area.w * sx,
+                   f.area.h * sy};
+        ren.copy(page, &f.area, &area);
+    }
+
+#endif // SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+} // namespace sdl::img
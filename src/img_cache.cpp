@@ -0,0 +1,688 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#define SDL2XX_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <SDL_pixels.h>
+#include <SDL_timer.h>
+
+#include "img_cache.hpp"
+
+#include "endian.hpp"
+#include "rwops.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::img {
+
+    namespace {
+
+        constexpr char magic[8] = {'S', 'D', 'L', '2', 'X', 'X', 'I', 'M'};
+        constexpr Uint32 version = 2;
+        constexpr Uint32 byte_order_mark = 0x01020304;
+
+        constexpr std::size_t header_size = 64;
+
+
+        // Stored in native byte order.
+        struct file_header {
+            char magic[8];
+            Uint32 version;
+            Uint32 byte_order;
+            Uint32 format;
+            Sint32 width;
+            Sint32 height;
+            Sint32 pitch;
+            Uint64 source_hash;
+            Uint64 source_size;
+            Uint64 data_offset;
+            Uint8 reserved[8];
+        };
+
+        static_assert(sizeof(file_header) == header_size);
+
+
+        // XXH64 primes.
+        constexpr Uint64 prime1 = 0x9e3779b185ebca87;
+        constexpr Uint64 prime2 = 0xc2b2ae3d27d4eb4f;
+        constexpr Uint64 prime3 = 0x165667b19e3779f9;
+        constexpr Uint64 prime4 = 0x85ebca77c2b2ae63;
+        constexpr Uint64 prime5 = 0x27d4eb2f165667c5;
+
+
+        template<typename T>
+        T
+        load_le(const Uint8* p)
+            noexcept
+        {
+            T x;
+            std::memcpy(&x, p, sizeof x);
+            return endian::from_le(x);
+        }
+
+
+        Uint64
+        xxh64_round(Uint64 acc,
+                    Uint64 input)
+            noexcept
+        {
+            return std::rotl(acc + input * prime2, 31) * prime1;
+        }
+
+
+        Uint64
+        xxh64_merge(Uint64 acc,
+                    Uint64 lane)
+            noexcept
+        {
+            return (acc ^ xxh64_round(0, lane)) * prime1 + prime4;
+        }
+
+
+        // XXH64 with seed 0; the same value the reference implementation gives.
+        Uint64
+        content_hash(std::span<const Uint8> data)
+            noexcept
+        {
+            const Uint8* p = data.data();
+            const std::size_t n = data.size();
+            std::size_t i = 0;
+            Uint64 h;
+            if (n >= 32) {
+                Uint64 v1 = prime1 + prime2;
+                Uint64 v2 = prime2;
+                Uint64 v3 = 0;
+                Uint64 v4 = -prime1;
+                for (; i + 32 <= n; i += 32) {
+                    v1 = xxh64_round(v1, load_le<Uint64>(p + i));
+                    v2 = xxh64_round(v2, load_le<Uint64>(p + i + 8));
+                    v3 = xxh64_round(v3, load_le<Uint64>(p + i + 16));
+                    v4 = xxh64_round(v4, load_le<Uint64>(p + i + 24));
+                }
+                h = std::rotl(v1, 1) + std::rotl(v2, 7)
+                    + std::rotl(v3, 12) + std::rotl(v4, 18);
+                h = xxh64_merge(h, v1);
+                h = xxh64_merge(h, v2);
+                h = xxh64_merge(h, v3);
+                h = xxh64_merge(h, v4);
+            } else
+                h = prime5;
+            h += n;
+
+            // Every tail byte goes through its own step.
+            for (; i + 8 <= n; i += 8) {
+                h ^= xxh64_round(0, load_le<Uint64>(p + i));
+                h = std::rotl(h, 27) * prime1 + prime4;
+            }
+            if (i + 4 <= n) {
+                h = std::rotl(h ^ (load_le<Uint32>(p + i) * prime1), 23) * prime2 + prime3;
+                i += 4;
+            }
+            for (; i < n; ++i)
+                h = std::rotl(h ^ (p[i] * prime5), 11) * prime1;
+
+            h ^= h >> 33;
+            h *= prime2;
+            h ^= h >> 29;
+            h *= prime3;
+            h ^= h >> 32;
+            return h;
+        }
+
+
+        path
+        make_filename(const path& directory,
+                      Uint64 hash,
+                      Uint64 size,
+                      int width,
+                      int height)
+        {
+            char name[96];
+            if (width > 0 || height > 0)
+                std::snprintf(name, sizeof name,
+                              "%016llx-%llx-svg%dx%d",
+                              static_cast<unsigned long long>(hash),
+                              static_cast<unsigned long long>(size),
+                              width, height);
+            else
+                std::snprintf(name, sizeof name,
+                              "%016llx-%llx",
+                              static_cast<unsigned long long>(hash),
+                              static_cast<unsigned long long>(size));
+            path result = directory / name;
+            result += decode_cache::extension;
+            return result;
+        }
+
+
+        expected<file_header, error>
+        parse_header(const Uint8* base,
+                     std::size_t size,
+                     Uint64 hash,
+                     Uint64 source_size)
+            noexcept
+        {
+            if (size < header_size)
+                return unexpected{error{"img::decode_cache: truncated file"}};
+            file_header h;
+            std::memcpy(&h, base, sizeof h);
+            if (std::memcmp(h.magic, magic, sizeof magic)
+                || h.version != version
+                || h.byte_order != byte_order_mark)
+                return unexpected{error{"img::decode_cache: not a cache file"}};
+            if (h.source_hash != hash || h.source_size != source_size)
+                return unexpected{error{"img::decode_cache: hash mismatch"}};
+            if (h.width <= 0 || h.height <= 0 || h.pitch <= 0
+                || SDL_ISPIXELFORMAT_INDEXED(h.format)
+                || SDL_BYTESPERPIXEL(h.format) == 0
+                || static_cast<Uint64>(h.pitch) < Uint64{SDL_BYTESPERPIXEL(h.format)} * h.width
+                || h.data_offset < header_size
+                || h.data_offset > size
+                || static_cast<Uint64>(h.pitch) * h.height > size - h.data_offset)
+                return unexpected{error{"img::decode_cache: corrupted file"}};
+            return h;
+        }
+
+
+        expected<surface, error>
+        make_surface(Uint8* base,
+                     const file_header& h)
+            noexcept
+        {
+            try {
+                return surface{base + h.data_offset,
+                               h.width,
+                               h.height,
+                               static_cast<int>(SDL_BITSPERPIXEL(h.format)),
+                               h.pitch,
+                               static_cast<pixels::format_enum>(h.format)};
+            }
+            catch (error& e) {
+                return unexpected{std::move(e)};
+            }
+            catch (std::exception& e) {
+                return unexpected{error{e}};
+            }
+        }
+
+
+        expected<surface, error>
+        decode(std::span<const Uint8> data,
+               [[maybe_unused]] int width,
+               [[maybe_unused]] int height)
+            noexcept
+        {
+            try {
+                rwops src{data.data(), static_cast<int>(data.size())};
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+                auto result = width > 0 || height > 0
+                    ? try_load_svg(src, width, height)
+                    : try_load(src);
+#else
+                auto result = try_load(src);
+#endif
+                if (!result)
+                    return result;
+                if (SDL_ISPIXELFORMAT_INDEXED(result->data()->format->format))
+                    return surface{*result, pixels::format_enum::rgba_32};
+                return result;
+            }
+            catch (error& e) {
+                return unexpected{std::move(e)};
+            }
+            catch (std::exception& e) {
+                return unexpected{error{e}};
+            }
+        }
+
+
+        path
+        make_temp_name(const path& filename)
+        {
+            static std::atomic<Uint64> counter = 0;
+            Uint64 unique = SDL_GetPerformanceCounter()
+                ^ std::hash<std::thread::id>{}(std::this_thread::get_id())
+                ^ (++counter * prime1);
+            char suffix[32];
+            std::snprintf(suffix, sizeof suffix, ".%016llx.tmp",
+                          static_cast<unsigned long long>(unique));
+            path result = filename;
+            result += suffix;
+            return result;
+        }
+
+    } // namespace
+
+
+    cached_surface::cached_surface(void* map_base,
+                                   std::size_t map_size,
+                                   blob storage,
+                                   surface surf)
+        noexcept :
+        map_base{map_base},
+        map_size{map_size},
+        storage{std::move(storage)},
+        surf{std::move(surf)}
+    {}
+
+
+    cached_surface::cached_surface(surface&& surf)
+        noexcept :
+        surf{std::move(surf)}
+    {}
+
+
+    cached_surface::cached_surface(cached_surface&& other)
+        noexcept :
+        map_base{std::exchange(other.map_base, nullptr)},
+        map_size{std::exchange(other.map_size, 0)},
+        storage{std::move(other.storage)},
+        surf{std::move(other.surf)}
+    {}
+
+
+    cached_surface::~cached_surface()
+        noexcept
+    {
+        destroy();
+    }
+
+
+    cached_surface&
+    cached_surface::operator =(cached_surface&& other)
+        noexcept
+    {
+        if (this != &other) {
+            destroy();
+            map_base = std::exchange(other.map_base, nullptr);
+            map_size = std::exchange(other.map_size, 0);
+            storage = std::move(other.storage);
+            surf = std::move(other.surf);
+        }
+        return *this;
+    }
+
+
+    void
+    cached_surface::destroy()
+        noexcept
+    {
+        // The surface goes first, it may point into the mapping.
+        surf.destroy();
+#ifdef SDL2XX_USE_MMAP
+        if (map_base)
+            ::munmap(map_base, map_size);
+#endif
+        map_base = nullptr;
+        map_size = 0;
+        storage = blob{nullptr, 0};
+    }
+
+
+    surface&
+    cached_surface::get()
+        noexcept
+    {
+        return surf;
+    }
+
+
+    const surface&
+    cached_surface::get()
+        const noexcept
+    {
+        return surf;
+    }
+
+
+    bool
+    cached_surface::is_cached()
+        const noexcept
+    {
+        return map_base || !storage.empty();
+    }
+
+
+    decode_cache::decode_cache(const path& directory) :
+        directory{directory}
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec)
+            throw error{"img::decode_cache: could not create the directory"};
+    }
+
+
+    const path&
+    decode_cache::get_directory()
+        const noexcept
+    {
+        return directory;
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_map(const path& filename,
+                          Uint64 hash,
+                          Uint64 size)
+        noexcept
+    {
+#ifdef SDL2XX_USE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return unexpected{error{"img::decode_cache: not cached"}};
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(header_size)) {
+            ::close(fd);
+            return unexpected{error{"img::decode_cache: truncated file"}};
+        }
+        // Copy-on-write, so the surface can be modified.
+        void* ptr = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+            return unexpected{error{"img::decode_cache: mmap() failed"}};
+        auto base = static_cast<Uint8*>(ptr);
+        auto header = parse_header(base, st.st_size, hash, size);
+        if (header) {
+            auto surf = make_surface(base, *header);
+            if (surf)
+                return cached_surface{ptr, static_cast<std::size_t>(st.st_size), blob{nullptr, 0}, std::move(*surf)};
+            header = unexpected{std::move(surf.error())};
+        }
+        ::munmap(ptr, st.st_size);
+        return unexpected{std::move(header.error())};
+#else
+        std::error_code ec;
+        if (!std::filesystem::exists(filename, ec))
+            return unexpected{error{"img::decode_cache: not cached"}};
+        auto storage = try_load_file(filename);
+        if (!storage)
+            return unexpected{std::move(storage.error())};
+        auto bytes = storage->data();
+        auto header = parse_header(bytes.data(), bytes.size(), hash, size);
+        if (!header)
+            return unexpected{std::move(header.error())};
+        auto surf = make_surface(bytes.data(), *header);
+        if (!surf)
+            return unexpected{std::move(surf.error())};
+        return cached_surface{nullptr, 0, std::move(*storage), std::move(*surf)};
+#endif
+    }
+
+
+    bool
+    decode_cache::store(const path& filename,
+                        const surface& surf,
+                        Uint64 hash,
+                        Uint64 size)
+        noexcept
+    {
+        path temp;
+        try {
+            const SDL_Surface* raw = surf.data();
+            file_header h{};
+            std::memcpy(h.magic, magic, sizeof magic);
+            h.version = version;
+            h.byte_order = byte_order_mark;
+            h.format = raw->format->format;
+            h.width = raw->w;
+            h.height = raw->h;
+            h.pitch = raw->pitch;
+            h.source_hash = hash;
+            h.source_size = size;
+            h.data_offset = header_size;
+
+            temp = make_temp_name(filename);
+            {
+                rwops dst{temp, "wb"};
+                const std::size_t data_size = static_cast<std::size_t>(raw->pitch) * raw->h;
+                if (dst.write(&h, sizeof h, 1) != 1
+                    || dst.write(raw->pixels, 1, data_size) != data_size)
+                    throw error{"img::decode_cache: short write"};
+            }
+            std::error_code ec;
+            // Replacing is atomic, so readers see either the old file or the new one.
+            std::filesystem::rename(temp, filename, ec);
+            if (ec)
+                throw error{"img::decode_cache: rename failed"};
+            return true;
+        }
+        catch (...) {
+            std::error_code ec;
+            if (!temp.empty())
+                std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_get(std::span<const Uint8> data,
+                          int width,
+                          int height)
+        noexcept
+    {
+        const Uint64 hash = content_hash(data);
+        const Uint64 size = data.size();
+        path filename;
+        try {
+            filename = make_filename(directory, hash, size, width, height);
+        }
+        catch (std::exception& e) {
+            return unexpected{error{e}};
+        }
+
+        if (auto cached = try_map(filename, hash, size)) {
+            ++hits;
+            return cached;
+        }
+        ++misses;
+
+        auto surf = decode(data, width, height);
+        if (!surf)
+            return unexpected{std::move(surf.error())};
+        if (store(filename, *surf, hash, size))
+            ++stores;
+        return cached_surface{std::move(*surf)};
+    }
+
+
+    cached_surface
+    decode_cache::load(const path& filename)
+    {
+        auto result = try_load(filename);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_load(const path& filename)
+        noexcept
+    {
+        auto data = try_load_file(filename);
+        if (!data)
+            return unexpected{std::move(data.error())};
+        return try_get(data->data(), 0, 0);
+    }
+
+
+    cached_surface
+    decode_cache::load(const pack::archive& archive,
+                       std::string_view name)
+    {
+        auto result = try_load(archive, name);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_load(const pack::archive& archive,
+                           std::string_view name)
+        noexcept
+    {
+        auto data = archive.try_load(name);
+        if (!data)
+            return unexpected{std::move(data.error())};
+        return try_get(data->data(), 0, 0);
+    }
+
+
+    cached_surface
+    decode_cache::load(std::span<const Uint8> data)
+    {
+        auto result = try_load(data);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_load(std::span<const Uint8> data)
+        noexcept
+    {
+        return try_get(data, 0, 0);
+    }
+
+
+#if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+    cached_surface
+    decode_cache::load_svg(const path& filename,
+                           int width,
+                           int height)
+    {
+        auto result = try_load_svg(filename, width, height);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_load_svg(const path& filename,
+                               int width,
+                               int height)
+        noexcept
+    {
+        auto data = try_load_file(filename);
+        if (!data)
+            return unexpected{std::move(data.error())};
+        return try_get(data->data(), width, height);
+    }
+
+
+    cached_surface
+    decode_cache::load_svg(const pack::archive& archive,
+                           std::string_view name,
+                           int width,
+                           int height)
+    {
+        auto result = try_load_svg(archive, name, width, height);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_load_svg(const pack::archive& archive,
+                               std::string_view name,
+                               int width,
+                               int height)
+        noexcept
+    {
+        auto data = archive.try_load(name);
+        if (!data)
+            return unexpected{std::move(data.error())};
+        return try_get(data->data(), width, height);
+    }
+
+
+    cached_surface
+    decode_cache::load_svg(std::span<const Uint8> data,
+                           int width,
+                           int height)
+    {
+        auto result = try_load_svg(data, width, height);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<cached_surface, error>
+    decode_cache::try_load_svg(std::span<const Uint8> data,
+                               int width,
+                               int height)
+        noexcept
+    {
+        return try_get(data, width, height);
+    }
+
+#endif // SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
+
+
+    void
+    decode_cache::clear()
+        noexcept
+    {
+        try {
+            std::error_code ec;
+            for (auto it = std::filesystem::directory_iterator{directory, ec};
+                 !ec && it != std::filesystem::directory_iterator{};
+                 it.increment(ec)) {
+                // Also matches leftover temporary files.
+                if (it->path().filename().string().contains(extension)) {
+                    std::error_code rec;
+                    std::filesystem::remove(it->path(), rec);
+                }
+            }
+        }
+        catch (...) {}
+    }
+
+
+    decode_cache::stats
+    decode_cache::get_stats()
+        const noexcept
+    {
+        return {
+            .hits = hits.load(),
+            .misses = misses.load(),
+            .stores = stores.load(),
+        };
+    }
+
+} // namespace sdl::img
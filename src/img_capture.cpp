@@ -0,0 +1,286 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <utility>
+
+#include <SDL_render.h>
+#include <SDL_timer.h>
+#include <SDL_video.h>
+
+#include "img_capture.hpp"
+
+#include "vec2.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::img {
+
+    struct frame_capture::slot {
+        // Pixels as they were read, in the render target's format.
+        surface staged{nullptr, surface::dont_destroy};
+        // Only used when the target's format isn't the requested one.
+        surface converted{nullptr, surface::dont_destroy};
+    };
+
+
+    namespace {
+
+        std::chrono::nanoseconds
+        since(Uint64 start)
+            noexcept
+        {
+            static const double ns_per_tick = 1e9 / SDL_GetPerformanceFrequency();
+            return std::chrono::nanoseconds(Sint64((SDL_GetPerformanceCounter() - start)
+                                                   * ns_per_tick));
+        }
+
+
+        void
+        add_cost(frame_capture::stats& counters,
+                 std::chrono::nanoseconds cost)
+            noexcept
+        {
+            counters.last_cost = cost;
+            counters.max_cost = std::max(counters.max_cost, cost);
+            counters.total_cost += cost;
+        }
+
+
+        // The format SDL_RenderReadPixels() uses by default: the target texture's, or the
+        // window's when rendering to the window.
+        pixels::format_enum
+        target_format(renderer& ren)
+            noexcept
+        {
+            Uint32 fmt = SDL_PIXELFORMAT_UNKNOWN;
+            if (SDL_Texture* target = SDL_GetRenderTarget(ren.data())) {
+                if (SDL_QueryTexture(target, &fmt, nullptr, nullptr, nullptr) < 0)
+                    fmt = SDL_PIXELFORMAT_UNKNOWN;
+            } else if (SDL_Window* win = SDL_RenderGetWindow(ren.data()))
+                fmt = SDL_GetWindowPixelFormat(win);
+            // Software renderers on a plain surface have no window.
+            if (fmt == SDL_PIXELFORMAT_UNKNOWN
+                || SDL_ISPIXELFORMAT_FOURCC(fmt)
+                || SDL_BYTESPERPIXEL(fmt) == 0)
+                return pixels::format_enum::argb_8888;
+            return static_cast<pixels::format_enum>(fmt);
+        }
+
+
+        // Reuse the surface if it has the right size and format.
+        void
+        reserve(surface& s,
+                int width,
+                int height,
+                pixels::format_enum fmt)
+        {
+            if (s
+                && s.get_width() == width
+                && s.get_height() == height
+                && s.data()->format->format == static_cast<Uint32>(fmt))
+                return;
+            s = surface{width, height, SDL_BITSPERPIXEL(static_cast<Uint32>(fmt)), fmt};
+        }
+
+    } // namespace
+
+
+    frame_capture::frame_capture(thread_pool& pool,
+                                 frame_function func) :
+        frame_capture{pool, std::move(func), options{}}
+    {}
+
+
+    frame_capture::frame_capture(thread_pool& pool,
+                                 frame_function func,
+                                 const options& opt) :
+        pool{&pool},
+        func{std::move(func)},
+        opt{opt}
+    {
+        if (!this->func)
+            throw error{"img::frame_capture: no frame function"};
+        const std::size_t num_slots = std::max<std::size_t>(opt.num_slots, 1);
+        // The surfaces are only allocated by the first captures.
+        slots.reserve(num_slots);
+        free_slots.reserve(num_slots);
+        for (std::size_t i = 0; i < num_slots; ++i) {
+            auto s = make_unique<slot>();
+            if (!s)
+                throw error{"img::frame_capture: out of memory"};
+            free_slots.push_back(slots.emplace_back(std::move(s)).get());
+        }
+    }
+
+
+    frame_capture::~frame_capture()
+        noexcept
+    {
+        wait();
+    }
+
+
+    bool
+    frame_capture::capture(renderer& ren)
+    {
+        auto result = try_capture(ren);
+        if (!result)
+            throw result.error();
+        return *result;
+    }
+
+
+    expected<bool, error>
+    frame_capture::try_capture(renderer& ren)
+        noexcept
+    {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        slot* s;
+        {
+            std::lock_guard guard{mutex};
+            if (free_slots.empty()) {
+                ++counters.dropped;
+                add_cost(counters, since(start));
+                return false;
+            }
+            s = free_slots.back();
+            free_slots.pop_back();
+            ++in_flight;
+        }
+
+        try {
+            // Not cached: the render target can change between frames.
+            const pixels::format_enum fmt = target_format(ren);
+            vec2 size = opt.area ? vec2{opt.area->w, opt.area->h} : ren.get_output_size();
+            if (size.x <= 0 || size.y <= 0)
+                throw error{"img::frame_capture: nothing to capture"};
+            reserve(s->staged, size.x, size.y, fmt);
+            ren.read_pixels(opt.area, fmt, s->staged.get_pixels(), s->staged.get_pitch());
+            pool->submit([this, s, index = next_index] { process(*s, index); });
+            ++next_index;
+        }
+        catch (std::exception& e) {
+            release(*s, false);
+            std::lock_guard guard{mutex};
+            add_cost(counters, since(start));
+            return unexpected{error{e}};
+        }
+
+        std::lock_guard guard{mutex};
+        ++counters.captured;
+        add_cost(counters, since(start));
+        return true;
+    }
+
+
+    void
+    frame_capture::process(slot& s,
+                           Uint64 index)
+        noexcept
+    {
+        bool ok = true;
+        try {
+            const surface* frame = &s.staged;
+            const Uint32 staged_format = s.staged.data()->format->format;
+            if (opt.format != pixels::format_enum::unknown
+                && static_cast<Uint32>(opt.format) != staged_format) {
+                const int width = s.staged.get_width();
+                const int height = s.staged.get_height();
+                reserve(s.converted, width, height, opt.format);
+                if (SDL_ConvertPixels(width, height,
+                                      staged_format,
+                                      s.staged.get_pixels(),
+                                      s.staged.get_pitch(),
+                                      static_cast<Uint32>(opt.format),
+                                      s.converted.get_pixels(),
+                                      s.converted.get_pitch()) < 0)
+                    throw error{};
+                frame = &s.converted;
+            }
+            func(index, *frame);
+        }
+        catch (...) {
+            ok = false;
+        }
+        release(s, ok);
+    }
+
+
+    void
+    frame_capture::release(slot& s,
+                           bool ok)
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        if (!ok)
+            ++counters.failed;
+        // Never grows: the slot was taken from this vector.
+        free_slots.push_back(&s);
+        if (--in_flight == 0)
+            idle_cv.notify_all();
+    }
+
+
+    void
+    frame_capture::wait()
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        idle_cv.wait(guard, [this] { return in_flight == 0; });
+    }
+
+
+    std::size_t
+    frame_capture::get_pending()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return in_flight;
+    }
+
+
+    frame_capture::stats
+    frame_capture::get_stats()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return counters;
+    }
+
+
+    void
+    frame_capture::reset_stats()
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        counters = {};
+    }
+
+
+    frame_capture::frame_function
+    frame_capture::save_png_files(const path& prefix)
+    {
+        return [prefix](Uint64 index, const surface& frame)
+        {
+            // Zero-padded, so the files sort in order.
+            std::string number = std::to_string(index);
+            if (number.size() < 6)
+                number.insert(0, 6 - number.size(), '0');
+            path filename = prefix;
+            filename += number + ".png";
+            save_png(frame, filename);
+        };
+    }
+
+} // namespace sdl::img
@@ -0,0 +1,652 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <span>
+#include <utility>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "img_encoder.hpp"
+
+#include "vector.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::img {
+
+    struct encoder::job {
+
+        enum class kind : Uint8 {
+            png,
+            jpg,
+        };
+
+        struct band {
+            vector<Uint8> chunk;
+            Uint32 adler = 1;
+            std::size_t size = 0;
+            bool ready = false;
+        };
+
+        kind type;
+        surface src;
+        rwops dst;
+        done_function done;
+        png_options opt;
+        int quality;
+
+        int bpp = 0;
+        std::size_t row_size = 0;
+        int band_rows = 0;
+
+        std::mutex mutex;
+
+        // All fields below are guarded by the mutex.
+
+        vector<band> bands;
+        std::size_t next_write = 0;
+        bool writing = false;
+        Uint32 adler = 1;
+        std::optional<error> failure;
+
+
+        job(kind type,
+            surface&& src,
+            rwops&& dst,
+            done_function&& done,
+            const png_options& opt,
+            int quality)
+            noexcept :
+            type{type},
+            src{std::move(src)},
+            dst{std::move(dst)},
+            done{std::move(done)},
+            opt{opt},
+            quality{quality}
+        {}
+
+    };
+
+
+#ifdef HAVE_ZLIB
+
+    namespace {
+
+        constexpr std::size_t window_size = 32 * 1024;
+
+        // A band should be big enough that deflate works well on it.
+        constexpr std::size_t min_band_size = 256 * 1024;
+
+
+        void
+        put_be32(Uint8* dst,
+                 Uint32 value)
+            noexcept
+        {
+            dst[0] = value >> 24;
+            dst[1] = value >> 16;
+            dst[2] = value >> 8;
+            dst[3] = value;
+        }
+
+
+        expected<void, error>
+        write_chunk(rwops& dst,
+                    const char* type,
+                    std::span<const Uint8> data)
+            noexcept
+        {
+            std::array<Uint8, 8> head;
+            put_be32(head.data(), data.size());
+            std::memcpy(head.data() + 4, type, 4);
+            std::array<Uint8, 4> tail;
+            Uint32 crc = crc32(0, head.data() + 4, 4);
+            crc = crc32(crc, data.data(), data.size());
+            put_be32(tail.data(), crc);
+
+            if (auto r = dst.try_write(head.data(), 1, head.size()); !r)
+                return unexpected{std::move(r.error())};
+            if (!data.empty())
+                if (auto r = dst.try_write(data.data(), 1, data.size()); !r)
+                    return unexpected{std::move(r.error())};
+            if (auto r = dst.try_write(tail.data(), 1, tail.size()); !r)
+                return unexpected{std::move(r.error())};
+            return {};
+        }
+
+
+        Uint8
+        paeth(int a,
+              int b,
+              int c)
+            noexcept
+        {
+            int p = a + b - c;
+            int pa = std::abs(p - a);
+            int pb = std::abs(p - b);
+            int pc = std::abs(p - c);
+            if (pa <= pb && pa <= pc)
+                return a;
+            if (pb <= pc)
+                return b;
+            return c;
+        }
+
+
+        // Writes the filtered bytes, without the filter type byte.
+        void
+        filter(Uint8 type,
+               const Uint8* row,
+               const Uint8* prev,
+               std::size_t size,
+               std::size_t bpp,
+               Uint8* out)
+            noexcept
+        {
+            const std::size_t left = std::min(bpp, size);
+            // The first pixel has no left neighbor.
+            switch (type) {
+                case 0:
+                    std::memcpy(out, row, size);
+                    break;
+                case 1:
+                    std::memcpy(out, row, left);
+                    for (std::size_t i = left; i < size; ++i)
+                        out[i] = row[i] - row[i - bpp];
+                    break;
+                case 2:
+                    if (!prev)
+                        std::memcpy(out, row, size);
+                    else
+                        for (std::size_t i = 0; i < size; ++i)
+                            out[i] = row[i] - prev[i];
+                    break;
+                case 3:
+                    for (std::size_t i = 0; i < left; ++i)
+                        out[i] = row[i] - (prev ? prev[i] / 2 : 0);
+                    for (std::size_t i = left; i < size; ++i)
+                        out[i] = row[i] - (row[i - bpp] + (prev ? prev[i] : 0)) / 2;
+                    break;
+                case 4:
+                    if (!prev) {
+                        // Paeth becomes Sub.
+                        filter(1, row, prev, size, bpp, out);
+                        break;
+                    }
+                    for (std::size_t i = 0; i < left; ++i)
+                        out[i] = row[i] - prev[i];
+                    for (std::size_t i = left; i < size; ++i)
+                        out[i] = row[i] - paeth(row[i - bpp], prev[i], prev[i - bpp]);
+                    break;
+            }
+        }
+
+
+        // Pick the filter with the smallest sum of absolute values, like libpng does.
+        void
+        filter_adaptive(const Uint8* row,
+                        const Uint8* prev,
+                        std::size_t size,
+                        std::size_t bpp,
+                        Uint8* out,
+                        Uint8* scratch)
+            noexcept
+        {
+            std::size_t best_sum = SIZE_MAX;
+            for (Uint8 type = 0; type < 5; ++type) {
+                filter(type, row, prev, size, bpp, scratch);
+                std::size_t sum = 0;
+                for (std::size_t i = 0; i < size && sum < best_sum; ++i)
+                    sum += std::abs(static_cast<Sint8>(scratch[i]));
+                if (sum < best_sum) {
+                    best_sum = sum;
+                    out[0] = type;
+                    std::memcpy(out + 1, scratch, size);
+                }
+            }
+        }
+
+
+        struct deflate_params {
+            int level;
+            int strategy;
+            Uint8 header_flags;
+        };
+
+
+        deflate_params
+        get_params(encoder::preset p)
+            noexcept
+        {
+            switch (p) {
+                case encoder::preset::fast:
+                    return {1, Z_DEFAULT_STRATEGY, 0x01};
+                case encoder::preset::best:
+                    return {9, Z_FILTERED, 0xda};
+                default:
+                    return {6, Z_FILTERED, 0x9c};
+            }
+        }
+
+    } // namespace
+
+#endif // HAVE_ZLIB
+
+
+    encoder::encoder(thread_pool& pool)
+        noexcept :
+        pool{&pool}
+    {}
+
+
+    encoder::~encoder()
+        noexcept
+    {
+        wait();
+    }
+
+
+    void
+    encoder::start(std::shared_ptr<job> j)
+    {
+        {
+            std::lock_guard guard{mutex};
+            ++in_flight;
+        }
+        try {
+            pool->submit([this, j] { prepare(j); });
+        }
+        catch (...) {
+            std::lock_guard guard{mutex};
+            if (--in_flight == 0)
+                idle_cv.notify_all();
+            throw;
+        }
+    }
+
+
+    void
+    encoder::prepare(const std::shared_ptr<job>& j)
+        noexcept
+    {
+#if SDL_IMAGE_VERSION_ATLEAST(2, 0, 2)
+        if (j->type == job::kind::jpg) {
+            finish(*j, try_save_jpg(j->src, j->dst, j->quality));
+            return;
+        }
+#endif
+
+#ifdef HAVE_ZLIB
+        try {
+            const int width = j->src.get_width();
+            const int height = j->src.get_height();
+            if (width <= 0 || height <= 0)
+                throw error{"img::encoder: empty surface"};
+
+            const SDL_Surface* raw = j->src.data();
+            const bool alpha = SDL_ISPIXELFORMAT_ALPHA(raw->format->format)
+                || SDL_HasColorKey(const_cast<SDL_Surface*>(raw));
+            const auto fmt = alpha
+                ? pixels::format_enum::rgba_32
+                : pixels::format_enum::rgb_24;
+            if (raw->format->format != static_cast<Uint32>(fmt) || j->src.must_lock())
+                j->src = surface{j->src, fmt};
+            j->bpp = alpha ? 4 : 3;
+            j->row_size = std::size_t(width) * j->bpp;
+
+            const std::size_t filtered_row = j->row_size + 1;
+            if (j->opt.band_rows > 0)
+                j->band_rows = j->opt.band_rows;
+            else {
+                // A few bands per thread, unless that makes them too small.
+                const std::size_t tasks = 4 * pool->size();
+                j->band_rows = std::max((min_band_size + filtered_row - 1) / filtered_row,
+                                        (height + tasks - 1) / tasks);
+            }
+            j->band_rows = std::min(j->band_rows, height);
+            j->bands.resize((height + j->band_rows - 1) / j->band_rows);
+
+            std::array<Uint8, 8 + 13> head;
+            std::memcpy(head.data(), "\x89PNG\r\n\x1a\n", 8);
+            Uint8* ihdr = head.data() + 8;
+            put_be32(ihdr, width);
+            put_be32(ihdr + 4, height);
+            ihdr[8] = 8; // bit depth
+            ihdr[9] = alpha ? 6 : 2; // RGBA or RGB
+            ihdr[10] = 0;
+            ihdr[11] = 0;
+            ihdr[12] = 0;
+            if (auto r = j->dst.try_write(head.data(), 1, 8); !r)
+                throw r.error();
+            if (auto r = write_chunk(j->dst, "IHDR", {ihdr, 13}); !r)
+                throw r.error();
+        }
+        catch (error& e) {
+            finish(*j, unexpected{std::move(e)});
+            return;
+        }
+        catch (std::exception& e) {
+            finish(*j, unexpected{error{e}});
+            return;
+        }
+
+        // This task compresses the first band; if a task can't be submitted, its band is
+        // compressed here too.
+        std::size_t submitted = 1;
+        try {
+            for (; submitted < j->bands.size(); ++submitted)
+                pool->submit([this, j, index = submitted] { run_band(j, index); });
+        }
+        catch (...) {}
+        run_band(j, 0);
+        for (std::size_t i = submitted; i < j->bands.size(); ++i)
+            run_band(j, i);
+#else
+        finish(*j, try_save_png(j->src, j->dst));
+#endif
+    }
+
+
+#ifdef HAVE_ZLIB
+
+    void
+    encoder::run_band(const std::shared_ptr<job>& j,
+                      std::size_t index)
+        noexcept
+    {
+        job::band& b = j->bands[index];
+        expected<void, error> result;
+
+        try {
+            const int height = j->src.get_height();
+            const int first = index * j->band_rows;
+            const int last = std::min(first + j->band_rows, height);
+            const std::size_t filtered_row = j->row_size + 1;
+
+            // Rows before the band are filtered too, to be used as the deflate dictionary.
+            const int dict_rows = std::min<int>(first,
+                                                (window_size + filtered_row - 1) / filtered_row);
+            const int start = first - dict_rows;
+
+            vector<Uint8> filtered((last - start) * filtered_row);
+            vector<Uint8> scratch;
+            const bool fast = j->opt.compression == preset::fast;
+            if (!fast)
+                scratch.resize(j->row_size);
+            const Uint8* pixels = j->src.get_pixels_as<Uint8>();
+            const int pitch = j->src.get_pitch();
+            for (int y = start; y < last; ++y) {
+                const Uint8* row = pixels + y * pitch;
+                const Uint8* prev = y > 0 ? row - pitch : nullptr;
+                Uint8* out = filtered.data() + (y - start) * filtered_row;
+                if (fast) {
+                    // Up is cheap, and works well enough with fast deflate.
+                    out[0] = 2;
+                    filter(2, row, prev, j->row_size, j->bpp, out + 1);
+                } else
+                    filter_adaptive(row, prev, j->row_size, j->bpp, out, scratch.data());
+            }
+
+            const Uint8* input = filtered.data() + dict_rows * filtered_row;
+            const std::size_t input_size = (last - first) * filtered_row;
+            const std::size_t dict_size = std::min(dict_rows * filtered_row, window_size);
+            b.size = input_size;
+            b.adler = adler32(1, input, input_size);
+
+            auto params = get_params(j->opt.compression);
+            z_stream zs{};
+            if (deflateInit2(&zs, params.level, Z_DEFLATED, -15, 8, params.strategy) != Z_OK)
+                throw error{"img::encoder: deflateInit2() failed"};
+            try {
+                if (dict_size)
+                    deflateSetDictionary(&zs, input - dict_size, dict_size);
+
+                // Chunk length, type, zlib header for the first band, and the CRC.
+                const std::size_t prefix = index == 0 ? 10 : 8;
+                b.chunk.resize(prefix + deflateBound(&zs, input_size) + 16);
+                std::memcpy(b.chunk.data() + 4, "IDAT", 4);
+                if (index == 0) {
+                    b.chunk[8] = 0x78;
+                    b.chunk[9] = params.header_flags;
+                }
+
+                zs.next_in = const_cast<Uint8*>(input);
+                zs.avail_in = input_size;
+                zs.next_out = b.chunk.data() + prefix;
+                zs.avail_out = b.chunk.size() - prefix - 4;
+                // Every band but the last ends on a byte boundary, so they can be joined.
+                const bool last_band = index + 1 == j->bands.size();
+                for (;;) {
+                    int r = deflate(&zs, last_band ? Z_FINISH : Z_SYNC_FLUSH);
+                    if (r == Z_STREAM_END || (r == Z_OK && !zs.avail_in && zs.avail_out))
+                        break;
+                    if (r != Z_OK && r != Z_BUF_ERROR)
+                        throw error{"img::encoder: deflate() failed"};
+                    std::size_t used = zs.next_out - b.chunk.data();
+                    b.chunk.resize(b.chunk.size() * 2);
+                    zs.next_out = b.chunk.data() + used;
+                    zs.avail_out = b.chunk.size() - used - 4;
+                }
+                std::size_t end = zs.next_out - b.chunk.data();
+                deflateEnd(&zs);
+
+                put_be32(b.chunk.data(), end - 8);
+                put_be32(b.chunk.data() + end, crc32(0, b.chunk.data() + 4, end - 4));
+                b.chunk.resize(end + 4);
+            }
+            catch (...) {
+                deflateEnd(&zs);
+                throw;
+            }
+        }
+        catch (error& e) {
+            result = unexpected{std::move(e)};
+        }
+        catch (std::exception& e) {
+            result = unexpected{error{e}};
+        }
+
+        // Write the bands that are ready, in order; only one task writes at a time.
+        std::unique_lock guard{j->mutex};
+        b.ready = true;
+        if (!result && !j->failure)
+            j->failure = std::move(result.error());
+        if (j->writing)
+            return;
+        j->writing = true;
+        while (j->next_write < j->bands.size() && j->bands[j->next_write].ready) {
+            job::band& w = j->bands[j->next_write++];
+            vector<Uint8> chunk = std::move(w.chunk);
+            const bool failed = j->failure.has_value();
+            if (!failed)
+                j->adler = adler32_combine(j->adler, w.adler, w.size);
+            guard.unlock();
+            expected<std::size_t, error> r = 0;
+            if (!failed)
+                r = j->dst.try_write(chunk.data(), 1, chunk.size());
+            chunk = {};
+            guard.lock();
+            if (!r && !j->failure)
+                j->failure = std::move(r.error());
+        }
+        j->writing = false;
+        if (j->next_write < j->bands.size())
+            return;
+
+        // All bands are written.
+        std::optional<error> failure = std::move(j->failure);
+        guard.unlock();
+        if (!failure) {
+            std::array<Uint8, 4> trailer;
+            put_be32(trailer.data(), j->adler);
+            auto r = write_chunk(j->dst, "IDAT", trailer);
+            if (r)
+                r = write_chunk(j->dst, "IEND", {});
+            if (!r)
+                failure = std::move(r.error());
+        }
+        if (failure)
+            finish(*j, unexpected{std::move(*failure)});
+        else
+            finish(*j, {});
+    }
+
+#endif // HAVE_ZLIB
+
+
+    void
+    encoder::finish(job& j,
+                    expected<void, error> result)
+        noexcept
+    {
+        // Closing may flush the data.
+        if (j.dst.is_valid())
+            if (SDL_RWclose(j.dst.release()) < 0 && result)
+                result = unexpected{error{}};
+        j.src = surface{nullptr, surface::dont_destroy};
+
+        done_function done = std::move(j.done);
+        if (done) {
+            try {
+                done(std::move(result));
+            }
+            catch (...) {}
+        }
+
+        std::lock_guard guard{mutex};
+        if (--in_flight == 0)
+            idle_cv.notify_all();
+    }
+
+
+    void
+    encoder::save_png(surface src,
+                      rwops&& dst,
+                      done_function done)
+    {
+        save_png(std::move(src), std::move(dst), png_options{}, std::move(done));
+    }
+
+
+    void
+    encoder::save_png(surface src,
+                      rwops&& dst,
+                      const png_options& opt,
+                      done_function done)
+    {
+        start(std::make_shared<job>(job::kind::png,
+                                    std::move(src),
+                                    std::move(dst),
+                                    std::move(done),
+                                    opt,
+                                    0));
+    }
+
+
+    std::future<void>
+    encoder::save_png(surface src,
+                      rwops&& dst)
+    {
+        return save_png(std::move(src), std::move(dst), png_options{});
+    }
+
+
+    std::future<void>
+    encoder::save_png(surface src,
+                      rwops&& dst,
+                      const png_options& opt)
+    {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto result = promise->get_future();
+        save_png(std::move(src),
+                 std::move(dst),
+                 opt,
+                 [promise](expected<void, error> value)
+                 {
+                     if (value)
+                         promise->set_value();
+                     else
+                         promise->set_exception(std::make_exception_ptr(value.error()));
+                 });
+        return result;
+    }
+
+
+#if SDL_IMAGE_VERSION_ATLEAST(2, 0, 2)
+
+    void
+    encoder::save_jpg(surface src,
+                      rwops&& dst,
+                      int quality,
+                      done_function done)
+    {
+        start(std::make_shared<job>(job::kind::jpg,
+                                    std::move(src),
+                                    std::move(dst),
+                                    std::move(done),
+                                    png_options{},
+                                    quality));
+    }
+
+
+    std::future<void>
+    encoder::save_jpg(surface src,
+                      rwops&& dst,
+                      int quality)
+    {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto result = promise->get_future();
+        save_jpg(std::move(src),
+                 std::move(dst),
+                 quality,
+                 [promise](expected<void, error> value)
+                 {
+                     if (value)
+                         promise->set_value();
+                     else
+                         promise->set_exception(std::make_exception_ptr(value.error()));
+                 });
+        return result;
+    }
+
+#endif // SDL_IMAGE_VERSION_ATLEAST(2, 0, 2)
+
+
+    void
+    encoder::wait()
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        idle_cv.wait(guard, [this] { return in_flight == 0; });
+    }
+
+
+    std::size_t
+    encoder::get_pending()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return in_flight;
+    }
+
+} // namespace sdl::img
@@ -0,0 +1,320 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "img_loader.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::img {
+
+    namespace {
+
+        std::size_t
+        size_of(const surface& surf)
+            noexcept
+        {
+            return static_cast<std::size_t>(surf.get_pitch()) * surf.get_height();
+        }
+
+
+        // Takes the surface by value, so its pixels are freed on return.
+        expected<texture, error>
+        upload(renderer& ren,
+               expected<surface, error> surf)
+            noexcept
+        {
+            if (!surf)
+                return unexpected{std::move(surf.error())};
+            try {
+                return texture{ren, *surf};
+            }
+            catch (error& e) {
+                return unexpected{std::move(e)};
+            }
+            catch (std::exception& e) {
+                return unexpected{error{e}};
+            }
+        }
+
+    } // namespace
+
+
+    loader::loader(thread_pool& pool,
+                   std::size_t upload_budget)
+        noexcept :
+        pool{&pool},
+        upload_budget{upload_budget}
+    {}
+
+
+    loader::~loader()
+        noexcept
+    {
+        cancel_all();
+        std::unique_lock guard{mutex};
+        idle_cv.wait(guard, [this] { return in_flight == 0; });
+    }
+
+
+    expected<surface, error>
+    loader::decode(source& src)
+        noexcept
+    {
+        if (src.archive) {
+            auto r = src.archive->try_open(src.name);
+            if (!r)
+                return unexpected{std::move(r.error())};
+            return try_load(*r);
+        }
+        if (src.src)
+            return try_load(*src.src);
+        return try_load(src.filename);
+    }
+
+
+    loader::request_id
+    loader::enqueue(source src,
+                    ready_function func,
+                    int priority)
+    {
+        std::lock_guard guard{mutex};
+        request_id id = ++next_id;
+        request& req = requests[id];
+        req.priority = priority;
+        req.func = std::move(func);
+        req.src = std::move(src);
+        try {
+            req.task = pool->submit([this, id] { run(id); }, priority);
+        }
+        catch (...) {
+            requests.erase(id);
+            throw;
+        }
+        ++in_flight;
+        return id;
+    }
+
+
+    loader::pending
+    loader::enqueue(source src,
+                    int priority)
+    {
+        auto promise = std::make_shared<std::promise<texture>>();
+        pending result{0, promise->get_future()};
+        result.id = enqueue(std::move(src),
+                            [promise](expected<texture, error> value)
+                            {
+                                if (value)
+                                    promise->set_value(std::move(*value));
+                                else
+                                    promise->set_exception(std::make_exception_ptr(value.error()));
+                            },
+                            priority);
+        return result;
+    }
+
+
+    void
+    loader::run(request_id id)
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        auto it = requests.find(id);
+        if (it != requests.end()) {
+            source src = std::move(it->second.src);
+            guard.unlock();
+            auto value = decode(src);
+            guard.lock();
+            it = requests.find(id);
+            if (it != requests.end()) {
+                try {
+                    ready.push_back({id, it->second.priority, std::move(value)});
+                }
+                catch (...) {
+                    // Out of memory: the request is lost.
+                    requests.erase(it);
+                }
+            }
+        }
+        if (--in_flight == 0)
+            idle_cv.notify_all();
+    }
+
+
+    loader::request_id
+    loader::load(const path& filename,
+                 ready_function func,
+                 int priority)
+    {
+        return enqueue(source{filename, nullptr, {}, {}}, std::move(func), priority);
+    }
+
+
+    loader::request_id
+    loader::load(rwops&& src,
+                 ready_function func,
+                 int priority)
+    {
+        return enqueue(source{{}, nullptr, {}, std::move(src)}, std::move(func), priority);
+    }
+
+
+    loader::request_id
+    loader::load(const pack::archive& archive,
+                 std::string_view name,
+                 ready_function func,
+                 int priority)
+    {
+        return enqueue(source{{}, &archive, string{name}, {}}, std::move(func), priority);
+    }
+
+
+    loader::pending
+    loader::load(const path& filename,
+                 int priority)
+    {
+        return enqueue(source{filename, nullptr, {}, {}}, priority);
+    }
+
+
+    loader::pending
+    loader::load(rwops&& src,
+                 int priority)
+    {
+        return enqueue(source{{}, nullptr, {}, std::move(src)}, priority);
+    }
+
+
+    loader::pending
+    loader::load(const pack::archive& archive,
+                 std::string_view name,
+                 int priority)
+    {
+        return enqueue(source{{}, &archive, string{name}, {}}, priority);
+    }
+
+
+    bool
+    loader::cancel(request_id id)
+        noexcept
+    {
+        request req;
+        {
+            std::lock_guard guard{mutex};
+            auto it = requests.find(id);
+            if (it == requests.end())
+                return false;
+            req = std::move(it->second);
+            requests.erase(it);
+            if (pool->cancel(req.task))
+                --in_flight;
+            std::erase_if(ready, [id](const decoded& d) { return d.id == id; });
+            if (in_flight == 0)
+                idle_cv.notify_all();
+        }
+        // The callback is destroyed outside the lock.
+        return true;
+    }
+
+
+    void
+    loader::cancel_all()
+        noexcept
+    {
+        std::unordered_map<request_id, request> dropped;
+        {
+            std::lock_guard guard{mutex};
+            for (auto& [id, req] : requests)
+                if (pool->cancel(req.task))
+                    --in_flight;
+            dropped.swap(requests);
+            ready.clear();
+            if (in_flight == 0)
+                idle_cv.notify_all();
+        }
+    }
+
+
+    std::size_t
+    loader::update(renderer& ren)
+    {
+        vector<decoded> batch;
+        vector<ready_function> funcs;
+        {
+            std::lock_guard guard{mutex};
+            if (ready.empty())
+                return 0;
+            std::ranges::stable_sort(ready,
+                                     [](const decoded& a, const decoded& b)
+                                     {
+                                         return a.priority > b.priority;
+                                     });
+            std::size_t used = 0;
+            std::size_t taken = 0;
+            for (auto& d : ready) {
+                std::size_t bytes = d.value ? size_of(*d.value) : 0;
+                if (taken > 0 && used + bytes > upload_budget)
+                    break;
+                used += bytes;
+                ++taken;
+            }
+            batch.reserve(taken);
+            funcs.reserve(taken);
+            for (std::size_t i = 0; i < taken; ++i) {
+                auto it = requests.find(ready[i].id);
+                funcs.push_back(std::move(it->second.func));
+                requests.erase(it);
+                batch.push_back(std::move(ready[i]));
+            }
+            ready.erase(ready.begin(), ready.begin() + taken);
+        }
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            auto value = upload(ren, std::move(batch[i].value));
+            if (funcs[i])
+                funcs[i](std::move(value));
+        }
+        return batch.size();
+    }
+
+
+    void
+    loader::set_upload_budget(std::size_t bytes)
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        upload_budget = bytes;
+    }
+
+
+    std::size_t
+    loader::get_upload_budget()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return upload_budget;
+    }
+
+
+    std::size_t
+    loader::get_pending()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return requests.size();
+    }
+
+} // namespace sdl::img
@@ -0,0 +1,358 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include <SDL_error.h>
+
+#include "memory_rwops.hpp"
+
+#include "allocator.hpp"
+#include "unique_ptr.hpp"
+
+
+namespace sdl {
+
+    namespace {
+
+        constexpr std::size_t min_capacity = 256;
+
+
+        struct memory_state {
+
+            Uint8* data = nullptr;
+            std::size_t size = 0;
+            std::size_t capacity = 0;
+            std::size_t pos = 0;
+
+            // Owned buffers grow; views don't.
+            bool owned = true;
+            bool read_only = false;
+
+
+            memory_state()
+                noexcept = default;
+
+
+            ~memory_state()
+                noexcept
+            {
+                if (owned)
+                    malloc_allocator::deallocate(data);
+            }
+
+
+            void
+            reserve(std::size_t new_capacity)
+            {
+                if (new_capacity <= capacity)
+                    return;
+                data = malloc_allocator::reallocate_as<Uint8*>(data, new_capacity);
+                capacity = new_capacity;
+            }
+
+
+            // Make room for `end` bytes, growing geometrically; returns false if it can't.
+            bool
+            ensure(std::size_t end)
+                noexcept
+            {
+                if (end <= capacity)
+                    return true;
+                if (!owned)
+                    return false;
+                try {
+                    reserve(std::max({end, capacity + capacity / 2, min_capacity}));
+                    return true;
+                }
+                catch (std::bad_alloc&) {
+                    return false;
+                }
+            }
+
+
+            Sint64
+            seek(Sint64 offset,
+                 int whence)
+                noexcept
+            {
+                Sint64 target;
+                switch (whence) {
+                    case RW_SEEK_SET:
+                        target = offset;
+                        break;
+                    case RW_SEEK_CUR:
+                        target = static_cast<Sint64>(pos) + offset;
+                        break;
+                    case RW_SEEK_END:
+                        target = static_cast<Sint64>(size) + offset;
+                        break;
+                    default:
+                        return SDL_SetError("memory_seek(): unknown value for 'whence'");
+                }
+                if (target < 0)
+                    return SDL_Error(SDL_EFSEEK);
+                // Like SDL's memory rwops, views can't seek past the end.
+                if (!owned && static_cast<Uint64>(target) > size)
+                    target = size;
+                pos = target;
+                return target;
+            }
+
+
+            std::size_t
+            read(Uint8* dst,
+                 std::size_t count)
+                noexcept
+            {
+                if (pos >= size)
+                    return 0;
+                std::size_t n = std::min(count, size - pos);
+                std::memcpy(dst, data + pos, n);
+                pos += n;
+                return n;
+            }
+
+
+            std::size_t
+            write(const Uint8* src,
+                  std::size_t count)
+                noexcept
+            {
+                if (read_only) {
+                    SDL_SetError("memory_rwops is read-only");
+                    return 0;
+                }
+                if (count > SIZE_MAX - pos || !ensure(pos + count)) {
+                    if (owned) {
+                        SDL_OutOfMemory();
+                        return 0;
+                    }
+                    // Fixed views get a short write.
+                    SDL_Error(SDL_EFWRITE);
+                    count = pos < capacity ? capacity - pos : 0;
+                }
+                // Seeking past the end leaves a gap that reads as zeros.
+                if (pos > size)
+                    std::memset(data + size, 0, pos - size);
+                std::memcpy(data + pos, src, count);
+                pos += count;
+                size = std::max(size, pos);
+                return count;
+            }
+
+        }; // struct memory_state
+
+
+        memory_state*
+        get_state(SDL_RWops* ctx)
+            noexcept
+        {
+            return static_cast<memory_state*>(ctx->hidden.unknown.data1);
+        }
+
+
+        Sint64
+        memory_size(SDL_RWops* ctx)
+            noexcept
+        {
+            return get_state(ctx)->size;
+        }
+
+
+        Sint64
+        memory_seek(SDL_RWops* ctx,
+                    Sint64 offset,
+                    int whence)
+            noexcept
+        {
+            return get_state(ctx)->seek(offset, whence);
+        }
+
+
+        std::size_t
+        memory_read(SDL_RWops* ctx,
+                    void* buf,
+                    std::size_t elem_size,
+                    std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto state = get_state(ctx);
+            // Only whole elements are read.
+            std::size_t avail = state->pos < state->size ? state->size - state->pos : 0;
+            count = std::min(count, avail / elem_size);
+            state->read(static_cast<Uint8*>(buf), count * elem_size);
+            return count;
+        }
+
+
+        std::size_t
+        memory_write(SDL_RWops* ctx,
+                     const void* buf,
+                     std::size_t elem_size,
+                     std::size_t count)
+            noexcept
+        {
+            if (!elem_size || !count)
+                return 0;
+            auto w = get_state(ctx)->write(static_cast<const Uint8*>(buf), elem_size * count);
+            return w / elem_size;
+        }
+
+
+        int
+        memory_close(SDL_RWops* ctx)
+            noexcept
+        {
+            unique_ptr<memory_state> state{get_state(ctx)};
+            SDL_FreeRW(ctx);
+            return 0;
+        }
+
+
+        SDL_RWops*
+        make_rwops(unique_ptr<memory_state> state)
+        {
+            auto new_raw = SDL_AllocRW();
+            if (!new_raw)
+                throw error{};
+
+            new_raw->size = memory_size;
+            new_raw->seek = memory_seek;
+            new_raw->read = memory_read;
+            new_raw->write = memory_write;
+            new_raw->close = memory_close;
+            new_raw->type = SDL_RWOPS_UNKNOWN;
+            new_raw->hidden.unknown.data1 = state.release();
+            return new_raw;
+        }
+
+    } // namespace
+
+
+    memory_rwops::memory_rwops(std::size_t capacity)
+    {
+        create(capacity);
+    }
+
+
+    memory_rwops::memory_rwops(blob data)
+    {
+        create(std::move(data));
+    }
+
+
+    memory_rwops::memory_rwops(std::span<Uint8> mem)
+    {
+        create(mem);
+    }
+
+
+    memory_rwops::memory_rwops(std::span<const Uint8> mem)
+    {
+        create(mem);
+    }
+
+
+    void
+    memory_rwops::create(std::size_t capacity)
+    {
+        auto state = make_unique<memory_state>();
+        state->reserve(capacity);
+        auto new_raw = make_rwops(std::move(state));
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    memory_rwops::create(blob data)
+    {
+        auto state = make_unique<memory_state>();
+        state->size = state->capacity = data.data().size();
+        state->data = data.ptr.release();
+        auto new_raw = make_rwops(std::move(state));
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    memory_rwops::create(std::span<Uint8> mem)
+    {
+        auto state = make_unique<memory_state>();
+        state->data = mem.data();
+        state->size = state->capacity = mem.size();
+        state->owned = false;
+        auto new_raw = make_rwops(std::move(state));
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    memory_rwops::create(std::span<const Uint8> mem)
+    {
+        auto state = make_unique<memory_state>();
+        state->data = const_cast<Uint8*>(mem.data());
+        state->size = state->capacity = mem.size();
+        state->owned = false;
+        state->read_only = true;
+        auto new_raw = make_rwops(std::move(state));
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    std::span<const Uint8>
+    memory_rwops::get_data()
+        const noexcept
+    {
+        auto state = get_state(raw);
+        return {state->data, state->size};
+    }
+
+
+    std::size_t
+    memory_rwops::get_capacity()
+        const noexcept
+    {
+        return get_state(raw)->capacity;
+    }
+
+
+    void
+    memory_rwops::reserve(std::size_t capacity)
+    {
+        auto state = get_state(raw);
+        if (!state->owned)
+            throw error{"memory_rwops: can't grow a view"};
+        state->reserve(capacity);
+    }
+
+
+    blob
+    memory_rwops::release_blob()
+    {
+        auto state = get_state(raw);
+        if (!state->owned)
+            throw error{"memory_rwops: can't release a view"};
+        if (!state->size)
+            return blob{nullptr, 0};
+        blob result{std::exchange(state->data, nullptr), state->size};
+        state->size = state->capacity = state->pos = 0;
+        return result;
+    }
+
+} // namespace sdl
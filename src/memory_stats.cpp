@@ -0,0 +1,337 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+
+#include <SDL_error.h>
+
+#include "memory_stats.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::memory {
+
+    namespace {
+
+        struct counters {
+
+            std::atomic<Uint64> allocations{0};
+            std::atomic<Uint64> deallocations{0};
+            std::atomic<Uint64> reallocations{0};
+            std::atomic<Uint64> bytes_allocated{0};
+            std::atomic<Uint64> bytes_in_use{0};
+            std::atomic<Uint64> peak_bytes{0};
+            std::atomic<Uint64> budget{0};
+            std::atomic<Uint64> over_budget{0};
+            std::array<std::atomic<Uint64>, num_size_classes> size_classes{};
+
+
+            void
+            grow(std::size_t size)
+                noexcept
+            {
+                auto in_use = bytes_in_use.fetch_add(size, std::memory_order_relaxed) + size;
+                auto peak = peak_bytes.load(std::memory_order_relaxed);
+                while (in_use > peak
+                       && !peak_bytes.compare_exchange_weak(peak, in_use,
+                                                            std::memory_order_relaxed))
+                    ;
+                auto limit = budget.load(std::memory_order_relaxed);
+                if (limit && in_use > limit)
+                    over_budget.fetch_add(1, std::memory_order_relaxed);
+            }
+
+
+            void
+            shrink(std::size_t size)
+                noexcept
+            {
+                bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+            }
+
+
+            void
+            on_allocate(std::size_t size)
+                noexcept
+            {
+                allocations.fetch_add(1, std::memory_order_relaxed);
+                bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+                auto cls = std::min<std::size_t>(std::bit_width(size), num_size_classes - 1);
+                size_classes[cls].fetch_add(1, std::memory_order_relaxed);
+                grow(size);
+            }
+
+
+            void
+            on_deallocate(std::size_t size)
+                noexcept
+            {
+                deallocations.fetch_add(1, std::memory_order_relaxed);
+                shrink(size);
+            }
+
+
+            void
+            on_reallocate(std::size_t old_size,
+                          std::size_t new_size)
+                noexcept
+            {
+                reallocations.fetch_add(1, std::memory_order_relaxed);
+                if (new_size > old_size) {
+                    bytes_allocated.fetch_add(new_size - old_size, std::memory_order_relaxed);
+                    grow(new_size - old_size);
+                } else
+                    shrink(old_size - new_size);
+            }
+
+
+            stats
+            load()
+                const noexcept
+            {
+                stats s;
+                s.allocations     = allocations.load(std::memory_order_relaxed);
+                s.deallocations   = deallocations.load(std::memory_order_relaxed);
+                s.reallocations   = reallocations.load(std::memory_order_relaxed);
+                s.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+                s.bytes_in_use    = bytes_in_use.load(std::memory_order_relaxed);
+                s.peak_bytes      = peak_bytes.load(std::memory_order_relaxed);
+                s.budget          = budget.load(std::memory_order_relaxed);
+                s.over_budget     = over_budget.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < num_size_classes; ++i)
+                    s.size_classes[i] = size_classes[i].load(std::memory_order_relaxed);
+                return s;
+            }
+
+        }; // struct counters
+
+
+        counters total_counters;
+        std::array<counters, num_tags> tag_counters;
+
+        thread_local tag current_tag = tag::none;
+
+        std::atomic_bool tracking{false};
+
+        SDL_malloc_func  real_malloc  = nullptr;
+        SDL_calloc_func  real_calloc  = nullptr;
+        SDL_realloc_func real_realloc = nullptr;
+        SDL_free_func    real_free    = nullptr;
+
+
+        // Stored in front of every tracked allocation; keeps the payload aligned.
+        struct alignas(std::max_align_t) header {
+            std::size_t size;
+            tag owner;
+        };
+
+
+        void
+        record_allocate(tag t,
+                        std::size_t size)
+            noexcept
+        {
+            total_counters.on_allocate(size);
+            tag_counters[static_cast<unsigned>(t)].on_allocate(size);
+        }
+
+
+        void*
+        finish_allocate(void* raw,
+                        std::size_t size)
+            noexcept
+        {
+            if (!raw)
+                return nullptr;
+            auto h = static_cast<header*>(raw);
+            h->size = size;
+            h->owner = current_tag;
+            record_allocate(h->owner, size);
+            return h + 1;
+        }
+
+
+        void*
+        SDLCALL
+        tracked_malloc(std::size_t size)
+        {
+            if (size > SIZE_MAX - sizeof(header))
+                return nullptr;
+            return finish_allocate(real_malloc(sizeof(header) + size), size);
+        }
+
+
+        void*
+        SDLCALL
+        tracked_calloc(std::size_t count,
+                       std::size_t size)
+        {
+            if (size && count > (SIZE_MAX - sizeof(header)) / size)
+                return nullptr;
+            std::size_t total = count * size;
+            return finish_allocate(real_calloc(1, sizeof(header) + total), total);
+        }
+
+
+        void*
+        SDLCALL
+        tracked_realloc(void* ptr,
+                        std::size_t size)
+        {
+            if (!ptr)
+                return tracked_malloc(size);
+            if (size > SIZE_MAX - sizeof(header))
+                return nullptr;
+            auto h = static_cast<header*>(ptr) - 1;
+            std::size_t old_size = h->size;
+            tag owner = h->owner;
+            auto new_h = static_cast<header*>(real_realloc(h, sizeof(header) + size));
+            if (!new_h)
+                return nullptr;
+            new_h->size = size;
+            total_counters.on_reallocate(old_size, size);
+            tag_counters[static_cast<unsigned>(owner)].on_reallocate(old_size, size);
+            return new_h + 1;
+        }
+
+
+        void
+        SDLCALL
+        tracked_free(void* ptr)
+        {
+            if (!ptr)
+                return;
+            auto h = static_cast<header*>(ptr) - 1;
+            total_counters.on_deallocate(h->size);
+            tag_counters[static_cast<unsigned>(h->owner)].on_deallocate(h->size);
+            real_free(h);
+        }
+
+
+        void
+        reset_peak(counters& c)
+            noexcept
+        {
+            c.peak_bytes.store(c.bytes_in_use.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+        }
+
+    } // namespace
+
+
+    const stats&
+    snapshot::operator [](tag t)
+        const noexcept
+    {
+        return tags[static_cast<unsigned>(t)];
+    }
+
+
+    void
+    start_tracking()
+    {
+        auto result = try_start_tracking();
+        if (!result)
+            throw result.error();
+    }
+
+
+    expected<void, error>
+    try_start_tracking()
+        noexcept
+    {
+        static std::mutex mutex;
+        std::lock_guard guard{mutex};
+
+        if (tracking)
+            return {};
+
+        // Memory allocated before the wrappers were installed has no header.
+        if (SDL_GetNumAllocations() > 0)
+            return unexpected{error{"memory::start_tracking(): SDL already allocated memory"}};
+
+        SDL_GetMemoryFunctions(&real_malloc, &real_calloc, &real_realloc, &real_free);
+        if (SDL_SetMemoryFunctions(tracked_malloc,
+                                   tracked_calloc,
+                                   tracked_realloc,
+                                   tracked_free) < 0)
+            return unexpected{error{}};
+        tracking = true;
+        return {};
+    }
+
+
+    bool
+    is_tracking()
+        noexcept
+    {
+        return tracking;
+    }
+
+
+    snapshot
+    get_snapshot()
+        noexcept
+    {
+        snapshot result;
+        result.total = total_counters.load();
+        for (std::size_t i = 0; i < num_tags; ++i)
+            result.tags[i] = tag_counters[i].load();
+        return result;
+    }
+
+
+    void
+    reset_peaks()
+        noexcept
+    {
+        reset_peak(total_counters);
+        for (auto& c : tag_counters)
+            reset_peak(c);
+    }
+
+
+    void
+    set_budget(tag t,
+               Uint64 bytes)
+        noexcept
+    {
+        tag_counters[static_cast<unsigned>(t)].budget.store(bytes, std::memory_order_relaxed);
+    }
+
+
+    tag
+    get_tag()
+        noexcept
+    {
+        return current_tag;
+    }
+
+
+    tag_scope::tag_scope(tag t)
+        noexcept :
+        previous{current_tag}
+    {
+        current_tag = t;
+    }
+
+
+    tag_scope::~tag_scope()
+        noexcept
+    {
+        current_tag = previous;
+    }
+
+} // namespace sdl::memory
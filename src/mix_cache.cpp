@@ -0,0 +1,416 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "mix_cache.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::mix {
+
+    std::size_t
+    sound_cache::key_hash::operator ()(std::string_view key)
+        const noexcept
+    {
+        return std::hash<std::string_view>{}(key);
+    }
+
+
+    sound_cache::sound_cache(std::size_t budget) :
+        budget{budget}
+    {}
+
+
+    sound_cache::~sound_cache()
+        noexcept
+    {
+        {
+            std::lock_guard guard{mutex};
+            stop = true;
+        }
+        jobs_cv.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+
+
+    string
+    sound_cache::make_key(const path& filename)
+    {
+        auto name = filename.lexically_normal().generic_string();
+        string key = "file:";
+        key.append(name.data(), name.size());
+        return key;
+    }
+
+
+    string
+    sound_cache::make_key(const pack::archive& archive,
+                          std::string_view name)
+    {
+        char prefix[32];
+        std::snprintf(prefix, sizeof prefix, "pack:%p:", static_cast<const void*>(&archive));
+        string key = prefix;
+        key.append(name.data(), name.size());
+        return key;
+    }
+
+
+    expected<sound_cache::handle, error>
+    sound_cache::decode(const source& src)
+        noexcept
+    {
+        try {
+            if (src.archive) {
+                rwops r = src.archive->open(src.name);
+                return std::make_shared<chunk>(r);
+            }
+            return std::make_shared<chunk>(src.filename);
+        }
+        catch (error& e) {
+            return unexpected{std::move(e)};
+        }
+        catch (std::exception& e) {
+            return unexpected{error{e}};
+        }
+    }
+
+
+    expected<sound_cache::handle, error>
+    sound_cache::try_get(string key,
+                         const source& src)
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.pending) {
+            auto queued = std::ranges::find(jobs, key, &job::key);
+            if (queued != jobs.end()) {
+                // The worker didn't start on it yet, so decode it here instead of waiting.
+                jobs.erase(queued);
+                guard.unlock();
+                auto value = decode(src);
+                finish(key, value);
+                return value;
+            }
+            decoded_cv.wait(guard,
+                            [&]
+                            {
+                                it = entries.find(key);
+                                return it == entries.end() || !it->second.pending;
+                            });
+        }
+        if (it != entries.end()) {
+            ++counters.hits;
+            it->second.last_use = ++clock;
+            return it->second.sound;
+        }
+
+        ++counters.misses;
+        try {
+            entries[key].pending = true;
+        }
+        catch (std::exception& e) {
+            return unexpected{error{e}};
+        }
+        guard.unlock();
+        auto value = decode(src);
+        finish(key, value);
+        return value;
+    }
+
+
+    void
+    sound_cache::get_async(string key,
+                           source src,
+                           ready_function func)
+    {
+        std::lock_guard guard{mutex};
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            if (it->second.pending) {
+                it->second.waiters.push_back(std::move(func));
+                return;
+            }
+            ++counters.hits;
+            it->second.last_use = ++clock;
+            results.push_back({std::move(func), it->second.sound});
+            return;
+        }
+
+        ++counters.misses;
+        entry& e = entries[key];
+        e.pending = true;
+        e.waiters.push_back(std::move(func));
+        jobs.push_back({std::move(key), std::move(src)});
+        if (!worker.joinable())
+            worker = std::thread{&sound_cache::run, this};
+        jobs_cv.notify_one();
+    }
+
+
+    void
+    sound_cache::finish(const string& key,
+                        expected<handle, error> value)
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        auto it = entries.find(key);
+        if (it == entries.end())
+            return;
+        auto waiters = std::move(it->second.waiters);
+        if (value) {
+            entry& e = it->second;
+            e.sound = *value;
+            e.bytes = (*value)->data()->alen;
+            e.pending = false;
+            e.last_use = ++clock;
+            memory += e.bytes;
+        } else {
+            // Forget the failure, so a later load tries again.
+            entries.erase(it);
+        }
+        try {
+            for (auto& func : waiters)
+                results.push_back({std::move(func), value});
+        }
+        catch (...) {
+            // Out of memory: the callbacks are lost.
+        }
+        decoded_cv.notify_all();
+        trim();
+    }
+
+
+    void
+    sound_cache::run()
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        for (;;) {
+            jobs_cv.wait(guard, [this] { return stop || !jobs.empty(); });
+            if (stop)
+                return;
+            job j = std::move(jobs.front());
+            jobs.pop_front();
+            guard.unlock();
+            finish(j.key, decode(j.src));
+            guard.lock();
+        }
+    }
+
+
+    void
+    sound_cache::trim()
+        noexcept
+    {
+        while (memory > budget) {
+            auto victim = entries.end();
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                const entry& e = it->second;
+                if (e.pending || e.sound.use_count() > 1)
+                    continue;
+                if (victim == entries.end() || e.last_use < victim->second.last_use)
+                    victim = it;
+            }
+            if (victim == entries.end())
+                return;
+            memory -= victim->second.bytes;
+            entries.erase(victim);
+            ++counters.evictions;
+        }
+    }
+
+
+    sound_cache::handle
+    sound_cache::load(const path& filename)
+    {
+        auto result = try_load(filename);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<sound_cache::handle, error>
+    sound_cache::try_load(const path& filename)
+        noexcept
+    {
+        try {
+            return try_get(make_key(filename), source{filename, nullptr, {}});
+        }
+        catch (std::exception& e) {
+            return unexpected{error{e}};
+        }
+    }
+
+
+    sound_cache::handle
+    sound_cache::load(const pack::archive& archive,
+                      std::string_view name)
+    {
+        auto result = try_load(archive, name);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<sound_cache::handle, error>
+    sound_cache::try_load(const pack::archive& archive,
+                          std::string_view name)
+        noexcept
+    {
+        try {
+            return try_get(make_key(archive, name),
+                           source{{}, &archive, string{name}});
+        }
+        catch (std::exception& e) {
+            return unexpected{error{e}};
+        }
+    }
+
+
+    void
+    sound_cache::load_async(const path& filename,
+                            ready_function func)
+    {
+        get_async(make_key(filename), source{filename, nullptr, {}}, std::move(func));
+    }
+
+
+    void
+    sound_cache::load_async(const pack::archive& archive,
+                            std::string_view name,
+                            ready_function func)
+    {
+        get_async(make_key(archive, name),
+                  source{{}, &archive, string{name}},
+                  std::move(func));
+    }
+
+
+    std::size_t
+    sound_cache::update()
+    {
+        vector<result> ready;
+        {
+            std::lock_guard guard{mutex};
+            ready.swap(results);
+        }
+        const std::size_t count = ready.size();
+        for (auto& r : ready)
+            if (r.func)
+                r.func(std::move(r.value));
+        // The callbacks may have dropped their handles.
+        ready.clear();
+        std::lock_guard guard{mutex};
+        trim();
+        return count;
+    }
+
+
+    sound_cache::handle
+    sound_cache::find(const path& filename)
+    {
+        auto key = make_key(filename);
+        std::lock_guard guard{mutex};
+        auto it = entries.find(key);
+        if (it == entries.end() || it->second.pending)
+            return {};
+        ++counters.hits;
+        it->second.last_use = ++clock;
+        return it->second.sound;
+    }
+
+
+    sound_cache::handle
+    sound_cache::find(const pack::archive& archive,
+                      std::string_view name)
+    {
+        auto key = make_key(archive, name);
+        std::lock_guard guard{mutex};
+        auto it = entries.find(key);
+        if (it == entries.end() || it->second.pending)
+            return {};
+        ++counters.hits;
+        it->second.last_use = ++clock;
+        return it->second.sound;
+    }
+
+
+    void
+    sound_cache::purge()
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        std::erase_if(entries,
+                      [this](const auto& kv)
+                      {
+                          const entry& e = kv.second;
+                          if (e.pending || e.sound.use_count() > 1)
+                              return false;
+                          memory -= e.bytes;
+                          ++counters.evictions;
+                          return true;
+                      });
+    }
+
+
+    void
+    sound_cache::set_budget(std::size_t bytes)
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        budget = bytes;
+        trim();
+    }
+
+
+    std::size_t
+    sound_cache::get_budget()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return budget;
+    }
+
+
+    std::size_t
+    sound_cache::get_memory()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return memory;
+    }
+
+
+    std::size_t
+    sound_cache::size()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return entries.size();
+    }
+
+
+    sound_cache::stats
+    sound_cache::get_stats()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return counters;
+    }
+
+} // namespace sdl::mix
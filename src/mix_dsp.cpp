@@ -0,0 +1,1137 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#include <SDL_cpuinfo.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SDL2XX_MIX_DSP_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define SDL2XX_MIX_DSP_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "mix_dsp.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::mix {
+
+    namespace {
+
+        struct kernels {
+            void (*s16_to_float)(const Sint16* src, float* dst, std::size_t n) noexcept;
+            void (*float_to_s16)(const float* src, Sint16* dst, std::size_t n) noexcept;
+            // dst += src * g
+            void (*add_scaled)(float* dst, const float* src, std::size_t n, float g) noexcept;
+        };
+
+
+        void
+        s16_to_float_scalar(const Sint16* src,
+                            float* dst,
+                            std::size_t n)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                dst[i] = src[i] * (1.0f / 32768);
+        }
+
+
+        void
+        float_to_s16_scalar(const float* src,
+                            Sint16* dst,
+                            std::size_t n)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                dst[i] = std::lrint(std::clamp(src[i] * 32768.0f, -32768.0f, 32767.0f));
+        }
+
+
+        void
+        add_scaled_scalar(float* dst,
+                          const float* src,
+                          std::size_t n,
+                          float g)
+            noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                dst[i] += src[i] * g;
+        }
+
+
+#ifdef SDL2XX_MIX_DSP_AVX2
+
+        __attribute__((target("avx2")))
+        void
+        s16_to_float_avx2(const Sint16* src,
+                          float* dst,
+                          std::size_t n)
+            noexcept
+        {
+            const __m256 scale = _mm256_set1_ps(1.0f / 32768);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+                _mm256_storeu_ps(dst + i, _mm256_mul_ps(f, scale));
+            }
+            s16_to_float_scalar(src + i, dst + i, n - i);
+        }
+
+
+        __attribute__((target("avx2")))
+        void
+        float_to_s16_avx2(const float* src,
+                          Sint16* dst,
+                          std::size_t n)
+            noexcept
+        {
+            const __m256 scale = _mm256_set1_ps(32768.0f);
+            const __m256 lo = _mm256_set1_ps(-32768.0f);
+            const __m256 hi = _mm256_set1_ps(32767.0f);
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+                __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+                a = _mm256_min_ps(_mm256_max_ps(a, lo), hi);
+                b = _mm256_min_ps(_mm256_max_ps(b, lo), hi);
+                __m256i p = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+                // packs works within 128-bit lanes.
+                p = _mm256_permute4x64_epi64(p, 0xd8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), p);
+            }
+            float_to_s16_scalar(src + i, dst + i, n - i);
+        }
+
+
+        // No FMA, so it runs on every AVX2 CPU; it's bound by memory anyway.
+        __attribute__((target("avx2")))
+        void
+        add_scaled_avx2(float* dst,
+                        const float* src,
+                        std::size_t n,
+                        float g)
+            noexcept
+        {
+            const __m256 vg = _mm256_set1_ps(g);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 d = _mm256_loadu_ps(dst + i);
+                __m256 x = _mm256_mul_ps(_mm256_loadu_ps(src + i), vg);
+                _mm256_storeu_ps(dst + i, _mm256_add_ps(d, x));
+            }
+            add_scaled_scalar(dst + i, src + i, n - i, g);
+        }
+
+#endif // SDL2XX_MIX_DSP_AVX2
+
+
+#ifdef SDL2XX_MIX_DSP_NEON
+
+        void
+        s16_to_float_neon(const Sint16* src,
+                          float* dst,
+                          std::size_t n)
+            noexcept
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                int16x8_t v = vld1q_s16(src + i);
+                float32x4_t a = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+                float32x4_t b = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+                vst1q_f32(dst + i, vmulq_n_f32(a, 1.0f / 32768));
+                vst1q_f32(dst + i + 4, vmulq_n_f32(b, 1.0f / 32768));
+            }
+            s16_to_float_scalar(src + i, dst + i, n - i);
+        }
+
+
+        void
+        float_to_s16_neon(const float* src,
+                          Sint16* dst,
+                          std::size_t n)
+            noexcept
+        {
+            const float32x4_t lo = vdupq_n_f32(-32768.0f);
+            const float32x4_t hi = vdupq_n_f32(32767.0f);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                float32x4_t a = vmulq_n_f32(vld1q_f32(src + i), 32768.0f);
+                float32x4_t b = vmulq_n_f32(vld1q_f32(src + i + 4), 32768.0f);
+                a = vminq_f32(vmaxq_f32(a, lo), hi);
+                b = vminq_f32(vmaxq_f32(b, lo), hi);
+                vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)),
+                                                vqmovn_s32(vcvtq_s32_f32(b))));
+            }
+            float_to_s16_scalar(src + i, dst + i, n - i);
+        }
+
+
+        void
+        add_scaled_neon(float* dst,
+                        const float* src,
+                        std::size_t n,
+                        float g)
+            noexcept
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), g));
+            add_scaled_scalar(dst + i, src + i, n - i, g);
+        }
+
+#endif // SDL2XX_MIX_DSP_NEON
+
+
+        kernels
+        select_kernels()
+            noexcept
+        {
+#ifdef SDL2XX_MIX_DSP_AVX2
+            if (SDL_HasAVX2())
+                return {s16_to_float_avx2, float_to_s16_avx2, add_scaled_avx2};
+#endif
+#ifdef SDL2XX_MIX_DSP_NEON
+            return {s16_to_float_neon, float_to_s16_neon, add_scaled_neon};
+#else
+            return {s16_to_float_scalar, float_to_s16_scalar, add_scaled_scalar};
+#endif
+        }
+
+
+        const kernels&
+        get_kernels()
+            noexcept
+        {
+            static const kernels k = select_kernels();
+            return k;
+        }
+
+
+        void
+        to_float(format fmt,
+                 const void* src,
+                 float* dst,
+                 std::size_t n)
+            noexcept
+        {
+            switch (fmt) {
+                case AUDIO_U8: {
+                    auto s = static_cast<const Uint8*>(src);
+                    for (std::size_t i = 0; i < n; ++i)
+                        dst[i] = (s[i] - 128) * (1.0f / 128);
+                    break;
+                }
+                case AUDIO_S8: {
+                    auto s = static_cast<const Sint8*>(src);
+                    for (std::size_t i = 0; i < n; ++i)
+                        dst[i] = s[i] * (1.0f / 128);
+                    break;
+                }
+                case AUDIO_S16SYS:
+                    get_kernels().s16_to_float(static_cast<const Sint16*>(src), dst, n);
+                    break;
+                case AUDIO_S32SYS: {
+                    auto s = static_cast<const Sint32*>(src);
+                    for (std::size_t i = 0; i < n; ++i)
+                        dst[i] = s[i] * (1.0f / 2147483648.0f);
+                    break;
+                }
+            }
+        }
+
+
+        void
+        from_float(format fmt,
+                   const float* src,
+                   void* dst,
+                   std::size_t n)
+            noexcept
+        {
+            switch (fmt) {
+                case AUDIO_U8: {
+                    auto d = static_cast<Uint8*>(dst);
+                    for (std::size_t i = 0; i < n; ++i)
+                        d[i] = std::lrint(std::clamp(src[i] * 128.0f, -128.0f, 127.0f)) + 128;
+                    break;
+                }
+                case AUDIO_S8: {
+                    auto d = static_cast<Sint8*>(dst);
+                    for (std::size_t i = 0; i < n; ++i)
+                        d[i] = std::lrint(std::clamp(src[i] * 128.0f, -128.0f, 127.0f));
+                    break;
+                }
+                case AUDIO_S16SYS:
+                    get_kernels().float_to_s16(src, static_cast<Sint16*>(dst), n);
+                    break;
+                case AUDIO_S32SYS: {
+                    // 2147483520 is the largest float below 2^31.
+                    auto d = static_cast<Sint32*>(dst);
+                    for (std::size_t i = 0; i < n; ++i)
+                        d[i] = std::lrint(std::clamp(src[i] * 2147483648.0f,
+                                                     -2147483648.0f,
+                                                     2147483520.0f));
+                    break;
+                }
+            }
+        }
+
+
+        float
+        db_to_gain(float db)
+            noexcept
+        {
+            return std::pow(10.0f, db / 20);
+        }
+
+
+        // Keep recursive filters out of denormals when the input goes silent.
+        float
+        flush(float x)
+            noexcept
+        {
+            return std::abs(x) < 1e-20f ? 0.0f : x;
+        }
+
+    } // namespace
+
+
+    void
+    effect::touch()
+        noexcept
+    {
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+
+    bool
+    effect::changed()
+        noexcept
+    {
+        Uint32 v = version.load(std::memory_order_acquire);
+        if (v == seen_version)
+            return false;
+        seen_version = v;
+        return true;
+    }
+
+
+    void
+    effect::prepare()
+    {}
+
+
+    void
+    effect::reset()
+        noexcept
+    {}
+
+
+    void
+    effect::finish()
+        noexcept
+    {}
+
+
+    void
+    effect::set_enabled(bool enable)
+        noexcept
+    {
+        enabled.store(enable, std::memory_order_relaxed);
+    }
+
+
+    bool
+    effect::is_enabled()
+        const noexcept
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+
+    biquad::biquad(type t,
+                   float frequency,
+                   float q,
+                   float gain_db)
+        noexcept :
+        kind{t},
+        frequency{frequency},
+        q{q},
+        gain_db{gain_db}
+    {}
+
+
+    void
+    biquad::prepare()
+    {
+        z1.assign(channels, 0);
+        z2.assign(channels, 0);
+    }
+
+
+    void
+    biquad::reset()
+        noexcept
+    {
+        std::ranges::fill(z1, 0);
+        std::ranges::fill(z2, 0);
+    }
+
+
+    void
+    biquad::process(float* samples,
+                    std::size_t frames)
+        noexcept
+    {
+        if (changed()) {
+            double f = std::clamp<double>(frequency.load(std::memory_order_relaxed),
+                                          10, 0.49 * rate);
+            double w = 2 * std::numbers::pi * f / rate;
+            double cw = std::cos(w);
+            double alpha = std::sin(w) / (2 * std::max(q.load(std::memory_order_relaxed),
+                                                       0.01f));
+            double A = std::pow(10.0, gain_db.load(std::memory_order_relaxed) / 40);
+            double s = 2 * std::sqrt(A) * alpha;
+            double c[6]; // b0, b1, b2, a0, a1, a2
+            switch (kind.load(std::memory_order_relaxed)) {
+                case type::band_pass:
+                    c[0] = alpha; c[1] = 0; c[2] = -alpha;
+                    c[3] = 1 + alpha; c[4] = -2 * cw; c[5] = 1 - alpha;
+                    break;
+                case type::high_pass:
+                    c[0] = (1 + cw) / 2; c[1] = -(1 + cw); c[2] = (1 + cw) / 2;
+                    c[3] = 1 + alpha; c[4] = -2 * cw; c[5] = 1 - alpha;
+                    break;
+                case type::high_shelf:
+                    c[0] = A * ((A + 1) + (A - 1) * cw + s);
+                    c[1] = -2 * A * ((A - 1) + (A + 1) * cw);
+                    c[2] = A * ((A + 1) + (A - 1) * cw - s);
+                    c[3] = (A + 1) - (A - 1) * cw + s;
+                    c[4] = 2 * ((A - 1) - (A + 1) * cw);
+                    c[5] = (A + 1) - (A - 1) * cw - s;
+                    break;
+                case type::low_pass:
+                    c[0] = (1 - cw) / 2; c[1] = 1 - cw; c[2] = (1 - cw) / 2;
+                    c[3] = 1 + alpha; c[4] = -2 * cw; c[5] = 1 - alpha;
+                    break;
+                case type::low_shelf:
+                    c[0] = A * ((A + 1) - (A - 1) * cw + s);
+                    c[1] = 2 * A * ((A - 1) - (A + 1) * cw);
+                    c[2] = A * ((A + 1) - (A - 1) * cw - s);
+                    c[3] = (A + 1) + (A - 1) * cw + s;
+                    c[4] = -2 * ((A - 1) + (A + 1) * cw);
+                    c[5] = (A + 1) + (A - 1) * cw - s;
+                    break;
+                case type::notch:
+                    c[0] = 1; c[1] = -2 * cw; c[2] = 1;
+                    c[3] = 1 + alpha; c[4] = -2 * cw; c[5] = 1 - alpha;
+                    break;
+                case type::peaking:
+                default:
+                    c[0] = 1 + alpha * A; c[1] = -2 * cw; c[2] = 1 - alpha * A;
+                    c[3] = 1 + alpha / A; c[4] = -2 * cw; c[5] = 1 - alpha / A;
+                    break;
+            }
+            b0 = c[0] / c[3];
+            b1 = c[1] / c[3];
+            b2 = c[2] / c[3];
+            a1 = c[4] / c[3];
+            a2 = c[5] / c[3];
+        }
+
+        // Transposed direct form II; the recursion runs along time, one channel at a
+        // time.
+        for (unsigned ch = 0; ch < channels; ++ch) {
+            float s1 = z1[ch];
+            float s2 = z2[ch];
+            float* p = samples + ch;
+            for (std::size_t i = 0; i < frames; ++i, p += channels) {
+                float x = *p;
+                float y = b0 * x + s1;
+                s1 = b1 * x - a1 * y + s2;
+                s2 = b2 * x - a2 * y;
+                *p = y;
+            }
+            z1[ch] = flush(s1);
+            z2[ch] = flush(s2);
+        }
+    }
+
+
+    void
+    biquad::set_type(type t)
+        noexcept
+    {
+        kind.store(t, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    biquad::set_frequency(float hz)
+        noexcept
+    {
+        frequency.store(hz, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    biquad::set_q(float new_q)
+        noexcept
+    {
+        q.store(new_q, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    biquad::set_gain(float db)
+        noexcept
+    {
+        gain_db.store(db, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    biquad::type
+    biquad::get_type()
+        const noexcept
+    {
+        return kind.load(std::memory_order_relaxed);
+    }
+
+
+    float
+    biquad::get_frequency()
+        const noexcept
+    {
+        return frequency.load(std::memory_order_relaxed);
+    }
+
+
+    float
+    biquad::get_q()
+        const noexcept
+    {
+        return q.load(std::memory_order_relaxed);
+    }
+
+
+    float
+    biquad::get_gain()
+        const noexcept
+    {
+        return gain_db.load(std::memory_order_relaxed);
+    }
+
+
+    low_pass::low_pass(float cutoff)
+        noexcept :
+        cutoff{cutoff}
+    {}
+
+
+    void
+    low_pass::prepare()
+    {
+        state.assign(channels, 0);
+    }
+
+
+    void
+    low_pass::reset()
+        noexcept
+    {
+        std::ranges::fill(state, 0);
+        // Start at the current cutoff, instead of ramping from the previous one.
+        static_cast<void>(changed());
+        float fc = std::clamp<float>(cutoff.load(std::memory_order_relaxed),
+                                     10, 0.49f * rate);
+        coef = target = 1 - std::exp(-2 * std::numbers::pi_v<float> * fc / rate);
+    }
+
+
+    void
+    low_pass::process(float* samples,
+                      std::size_t frames)
+        noexcept
+    {
+        if (changed()) {
+            float fc = std::clamp<float>(cutoff.load(std::memory_order_relaxed),
+                                         10, 0.49f * rate);
+            target = 1 - std::exp(-2 * std::numbers::pi_v<float> * fc / rate);
+        }
+
+        float c = coef;
+        float dc = (target - coef) / frames;
+        for (std::size_t i = 0; i < frames; ++i) {
+            c += dc;
+            float* f = samples + i * channels;
+            for (unsigned ch = 0; ch < channels; ++ch) {
+                state[ch] += c * (f[ch] - state[ch]);
+                f[ch] = state[ch];
+            }
+        }
+        coef = target;
+        for (auto& s : state)
+            s = flush(s);
+    }
+
+
+    void
+    low_pass::set_cutoff(float hz)
+        noexcept
+    {
+        cutoff.store(hz, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    low_pass::set_occlusion(float amount)
+        noexcept
+    {
+        amount = std::clamp(amount, 0.0f, 1.0f);
+        set_cutoff(20000 * std::pow(400.0f / 20000, amount));
+    }
+
+
+    float
+    low_pass::get_cutoff()
+        const noexcept
+    {
+        return cutoff.load(std::memory_order_relaxed);
+    }
+
+
+    compressor::compressor(float threshold_db,
+                           float ratio,
+                           float attack_ms,
+                           float release_ms,
+                           float makeup_db)
+        noexcept :
+        threshold_db{threshold_db},
+        ratio{ratio},
+        attack_ms{attack_ms},
+        release_ms{release_ms},
+        makeup_db{makeup_db}
+    {}
+
+
+    void
+    compressor::reset()
+        noexcept
+    {
+        envelope = 0;
+        reduction_db.store(0, std::memory_order_relaxed);
+    }
+
+
+    void
+    compressor::process(float* samples,
+                        std::size_t frames)
+        noexcept
+    {
+        if (changed()) {
+            slope = 1 - 1 / std::max(ratio.load(std::memory_order_relaxed), 1.0f);
+            auto coef_for = [this](float ms) -> float
+            {
+                if (ms <= 0)
+                    return 0;
+                return std::exp(-1000 / (ms * rate));
+            };
+            attack_coef = coef_for(attack_ms.load(std::memory_order_relaxed));
+            release_coef = coef_for(release_ms.load(std::memory_order_relaxed));
+        }
+
+        const float threshold = threshold_db.load(std::memory_order_relaxed);
+        const float makeup = makeup_db.load(std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < frames; ++i) {
+            float* f = samples + i * channels;
+            float peak = 0;
+            for (unsigned ch = 0; ch < channels; ++ch)
+                peak = std::max(peak, std::abs(f[ch]));
+
+            float level = peak > 1e-9f ? 20 * std::log10(peak) : -180.0f;
+            float target = std::max(0.0f, (level - threshold) * slope);
+            float k = target > envelope ? attack_coef : release_coef;
+            envelope = target + k * (envelope - target);
+
+            float g = db_to_gain(makeup - envelope);
+            for (unsigned ch = 0; ch < channels; ++ch)
+                f[ch] *= g;
+        }
+        envelope = flush(envelope);
+        reduction_db.store(envelope, std::memory_order_relaxed);
+    }
+
+
+    void
+    compressor::set_threshold(float db)
+        noexcept
+    {
+        threshold_db.store(db, std::memory_order_relaxed);
+    }
+
+
+    void
+    compressor::set_ratio(float r)
+        noexcept
+    {
+        ratio.store(r, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    compressor::set_attack(float ms)
+        noexcept
+    {
+        attack_ms.store(ms, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    compressor::set_release(float ms)
+        noexcept
+    {
+        release_ms.store(ms, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    compressor::set_makeup(float db)
+        noexcept
+    {
+        makeup_db.store(db, std::memory_order_relaxed);
+    }
+
+
+    float
+    compressor::get_reduction()
+        const noexcept
+    {
+        return reduction_db.load(std::memory_order_relaxed);
+    }
+
+
+    limiter::limiter(float ceiling_db,
+                     float release_ms)
+        noexcept :
+        compressor{ceiling_db,
+                   std::numeric_limits<float>::infinity(),
+                   0,
+                   release_ms}
+    {}
+
+
+    namespace {
+
+        // Freeverb tunings, for 44.1 kHz.
+        constexpr unsigned comb_tunings[] = {1116, 1188, 1277, 1356};
+        constexpr unsigned allpass_tunings[] = {556, 441};
+        constexpr unsigned stereo_spread = 23;
+        constexpr unsigned lines_per_channel = 6;
+
+        constexpr float reverb_input_gain = 0.03f;
+        constexpr float reverb_wet_scale = 3;
+
+    } // namespace
+
+
+    reverb_bus::reverb_bus(float room_size,
+                           float damping,
+                           float wet)
+        noexcept :
+        room_size{room_size},
+        damping{damping},
+        wet{wet}
+    {}
+
+
+    void
+    reverb_bus::prepare()
+    {
+        const double scale = rate / 44100.0;
+        lines.clear();
+        std::size_t offset = 0;
+        auto add_line = [&](unsigned tuning)
+        {
+            std::size_t size = std::max<std::size_t>(1, std::lround(tuning * scale));
+            lines.push_back({offset, size, 0, 0});
+            offset += size;
+        };
+        for (unsigned ch = 0; ch < channels; ++ch) {
+            unsigned spread = ch % 2 ? stereo_spread : 0;
+            for (unsigned t : comb_tunings)
+                add_line(t + spread);
+            for (unsigned t : allpass_tunings)
+                add_line(t + spread);
+        }
+        delays.assign(offset, 0);
+        bus.assign(max_frames * channels, 0);
+    }
+
+
+    void
+    reverb_bus::reset()
+        noexcept
+    {
+        std::ranges::fill(delays, 0);
+        for (auto& l : lines) {
+            l.pos = 0;
+            l.filter = 0;
+        }
+    }
+
+
+    void
+    reverb_bus::process(float* samples,
+                        std::size_t frames)
+        noexcept
+    {
+        if (changed()) {
+            feedback = 0.7f + 0.28f * std::clamp(room_size.load(std::memory_order_relaxed),
+                                                 0.0f, 1.0f);
+            damp = 0.4f * std::clamp(damping.load(std::memory_order_relaxed), 0.0f, 1.0f);
+            gain = wet.load(std::memory_order_relaxed) * reverb_wet_scale;
+        }
+
+        // Frames past `used` are zero, so the tail keeps ringing without input.
+        for (std::size_t i = 0; i < frames; ++i) {
+            std::size_t frame = read_pos + i;
+            const float* in = frame < max_frames ? bus.data() + frame * channels : nullptr;
+            float* out = samples + i * channels;
+            for (unsigned ch = 0; ch < channels; ++ch) {
+                float x = in ? in[ch] * reverb_input_gain : 0.0f;
+                line* l = lines.data() + ch * lines_per_channel;
+
+                float acc = 0;
+                for (unsigned k = 0; k < 4; ++k) {
+                    float& d = delays[l[k].offset + l[k].pos];
+                    float y = d;
+                    l[k].filter = flush(y * (1 - damp) + l[k].filter * damp);
+                    d = x + l[k].filter * feedback;
+                    if (++l[k].pos == l[k].size)
+                        l[k].pos = 0;
+                    acc += y;
+                }
+                for (unsigned k = 4; k < lines_per_channel; ++k) {
+                    float& d = delays[l[k].offset + l[k].pos];
+                    float b = d;
+                    d = acc + b * 0.5f;
+                    if (++l[k].pos == l[k].size)
+                        l[k].pos = 0;
+                    acc = b - acc;
+                }
+                out[ch] += acc * gain;
+            }
+        }
+        read_pos += frames;
+    }
+
+
+    void
+    reverb_bus::finish()
+        noexcept
+    {
+        std::fill_n(bus.begin(), used * channels, 0.0f);
+        used = 0;
+        read_pos = 0;
+        ++generation;
+    }
+
+
+    void
+    reverb_bus::set_room_size(float size)
+        noexcept
+    {
+        room_size.store(size, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    reverb_bus::set_damping(float d)
+        noexcept
+    {
+        damping.store(d, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    void
+    reverb_bus::set_wet(float level)
+        noexcept
+    {
+        wet.store(level, std::memory_order_relaxed);
+        touch();
+    }
+
+
+    reverb_send::reverb_send(reverb_bus& target,
+                             float level)
+        noexcept :
+        target(target),
+        level{level}
+    {}
+
+
+    void
+    reverb_send::reset()
+        noexcept
+    {
+        // Start over on the next callback, whatever the bus generation is.
+        cursor = 0;
+        fresh = true;
+    }
+
+
+    void
+    reverb_send::process(float* samples,
+                         std::size_t frames)
+        noexcept
+    {
+        // Each callback feeds the channel from the start of the buffer, and the bus
+        // starts a new generation after the post-mix ran.
+        if (fresh || generation != target.generation) {
+            fresh = false;
+            generation = target.generation;
+            cursor = 0;
+        }
+
+        const std::size_t capacity = target.max_frames;
+        if (cursor < capacity) {
+            std::size_t n = std::min(frames, capacity - cursor);
+            get_kernels().add_scaled(target.bus.data() + cursor * channels,
+                                     samples,
+                                     n * channels,
+                                     level.load(std::memory_order_relaxed));
+            target.used = std::max(target.used, cursor + n);
+        }
+        cursor += frames;
+    }
+
+
+    void
+    reverb_send::set_level(float new_level)
+        noexcept
+    {
+        level.store(new_level, std::memory_order_relaxed);
+    }
+
+
+    float
+    reverb_send::get_level()
+        const noexcept
+    {
+        return level.load(std::memory_order_relaxed);
+    }
+
+
+    effect_chain::effect_chain(std::size_t max_frames) :
+        max_frames{max_frames}
+    {
+        if (!max_frames)
+            throw error{"mix::effect_chain: max_frames must be greater than zero"};
+        auto s = query();
+        if (!s)
+            throw error{"mix::effect_chain: the mixer is not open"};
+        sp = *s;
+        switch (sp.fmt) {
+            case AUDIO_U8:
+            case AUDIO_S8:
+            case AUDIO_S16SYS:
+            case AUDIO_S32SYS:
+            case AUDIO_F32SYS:
+                break;
+            default:
+                throw error{"mix::effect_chain: unsupported audio format"};
+        }
+        if (sp.fmt != AUDIO_F32SYS)
+            scratch.resize(max_frames * sp.channels);
+    }
+
+
+    effect_chain::~effect_chain()
+        noexcept
+    {
+        detach();
+    }
+
+
+    effect&
+    effect_chain::insert(unique_ptr<effect> node)
+    {
+        if (!node)
+            throw error{"mix::effect_chain: out of memory"};
+        if (is_attached())
+            throw error{"mix::effect_chain: can't add effects while attached"};
+        node->rate = sp.frequency;
+        node->channels = sp.channels;
+        node->max_frames = max_frames;
+        node->prepare();
+        nodes.push_back(std::move(node));
+        return *nodes.back();
+    }
+
+
+    void
+    SDLCALL
+    effect_chain::channel_trampoline(int,
+                                     void* stream,
+                                     int len,
+                                     void* ctx)
+        noexcept
+    {
+        static_cast<effect_chain*>(ctx)->run(stream, len);
+    }
+
+
+    void
+    SDLCALL
+    effect_chain::done_trampoline(int,
+                                  void* ctx)
+        noexcept
+    {
+        auto self = static_cast<effect_chain*>(ctx);
+        self->attached.store(false, std::memory_order_release);
+    }
+
+
+    void
+    SDLCALL
+    effect_chain::post_mix_trampoline(void* ctx,
+                                      Uint8* stream,
+                                      int len)
+        noexcept
+    {
+        static_cast<effect_chain*>(ctx)->run(stream, len);
+    }
+
+
+    void
+    effect_chain::run(void* stream,
+                      std::size_t bytes)
+        noexcept
+    {
+        if (!bypass.load(std::memory_order_relaxed)) {
+            const std::size_t frame_bytes = SDL_AUDIO_BITSIZE(sp.fmt) / 8 * sp.channels;
+            const std::size_t total = bytes / frame_bytes;
+            auto base = static_cast<Uint8*>(stream);
+            for (std::size_t done = 0; done < total;) {
+                std::size_t n = std::min(max_frames, total - done);
+                std::size_t count = n * sp.channels;
+                void* raw = base + done * frame_bytes;
+                float* buf = sp.fmt == AUDIO_F32SYS
+                    ? static_cast<float*>(raw)
+                    : scratch.data();
+                if (sp.fmt != AUDIO_F32SYS)
+                    to_float(sp.fmt, raw, buf, count);
+                for (auto& node : nodes)
+                    if (node->is_enabled())
+                        node->process(buf, n);
+                if (sp.fmt != AUDIO_F32SYS)
+                    from_float(sp.fmt, buf, raw, count);
+                done += n;
+            }
+        }
+        for (auto& node : nodes)
+            node->finish();
+    }
+
+
+    void
+    effect_chain::attach(unsigned chan)
+    {
+        detach();
+        for (auto& node : nodes)
+            node->reset();
+        channel = chan;
+        attached.store(true, std::memory_order_release);
+        if (!Mix_RegisterEffect(chan, channel_trampoline, done_trampoline, this)) {
+            attached.store(false, std::memory_order_relaxed);
+            channel.reset();
+            throw error{};
+        }
+    }
+
+
+    void
+    effect_chain::attach_post_mix()
+    {
+        detach();
+        for (auto& node : nodes)
+            node->reset();
+        attached.store(true, std::memory_order_release);
+        set_post_mix(post_mix_trampoline, this);
+    }
+
+
+    void
+    effect_chain::detach()
+        noexcept
+    {
+        if (attached.load(std::memory_order_acquire)) {
+            if (channel)
+                // The channel may have stopped in the meantime, so ignore errors.
+                Mix_UnregisterEffect(*channel, channel_trampoline);
+            else
+                set_post_mix(nullptr, nullptr);
+        }
+        attached.store(false, std::memory_order_release);
+        channel.reset();
+    }
+
+
+    bool
+    effect_chain::is_attached()
+        const noexcept
+    {
+        return attached.load(std::memory_order_acquire);
+    }
+
+
+    void
+    effect_chain::set_bypass(bool enable)
+        noexcept
+    {
+        bypass.store(enable, std::memory_order_relaxed);
+    }
+
+
+    const spec&
+    effect_chain::get_spec()
+        const noexcept
+    {
+        return sp;
+    }
+
+
+    std::size_t
+    effect_chain::get_max_frames()
+        const noexcept
+    {
+        return max_frames;
+    }
+
+} // namespace sdl::mix
@@ -0,0 +1,271 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "mix_music.hpp"
+
+
+namespace sdl::mix {
+
+    namespace {
+
+        constexpr std::size_t min_chunk_size = 16 * 1024;
+
+
+        void
+        start(music_stream& track,
+              milliseconds fade,
+              int loops)
+        {
+            if (fade.count() > 0)
+                track.fade_in(fade, loops);
+            else
+                track.play(loops);
+        }
+
+    } // namespace
+
+
+    std::size_t
+    music_stream::chunk_size_for(milliseconds prefetch,
+                                 unsigned kbps)
+        noexcept
+    {
+        // kbit/s is the same as bits per ms.
+        std::size_t bytes = prefetch.count() * kbps / 8;
+        return std::max(min_chunk_size, bytes / prefetch_chunks);
+    }
+
+
+    music_stream::music_stream(rwops&& source,
+                               milliseconds prefetch,
+                               unsigned kbps) :
+        src{std::move(source), chunk_size_for(prefetch, kbps), prefetch_chunks},
+        mus{src}
+    {}
+
+
+    music_stream::music_stream(const path& filename,
+                               milliseconds prefetch,
+                               unsigned kbps) :
+        src{filename, chunk_size_for(prefetch, kbps), prefetch_chunks},
+        mus{src}
+    {}
+
+
+    music_stream::music_stream(const pack::archive& archive,
+                               std::string_view name,
+                               milliseconds prefetch,
+                               unsigned kbps) :
+        music_stream{archive.open(name), prefetch, kbps}
+    {}
+
+
+    music&
+    music_stream::get_music()
+        noexcept
+    {
+        return mus;
+    }
+
+
+    const music&
+    music_stream::get_music()
+        const noexcept
+    {
+        return mus;
+    }
+
+
+    void
+    music_stream::play(int loops)
+    {
+        mus.play(loops);
+    }
+
+
+    void
+    music_stream::fade_in(milliseconds duration,
+                          int loops)
+    {
+        mus.fade_in(duration, loops);
+    }
+
+
+    bool
+    music_stream::seek(dbl_seconds position)
+        noexcept
+    {
+        return music::set_position(position);
+    }
+
+
+    std::optional<dbl_seconds>
+    music_stream::get_position()
+        const noexcept
+    {
+        return mus.get_position();
+    }
+
+
+    std::optional<dbl_seconds>
+    music_stream::get_duration()
+        const noexcept
+    {
+        return mus.get_duration();
+    }
+
+
+    void
+    music_stream::set_loop(dbl_seconds start,
+                           dbl_seconds end)
+        noexcept
+    {
+        loop_start = start;
+        loop_end = end;
+    }
+
+
+    void
+    music_stream::reset_loop()
+        noexcept
+    {
+        loop_start.reset();
+        loop_end.reset();
+    }
+
+
+    bool
+    music_stream::has_custom_loop()
+        const noexcept
+    {
+        return loop_start && loop_end;
+    }
+
+
+    std::optional<dbl_seconds>
+    music_stream::get_loop_start()
+        const noexcept
+    {
+        if (has_custom_loop())
+            return loop_start;
+        return mus.get_loop_start();
+    }
+
+
+    std::optional<dbl_seconds>
+    music_stream::get_loop_end()
+        const noexcept
+    {
+        if (has_custom_loop())
+            return loop_end;
+        return mus.get_loop_end();
+    }
+
+
+    std::size_t
+    music_stream::get_prefetched()
+        const noexcept
+    {
+        return src.get_available();
+    }
+
+
+    music_player::~music_player()
+        noexcept
+    {
+        next.reset();
+        if (current)
+            music::halt();
+    }
+
+
+    void
+    music_player::play(music_stream&& track,
+                       milliseconds fade,
+                       int loops)
+    {
+        stopping = false;
+        if (current && music::is_playing()) {
+            if (fade.count() > 0 && current->get_music().fade_out(fade)) {
+                // update() starts it when the fade-out ends.
+                next.emplace(std::move(track));
+                next_fade = fade;
+                next_loops = loops;
+                return;
+            }
+            music::halt();
+        }
+        next.reset();
+        current.reset();
+        current.emplace(std::move(track));
+        start(*current, fade, loops);
+    }
+
+
+    void
+    music_player::stop(milliseconds fade)
+        noexcept
+    {
+        next.reset();
+        if (!current)
+            return;
+        if (fade.count() > 0 && music::is_playing() && current->get_music().fade_out(fade)) {
+            stopping = true;
+            return;
+        }
+        music::halt();
+        current.reset();
+        stopping = false;
+    }
+
+
+    void
+    music_player::update()
+    {
+        if (!current)
+            return;
+
+        if (!music::is_playing()) {
+            // Either the fade-out ended, or the track finished.
+            current.reset();
+            stopping = false;
+            if (next) {
+                current.emplace(std::move(*next));
+                next.reset();
+                start(*current, next_fade, next_loops);
+            }
+            return;
+        }
+
+        if (!next && !stopping && current->has_custom_loop()) {
+            auto pos = current->get_position();
+            if (pos && *pos >= *current->get_loop_end())
+                current->seek(*current->get_loop_start());
+        }
+    }
+
+
+    music_stream*
+    music_player::get_current()
+        noexcept
+    {
+        return current ? &*current : nullptr;
+    }
+
+
+    bool
+    music_player::is_transitioning()
+        const noexcept
+    {
+        return next.has_value();
+    }
+
+} // namespace sdl::mix
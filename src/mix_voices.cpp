@@ -0,0 +1,235 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+
+#include "mix_voices.hpp"
+
+#include "error.hpp"
+
+
+namespace sdl::mix {
+
+    voice_pool::voice_pool(unsigned first,
+                           unsigned count,
+                           int tag) :
+        first{first},
+        tag{tag},
+        voices(count)
+    {
+        if (!count)
+            throw error{"mix::voice_pool: count must be greater than zero"};
+        if (size() < first + count)
+            allocate_channels(first + count);
+        set_group(first, first + count - 1, tag);
+    }
+
+
+    voice_pool::~voice_pool()
+        noexcept
+    {
+        halt();
+    }
+
+
+    void
+    voice_pool::refresh()
+        noexcept
+    {
+        for (unsigned i = 0; i < voices.size(); ++i)
+            if (voices[i].active && !is_playing(first + i))
+                voices[i].active = false;
+    }
+
+
+    std::optional<unsigned>
+    voice_pool::pick(const Mix_Chunk* sound,
+                     const params& p)
+        noexcept
+    {
+        refresh();
+
+        if (p.max_instances) {
+            unsigned count = 0;
+            std::optional<unsigned> oldest;
+            for (unsigned i = 0; i < voices.size(); ++i) {
+                const voice& v = voices[i];
+                if (!v.active || v.sound != sound)
+                    continue;
+                ++count;
+                if (!oldest || v.serial < voices[*oldest].serial)
+                    oldest = i;
+            }
+            if (count >= p.max_instances) {
+                if (voices[*oldest].priority > p.priority)
+                    return {};
+                return oldest;
+            }
+        }
+
+        for (unsigned i = 0; i < voices.size(); ++i)
+            if (!voices[i].active)
+                return i;
+
+        // Least important first: lowest priority, then farthest, then oldest.
+        auto less_important = [](const voice& a,
+                                 const voice& b)
+        {
+            if (a.priority != b.priority)
+                return a.priority < b.priority;
+            if (a.distance != b.distance)
+                return a.distance > b.distance;
+            return a.serial < b.serial;
+        };
+        auto victim = std::ranges::min_element(voices, less_important);
+        if (victim->priority > p.priority)
+            return {};
+        if (victim->priority == p.priority && !steal_equal)
+            return {};
+        return victim - voices.begin();
+    }
+
+
+    std::optional<unsigned>
+    voice_pool::play(chunk& sound)
+    {
+        return play(sound, params{});
+    }
+
+
+    std::optional<unsigned>
+    voice_pool::play(chunk& sound,
+                     const params& p)
+    {
+        if (p.distance >= cull_distance) {
+            ++counters.culled;
+            return {};
+        }
+
+        auto index = pick(sound.data(), p);
+        if (!index) {
+            ++counters.dropped;
+            return {};
+        }
+
+        unsigned channel = first + *index;
+        voice& v = voices[*index];
+        if (v.active) {
+            ++counters.stolen;
+            mix::halt(channel);
+            v.active = false;
+        }
+
+        // Effects stay on the channel, so the previous voice's distance must go.
+        if (p.distance > 0)
+            mix::set_distance(channel, p.distance);
+        else
+            reset_distance(channel);
+
+        unsigned result = p.fade_in.count() > 0
+            ? sound.fade_in_on(channel, p.fade_in, p.loops)
+            : sound.play_on(channel, p.loops);
+        if (result != channel)
+            throw error{};
+
+        v = {sound.data(), p.priority, p.distance, next_serial++, true};
+        ++counters.played;
+        return channel;
+    }
+
+
+    void
+    voice_pool::set_distance(unsigned channel,
+                             float distance)
+    {
+        if (channel < first || channel - first >= voices.size())
+            return;
+        voice& v = voices[channel - first];
+        if (!v.active)
+            return;
+        v.distance = distance;
+        mix::set_distance(channel, distance);
+    }
+
+
+    void
+    voice_pool::set_cull_distance(float distance)
+        noexcept
+    {
+        cull_distance = distance;
+    }
+
+
+    void
+    voice_pool::set_steal_equal(bool enable)
+        noexcept
+    {
+        steal_equal = enable;
+    }
+
+
+    void
+    voice_pool::halt()
+        noexcept
+    {
+        halt_group(tag);
+        for (auto& v : voices)
+            v.active = false;
+    }
+
+
+    void
+    voice_pool::fade_out(milliseconds duration)
+        noexcept
+    {
+        // Voices stay active until the fade ends, so they can still be stolen.
+        fade_out_group(tag, duration);
+    }
+
+
+    unsigned
+    voice_pool::get_active()
+        noexcept
+    {
+        refresh();
+        return std::ranges::count(voices, true, &voice::active);
+    }
+
+
+    unsigned
+    voice_pool::get_size()
+        const noexcept
+    {
+        return voices.size();
+    }
+
+
+    int
+    voice_pool::get_tag()
+        const noexcept
+    {
+        return tag;
+    }
+
+
+    const voice_pool::stats&
+    voice_pool::get_stats()
+        const noexcept
+    {
+        return counters;
+    }
+
+
+    void
+    voice_pool::reset_stats()
+        noexcept
+    {
+        counters = {};
+    }
+
+} // namespace sdl::mix
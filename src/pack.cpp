@@ -0,0 +1,518 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#define SDL2XX_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <SDL_error.h>
+
+#include "pack.hpp"
+
+#include "endian.hpp"
+#include "memory_rwops.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+
+namespace sdl::pack {
+
+    namespace {
+
+        constexpr char magic[8] = {'S', 'D', 'L', '2', 'X', 'X', 'P', 'K'};
+
+        constexpr std::size_t header_size = 32;
+        constexpr std::size_t record_size = 40;
+
+
+        template<typename T>
+        T
+        load_le(const Uint8* src)
+            noexcept
+        {
+            T value;
+            std::memcpy(&value, src, sizeof value);
+            return endian::from_le(value);
+        }
+
+
+        void
+        write_bytes(rwops& dst,
+                    const void* buf,
+                    std::size_t size)
+        {
+            if (size && dst.write(buf, 1, size) != size)
+                throw error{"pack::writer: short write"};
+        }
+
+
+        codec
+        to_codec(compression comp)
+        {
+            switch (comp) {
+                case compression::deflate:
+                    return codec::deflate;
+                case compression::zstd:
+                    return codec::zstd;
+                case compression::lz4:
+                    return codec::lz4;
+                default:
+                    throw error{"pack: unsupported compression"};
+            }
+        }
+
+
+        std::size_t
+        padding_for(Uint64 offset,
+                    std::size_t alignment)
+            noexcept
+        {
+            auto rem = offset % alignment;
+            return rem ? alignment - rem : 0;
+        }
+
+    } // namespace
+
+
+    archive::archive(const path& filename)
+    {
+        create(filename);
+    }
+
+
+    archive::archive(blob data)
+    {
+        create(std::move(data));
+    }
+
+
+    archive::archive(archive&& other)
+        noexcept :
+        base{std::exchange(other.base, nullptr)},
+        base_size{std::exchange(other.base_size, 0)},
+        mapped{std::exchange(other.mapped, false)},
+        storage{std::move(other.storage)},
+        entries{std::move(other.entries)}
+    {}
+
+
+    archive::~archive()
+        noexcept
+    {
+        destroy();
+    }
+
+
+    archive&
+    archive::operator =(archive&& other)
+        noexcept
+    {
+        if (this != &other) {
+            destroy();
+            base = std::exchange(other.base, nullptr);
+            base_size = std::exchange(other.base_size, 0);
+            mapped = std::exchange(other.mapped, false);
+            storage = std::move(other.storage);
+            entries = std::move(other.entries);
+        }
+        return *this;
+    }
+
+
+    void
+    archive::create(const path& filename)
+    {
+#ifdef SDL2XX_USE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw error{"pack::archive: could not open file"};
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(header_size)) {
+            ::close(fd);
+            throw error{"pack::archive: invalid file"};
+        }
+        void* ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+            throw error{"pack::archive: mmap() failed"};
+
+        destroy();
+        base = static_cast<const Uint8*>(ptr);
+        base_size = st.st_size;
+        mapped = true;
+        try {
+            parse();
+        }
+        catch (...) {
+            destroy();
+            throw;
+        }
+#else
+        create(load_file(filename));
+#endif
+    }
+
+
+    void
+    archive::create(blob data)
+    {
+        destroy();
+        storage = std::move(data);
+        base = storage.data().data();
+        base_size = storage.data().size();
+        try {
+            parse();
+        }
+        catch (...) {
+            destroy();
+            throw;
+        }
+    }
+
+
+    void
+    archive::destroy()
+        noexcept
+    {
+#ifdef SDL2XX_USE_MMAP
+        if (mapped)
+            ::munmap(const_cast<Uint8*>(base), base_size);
+#endif
+        base = nullptr;
+        base_size = 0;
+        mapped = false;
+        storage = blob{nullptr, 0};
+        entries.clear();
+    }
+
+
+    void
+    archive::parse()
+    {
+        if (base_size < header_size || std::memcmp(base, magic, sizeof magic))
+            throw error{"pack::archive: not a pack file"};
+        if (load_le<Uint32>(base + 8) != version)
+            throw error{"pack::archive: unsupported version"};
+
+        Uint32 count = load_le<Uint32>(base + 16);
+        Uint64 dir_offset = load_le<Uint64>(base + 24);
+        if (dir_offset > base_size || count > (base_size - dir_offset) / record_size)
+            throw error{"pack::archive: corrupted directory"};
+
+        Uint64 names_offset = dir_offset + Uint64{count} * record_size;
+        Uint64 names_size = base_size - names_offset;
+        const char* names = reinterpret_cast<const char*>(base + names_offset);
+
+        entries.clear();
+        entries.reserve(count);
+        for (Uint32 i = 0; i < count; ++i) {
+            const Uint8* rec = base + dir_offset + i * record_size;
+            entry e;
+            e.offset        = load_le<Uint64>(rec + 0);
+            e.size          = load_le<Uint64>(rec + 8);
+            e.original_size = load_le<Uint64>(rec + 16);
+            Uint32 name_offset = load_le<Uint32>(rec + 24);
+            Uint32 name_size   = load_le<Uint32>(rec + 28);
+            e.comp = static_cast<compression>(rec[32]);
+
+            if (e.offset > dir_offset || e.size > dir_offset - e.offset)
+                throw error{"pack::archive: corrupted entry"};
+            if (name_offset > names_size || name_size > names_size - name_offset)
+                throw error{"pack::archive: corrupted entry name"};
+            e.name = {names + name_offset, name_size};
+
+            if (!entries.empty() && !(entries.back().name < e.name))
+                throw error{"pack::archive: directory is not sorted"};
+
+            entries.push_back(e);
+        }
+    }
+
+
+    bool
+    archive::is_valid()
+        const noexcept
+    {
+        return base;
+    }
+
+
+    archive::operator bool()
+        const noexcept
+    {
+        return is_valid();
+    }
+
+
+    bool
+    archive::is_mapped()
+        const noexcept
+    {
+        return mapped;
+    }
+
+
+    std::span<const entry>
+    archive::get_entries()
+        const noexcept
+    {
+        return entries;
+    }
+
+
+    const entry*
+    archive::find(std::string_view name)
+        const noexcept
+    {
+        auto it = std::ranges::lower_bound(entries, name, {}, &entry::name);
+        if (it == entries.end() || it->name != name)
+            return nullptr;
+        return &*it;
+    }
+
+
+    bool
+    archive::contains(std::string_view name)
+        const noexcept
+    {
+        return find(name);
+    }
+
+
+    std::span<const Uint8>
+    archive::get_data(const entry& e)
+        const noexcept
+    {
+        return {base + e.offset, static_cast<std::size_t>(e.size)};
+    }
+
+
+    rwops
+    archive::open(std::string_view name)
+        const
+    {
+        auto result = try_open(name);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    rwops
+    archive::open(const entry& e)
+        const
+    {
+        auto result = try_open(e);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<rwops, error>
+    archive::try_open(std::string_view name)
+        const noexcept
+    {
+        auto e = find(name);
+        if (!e)
+            return unexpected{error{"pack::archive: entry not found"}};
+        return try_open(*e);
+    }
+
+
+    expected<rwops, error>
+    archive::try_open(const entry& e)
+        const noexcept
+    {
+        try {
+            memory_rwops stored{get_data(e)};
+            if (e.comp == compression::none)
+                return stored;
+            return decompress_rwops{std::move(stored), to_codec(e.comp),
+                                    static_cast<Sint64>(e.original_size)};
+        }
+        catch (error& err) {
+            return unexpected{std::move(err)};
+        }
+    }
+
+
+    blob
+    archive::load(std::string_view name)
+        const
+    {
+        auto result = try_load(name);
+        if (!result)
+            throw result.error();
+        return std::move(*result);
+    }
+
+
+    expected<blob, error>
+    archive::try_load(std::string_view name)
+        const noexcept
+    {
+        auto src = try_open(name);
+        if (!src)
+            return unexpected{std::move(src.error())};
+        return src->try_load();
+    }
+
+
+    writer::writer(std::size_t alignment,
+                   int level) :
+        alignment{alignment ? alignment : 1},
+        level{level}
+    {}
+
+
+    void
+    writer::add(std::string_view name,
+                blob data,
+                compression comp)
+    {
+        items.push_back(pending{string{name}, {}, std::move(data), comp});
+    }
+
+
+    void
+    writer::add(std::string_view name,
+                std::span<const Uint8> data,
+                compression comp)
+    {
+        blob copy{nullptr, 0};
+        if (!data.empty()) {
+            copy = blob{data.size()};
+            std::ranges::copy(data, copy.data().data());
+        }
+        add(name, std::move(copy), comp);
+    }
+
+
+    void
+    writer::add_file(std::string_view name,
+                     const path& filename,
+                     compression comp)
+    {
+        items.push_back(pending{string{name}, filename, blob{nullptr, 0}, comp});
+    }
+
+
+    std::size_t
+    writer::size()
+        const noexcept
+    {
+        return items.size();
+    }
+
+
+    void
+    writer::write(rwops& dst)
+    {
+        std::ranges::sort(items, {}, &pending::name);
+        for (std::size_t i = 1; i < items.size(); ++i)
+            if (items[i - 1].name == items[i].name)
+                throw error{"pack::writer: duplicated entry name"};
+
+        static const Uint8 zeros[256] = {};
+        auto pad_to = [&dst](Uint64 pos, std::size_t alignment) -> Uint64
+        {
+            auto pad = padding_for(pos, alignment);
+            pos += pad;
+            while (pad > 0) {
+                auto n = std::min(pad, sizeof zeros);
+                write_bytes(dst, zeros, n);
+                pad -= n;
+            }
+            return pos;
+        };
+
+        struct record {
+            Uint64 offset;
+            Uint64 size;
+            Uint64 original_size;
+        };
+        vector<record> records;
+        records.reserve(items.size());
+
+        // Header, with the directory offset fixed up at the end.
+        auto start = dst.tell();
+        write_bytes(dst, magic, sizeof magic);
+        dst.write_le<Uint32>(version);
+        dst.write_le<Uint32>(alignment);
+        dst.write_le<Uint32>(items.size());
+        dst.write_le<Uint32>(0);
+        dst.write_le<Uint64>(0);
+
+        Uint64 pos = header_size;
+        for (auto& item : items) {
+            blob data = item.filename.empty() ? std::move(item.data) : load_file(item.filename);
+            pos = pad_to(pos, alignment);
+            auto bytes = data.data();
+            Uint64 stored_size = bytes.size();
+            if (item.comp == compression::none)
+                write_bytes(dst, bytes.data(), bytes.size());
+            else {
+                auto before = dst.tell();
+                compress_rwops z{dst, to_codec(item.comp), level};
+                if (!bytes.empty() && z.write(bytes.data(), 1, bytes.size()) != bytes.size())
+                    throw error{};
+                z.finish();
+                stored_size = dst.tell() - before;
+            }
+            records.push_back({pos, stored_size, bytes.size()});
+            pos += stored_size;
+        }
+
+        pos = pad_to(pos, 8);
+        Uint64 dir_offset = pos;
+        Uint32 name_offset = 0;
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            dst.write_le<Uint64>(records[i].offset);
+            dst.write_le<Uint64>(records[i].size);
+            dst.write_le<Uint64>(records[i].original_size);
+            dst.write_le<Uint32>(name_offset);
+            dst.write_le<Uint32>(items[i].name.size());
+            dst.write_u8(static_cast<Uint8>(items[i].comp));
+            write_bytes(dst, zeros, 7);
+            name_offset += items[i].name.size();
+        }
+        for (auto& item : items)
+            write_bytes(dst, item.name.data(), item.name.size());
+
+        auto end = dst.tell();
+        dst.seek(start + 24, rwops::seekdir::beg);
+        dst.write_le<Uint64>(dir_offset);
+        dst.seek(end, rwops::seekdir::beg);
+
+        items.clear();
+    }
+
+
+    void
+    writer::save(const path& filename)
+    {
+        rwops dst{filename, "wb"};
+        write(dst);
+    }
+
+} // namespace sdl::pack
@@ -0,0 +1,152 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include <SDL_stdinc.h>
+
+#include "pool.hpp"
+
+
+namespace sdl {
+
+    namespace {
+
+        std::size_t
+        round_block_size(std::size_t size)
+            noexcept
+        {
+            // Every block must hold a free list link, and stay aligned.
+            constexpr std::size_t align = alignof(std::max_align_t);
+            size = std::max(size, sizeof(void*));
+            return (size + align - 1) / align * align;
+        }
+
+    } // namespace
+
+
+    pool::pool(std::size_t block_size,
+               std::size_t blocks_per_chunk)
+        noexcept :
+        block_size{round_block_size(block_size)},
+        blocks_per_chunk{blocks_per_chunk ? blocks_per_chunk : 1}
+    {}
+
+
+    pool::pool(pool&& other)
+        noexcept :
+        block_size{other.block_size},
+        blocks_per_chunk{other.blocks_per_chunk},
+        free_list{std::exchange(other.free_list, nullptr)},
+        chunks{std::move(other.chunks)},
+        used{std::exchange(other.used, 0)}
+    {
+        other.chunks.clear();
+    }
+
+
+    pool::~pool()
+        noexcept
+    {
+        release();
+    }
+
+
+    pool&
+    pool::operator =(pool&& other)
+        noexcept
+    {
+        if (this != &other) {
+            release();
+            block_size = other.block_size;
+            blocks_per_chunk = other.blocks_per_chunk;
+            free_list = std::exchange(other.free_list, nullptr);
+            chunks = std::move(other.chunks);
+            other.chunks.clear();
+            used = std::exchange(other.used, 0);
+        }
+        return *this;
+    }
+
+
+    void*
+    pool::allocate()
+    {
+        if (!free_list) {
+            auto chunk = malloc_allocator::allocate_as<Uint8*>(block_size * blocks_per_chunk);
+            try {
+                chunks.push_back(chunk);
+            }
+            catch (...) {
+                malloc_allocator::deallocate(chunk);
+                throw;
+            }
+            // Thread the new blocks into the free list, in address order.
+            for (std::size_t i = blocks_per_chunk; i > 0; --i) {
+                auto n = reinterpret_cast<node*>(chunk + (i - 1) * block_size);
+                n->next = free_list;
+                free_list = n;
+            }
+        }
+        node* n = free_list;
+        free_list = n->next;
+        ++used;
+        return n;
+    }
+
+
+    void
+    pool::deallocate(void* ptr)
+        noexcept
+    {
+        if (!ptr)
+            return;
+        auto n = static_cast<node*>(ptr);
+        n->next = free_list;
+        free_list = n;
+        --used;
+    }
+
+
+    void
+    pool::release()
+        noexcept
+    {
+        for (auto chunk : chunks)
+            malloc_allocator::deallocate(chunk);
+        chunks.clear();
+        free_list = nullptr;
+        used = 0;
+    }
+
+
+    std::size_t
+    pool::get_block_size()
+        const noexcept
+    {
+        return block_size;
+    }
+
+
+    std::size_t
+    pool::get_used()
+        const noexcept
+    {
+        return used;
+    }
+
+
+    std::size_t
+    pool::get_capacity()
+        const noexcept
+    {
+        return chunks.size() * blocks_per_chunk;
+    }
+
+} // namespace sdl
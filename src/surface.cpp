@@ -9,6 +9,7 @@
 #include "surface.hpp"
 
 #include "error.hpp"
+#include "memory_stats.hpp"
 
 
 namespace sdl {
@@ -157,6 +158,7 @@ namespace sdl {
                     Uint32 b_mask,
                     Uint32 a_mask)
     {
+        memory::tag_scope tag{memory::tag::surface};
         auto ptr = SDL_CreateRGBSurface(0,
                                         width, height,
                                         depth,
@@ -174,6 +176,7 @@ namespace sdl {
                     int depth,
                     pixels::format_enum fmt)
     {
+        memory::tag_scope tag{memory::tag::surface};
         auto ptr = SDL_CreateRGBSurfaceWithFormat(0,
                                                   width, height,
                                                   depth,
@@ -196,6 +199,7 @@ namespace sdl {
                     Uint32 b_mask,
                     Uint32 a_mask)
     {
+        memory::tag_scope tag{memory::tag::surface};
         auto ptr = SDL_CreateRGBSurfaceFrom(pixels, width, height,
                                             depth, pitch,
                                             r_mask, g_mask, b_mask, a_mask);
@@ -214,6 +218,7 @@ namespace sdl {
                     int pitch,
                     pixels::format_enum fmt)
     {
+        memory::tag_scope tag{memory::tag::surface};
         auto ptr = SDL_CreateRGBSurfaceWithFormatFrom(pixels,
                                                       width, height,
                                                       depth, pitch,
@@ -228,6 +233,7 @@ namespace sdl {
     void
     surface::create(const surface& other)
     {
+        memory::tag_scope tag{memory::tag::surface};
         if (other.raw) {
             auto ptr = SDL_DuplicateSurface(other.raw);
             if (!ptr)
@@ -243,6 +249,7 @@ namespace sdl {
     surface::create(const surface& other,
                     const pixels::format& fmt)
     {
+        memory::tag_scope tag{memory::tag::surface};
         auto ptr = SDL_ConvertSurface(other.raw, fmt.data(), 0);
         if (!ptr)
             throw error{};
@@ -255,6 +262,7 @@ namespace sdl {
     surface::create(const surface& other,
                     pixels::format_enum fmt)
     {
+        memory::tag_scope tag{memory::tag::surface};
         auto ptr = SDL_ConvertSurfaceFormat(other.raw,
                                             static_cast<SDL_PixelFormatEnum>(fmt),
                                             0);
@@ -467,6 +475,7 @@ namespace sdl {
     surface::load_bmp(SDL_RWops* src,
                       bool close_src)
     {
+        memory::tag_scope tag{memory::tag::surface};
         SDL_Surface* surf = SDL_LoadBMP_RW(src, close_src);
         if (!surf)
             throw error{};
@@ -484,6 +493,7 @@ namespace sdl {
     surface
     surface::load_bmp(const path& filename)
     {
+        memory::tag_scope tag{memory::tag::surface};
         SDL_Surface* surf = SDL_LoadBMP(filename.c_str());
         if (!surf)
             throw error{};
@@ -9,6 +9,7 @@
 #include "texture.hpp"
 
 #include "error.hpp"
+#include "memory_stats.hpp"
 #include "renderer.hpp"
 #include "surface.hpp"
 
@@ -86,6 +87,7 @@ namespace sdl {
                     int width,
                     int height)
     {
+        memory::tag_scope tag{memory::tag::texture};
         auto ptr = SDL_CreateTexture(ren.data(),
                                      static_cast<SDL_PixelFormatEnum>(fmt),
                                      access,
@@ -102,6 +104,7 @@ namespace sdl {
     texture::create(renderer& ren,
                     surface& surf)
     {
+        memory::tag_scope tag{memory::tag::texture};
         auto ptr = SDL_CreateTextureFromSurface(ren.data(), surf.data());
         if (!ptr)
             throw error{};
@@ -336,6 +339,7 @@ namespace sdl {
                     const void* pixels,
                     int pitch)
     {
+        memory::tag_scope tag{memory::tag::texture};
         if (SDL_UpdateTexture(raw, area, pixels, pitch) < 0)
             throw error{};
     }
@@ -347,6 +351,7 @@ namespace sdl {
                         const Uint8* u, int u_pitch,
                         const Uint8* v, int v_pitch)
     {
+        memory::tag_scope tag{memory::tag::texture};
         if (SDL_UpdateYUVTexture(raw, area,
                                  y, y_pitch,
                                  u, u_pitch,
@@ -360,6 +365,7 @@ namespace sdl {
                        const Uint8* y, int y_pitch,
                        const Uint8* uv, int uv_pitch)
     {
+        memory::tag_scope tag{memory::tag::texture};
         if (SDL_UpdateNVTexture(raw, area,
                                 y, y_pitch,
                                 uv, uv_pitch) < 0)
@@ -370,6 +376,7 @@ namespace sdl {
     std::pair<void*, int>
     texture::lock(const rect* area)
     {
+        memory::tag_scope tag{memory::tag::texture};
         void* pixels;
         int pitch;
         if (SDL_LockTexture(raw, area, &pixels, &pitch) < 0)
@@ -381,6 +388,7 @@ namespace sdl {
     surface*
     texture::lock_surface(const rect* area)
     {
+        memory::tag_scope tag{memory::tag::texture};
         SDL_Surface* surf;
         if (SDL_LockTextureToSurface(raw, area, &surf) < 0)
             throw error{};
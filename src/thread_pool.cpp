@@ -0,0 +1,147 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include <SDL_cpuinfo.h>
+
+#include "thread_pool.hpp"
+
+
+namespace sdl {
+
+    unsigned
+    thread_pool::default_threads()
+        noexcept
+    {
+        return std::max(SDL_GetCPUCount() - 1, 1);
+    }
+
+
+    thread_pool::thread_pool(unsigned threads)
+    {
+        threads = std::max(threads, 1u);
+        workers.reserve(threads);
+        try {
+            for (unsigned i = 0; i < threads; ++i)
+                workers.emplace_back(&thread_pool::run, this);
+        }
+        catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+
+
+    thread_pool::~thread_pool()
+        noexcept
+    {
+        shutdown();
+    }
+
+
+    void
+    thread_pool::shutdown()
+        noexcept
+    {
+        // Dropped tasks are destroyed outside the lock.
+        std::map<key, task_function> dropped;
+        {
+            std::lock_guard guard{mutex};
+            stop = true;
+            dropped.swap(tasks);
+        }
+        tasks_cv.notify_all();
+        for (auto& w : workers)
+            w.join();
+        workers.clear();
+    }
+
+
+    void
+    thread_pool::run()
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        for (;;) {
+            tasks_cv.wait(guard, [this] { return stop || !tasks.empty(); });
+            if (stop)
+                return;
+            auto node = tasks.extract(tasks.begin());
+            ++running;
+            guard.unlock();
+            try {
+                node.mapped()();
+            }
+            catch (...) {}
+            // Destroy the function before reporting the task as done.
+            node = {};
+            guard.lock();
+            --running;
+            if (tasks.empty() && !running)
+                idle_cv.notify_all();
+        }
+    }
+
+
+    thread_pool::task_id
+    thread_pool::submit(task_function func,
+                        int priority)
+    {
+        std::lock_guard guard{mutex};
+        task_id id = ++next_id;
+        tasks.emplace(key{priority, id}, std::move(func));
+        tasks_cv.notify_one();
+        return id;
+    }
+
+
+    bool
+    thread_pool::cancel(task_id id)
+        noexcept
+    {
+        task_function func;
+        std::lock_guard guard{mutex};
+        auto it = std::ranges::find(tasks, id, [](const auto& kv) { return kv.first.id; });
+        if (it == tasks.end())
+            return false;
+        func = std::move(it->second);
+        tasks.erase(it);
+        if (tasks.empty() && !running)
+            idle_cv.notify_all();
+        return true;
+    }
+
+
+    void
+    thread_pool::wait()
+        noexcept
+    {
+        std::unique_lock guard{mutex};
+        idle_cv.wait(guard, [this] { return tasks.empty() && !running; });
+    }
+
+
+    unsigned
+    thread_pool::size()
+        const noexcept
+    {
+        return workers.size();
+    }
+
+
+    std::size_t
+    thread_pool::get_pending()
+        const noexcept
+    {
+        std::lock_guard guard{mutex};
+        return tasks.size();
+    }
+
+} // namespace sdl
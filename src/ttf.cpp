@@ -10,6 +10,8 @@
 
 #include "ttf.hpp"
 
+#include "memory_stats.hpp"
+
 
 using std::expected;
 using std::unexpected;
@@ -131,6 +133,7 @@ namespace sdl::ttf {
     font::create(const path& filename,
                  int pt_size)
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto ptr = TTF_OpenFont(filename.c_str(), pt_size);
         if (!ptr)
             throw error{};
@@ -144,6 +147,7 @@ namespace sdl::ttf {
                  int pt_size,
                  const options& opt)
     {
+        memory::tag_scope tag{memory::tag::ttf};
         TTF_Font* ptr = nullptr;
         if (opt.index) {
             if (opt.dpi) {
@@ -186,6 +190,7 @@ namespace sdl::ttf {
                  bool free_src,
                  int pt_size)
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto ptr = TTF_OpenFontRW(src, free_src, pt_size);
         if (!ptr)
             throw error{};
@@ -200,6 +205,7 @@ namespace sdl::ttf {
                  int pt_size,
                  const options& opt)
     {
+        memory::tag_scope tag{memory::tag::ttf};
         TTF_Font* ptr = nullptr;
         if (opt.index) {
             if (opt.dpi) {
@@ -243,6 +249,7 @@ namespace sdl::ttf {
     font::create(rwops& src,
                  int pt_size)
     {
+        memory::tag_scope tag{memory::tag::ttf};
         create(src.data(), false, pt_size);
     }
 
@@ -252,6 +259,7 @@ namespace sdl::ttf {
                  int pt_size,
                  const options& opt)
     {
+        memory::tag_scope tag{memory::tag::ttf};
         create(src.data(), false, pt_size, opt);
     }
 
@@ -594,6 +602,7 @@ namespace sdl::ttf {
                                  color fg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderGlyph32_Solid(raw, codepoint, fg);
         if (!surf)
             return unexpected{error{}};
@@ -618,6 +627,7 @@ namespace sdl::ttf {
                            color fg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_Solid(raw, text, fg);
         if (!surf)
             return unexpected{error{}};
@@ -660,6 +670,7 @@ namespace sdl::ttf {
                                   color fg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_Solid(raw, text, fg);
         if (!surf)
             return unexpected{error{}};
@@ -686,6 +697,7 @@ namespace sdl::ttf {
                            Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_Solid_Wrapped(raw, text, fg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -732,6 +744,7 @@ namespace sdl::ttf {
                                   Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_Solid_Wrapped(raw, text, fg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -758,6 +771,7 @@ namespace sdl::ttf {
                                   color bg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderGlyph32_Shaded(raw, codepoint, fg, bg);
         if (!surf)
             return unexpected{error{}};
@@ -784,6 +798,7 @@ namespace sdl::ttf {
                             color bg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_Shaded(raw, text, fg, bg);
         if (!surf)
             return unexpected{error{}};
@@ -830,6 +845,7 @@ namespace sdl::ttf {
                                    color bg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_Shaded(raw, text, fg, bg);
         if (!surf)
             return unexpected{error{}};
@@ -858,6 +874,7 @@ namespace sdl::ttf {
                             Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_Shaded_Wrapped(raw, text, fg, bg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -908,6 +925,7 @@ namespace sdl::ttf {
                                    Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_Shaded_Wrapped(raw, text, fg, bg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -932,6 +950,7 @@ namespace sdl::ttf {
                                    color fg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderGlyph32_Blended(raw, codepoint, fg);
         if (!surf)
             return unexpected{error{}};
@@ -956,6 +975,7 @@ namespace sdl::ttf {
                              color fg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_Blended(raw, text, fg);
         if (!surf)
             return unexpected{error{}};
@@ -998,6 +1018,7 @@ namespace sdl::ttf {
                                     color fg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_Blended(raw, text, fg);
         if (!surf)
             return unexpected{error{}};
@@ -1024,6 +1045,7 @@ namespace sdl::ttf {
                              Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_Blended_Wrapped(raw, text, fg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -1070,6 +1092,7 @@ namespace sdl::ttf {
                                     Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_Blended_Wrapped(raw, text, fg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -1098,6 +1121,7 @@ namespace sdl::ttf {
                                color bg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderGlyph32_LCD(raw, codepoint, fg, bg);
         if (!surf)
             return unexpected{error{}};
@@ -1124,6 +1148,7 @@ namespace sdl::ttf {
                          color bg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_LCD(raw, text, fg, bg);
         if (!surf)
             return unexpected{error{}};
@@ -1170,6 +1195,7 @@ namespace sdl::ttf {
                                 color bg)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_LCD(raw, text, fg, bg);
         if (!surf)
             return unexpected{error{}};
@@ -1198,6 +1224,7 @@ namespace sdl::ttf {
                          Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderUTF8_LCD_Wrapped(raw, text, fg, bg, max_width);
         if (!surf)
             return unexpected{error{}};
@@ -1249,6 +1276,7 @@ namespace sdl::ttf {
                                 Uint32 max_width)
         const noexcept
     {
+        memory::tag_scope tag{memory::tag::ttf};
         auto surf = TTF_RenderText_LCD_Wrapped(raw, text, fg, bg, max_width);
         if (!surf)
             return unexpected{error{}};
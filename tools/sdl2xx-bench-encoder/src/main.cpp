@@ -0,0 +1,160 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <sdl2xx/img.hpp>
+#include <sdl2xx/img_encoder.hpp>
+#include <sdl2xx/rwops.hpp>
+#include <sdl2xx/surface.hpp>
+#include <sdl2xx/thread_pool.hpp>
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+using sdl::img::encoder;
+
+namespace fs = std::filesystem;
+
+
+constexpr int width = 1920;
+constexpr int height = 1080;
+
+
+void
+usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [RUNS]\n"
+         << "\n"
+         << "Saves a " << width << "x" << height << " RGBA surface as PNG RUNS times (default 3)\n"
+         << "with img::encoder, for every preset and band size, and with img::save_png().\n"
+         << "\n"
+         << "\"MB/s\" is raw pixel bytes encoded per second of wall time.\n"
+         << endl;
+}
+
+
+const char*
+name_of(encoder::preset p)
+{
+    switch (p) {
+        case encoder::preset::fast:
+            return "fast";
+        case encoder::preset::normal:
+            return "normal";
+        case encoder::preset::best:
+            return "best";
+    }
+    return "?";
+}
+
+
+// Smooth gradients with some noise, so neither the filters nor deflate have it easy.
+sdl::surface
+make_image()
+{
+    sdl::surface img{width, height, 32, sdl::pixels::format_enum::rgba_32};
+    std::minstd_rand rng{42};
+    std::uniform_int_distribution<int> noise{0, 15};
+    for (int y = 0; y < height; ++y) {
+        auto row = static_cast<Uint8*>(img.get_pixels()) + y * img.get_pitch();
+        for (int x = 0; x < width; ++x) {
+            row[4 * x + 0] = x * 240 / width + noise(rng);
+            row[4 * x + 1] = y * 255 / height;
+            row[4 * x + 2] = (x + y) / 16 % 2 ? 200 : 40;
+            row[4 * x + 3] = 255;
+        }
+    }
+    return img;
+}
+
+
+// Each call returns the time it spent encoding.
+template<typename Func>
+void
+measure(const std::string& name,
+        unsigned runs,
+        const fs::path& filename,
+        Func&& func)
+{
+    std::chrono::duration<double> elapsed{0};
+    for (unsigned r = 0; r < runs; ++r)
+        elapsed += func();
+
+    const double bytes = double(width) * height * 4 * runs;
+    cout << std::left << std::setw(24) << name << std::right << std::fixed
+         << std::setprecision(1)
+         << std::setw(10) << bytes / elapsed.count() / 1e6 << " MB/s"
+         << std::setw(10) << 1000 * elapsed.count() / runs << " ms/image"
+         << std::setw(12) << fs::file_size(filename) / 1024 << " KiB"
+         << endl;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    try {
+        if (argc > 2) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        unsigned runs = argc > 1 ? std::stoul(argv[1]) : 3;
+
+        sdl::img::init img_init;
+
+        const sdl::surface image = make_image();
+        fs::path filename = fs::temp_directory_path() / "sdl2xx-bench-encoder.png";
+
+        measure("img::save_png", runs, filename,
+                [&]
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    sdl::img::save_png(image, filename);
+                    return std::chrono::steady_clock::now() - start;
+                });
+
+        sdl::thread_pool pool;
+        cout << "img::encoder, " << pool.size() << " threads:" << endl;
+        encoder enc{pool};
+        for (auto compression : {encoder::preset::fast,
+                                 encoder::preset::normal,
+                                 encoder::preset::best})
+            for (int band_rows : {0, 16, 64, 256}) {
+                std::string name = "  " + std::string{name_of(compression)} + ", "
+                    + (band_rows ? std::to_string(band_rows) + " rows" : "auto");
+                measure(name, runs, filename,
+                        [&]
+                        {
+                            // The encoder takes a snapshot; copy it outside the timing.
+                            sdl::surface copy{image};
+                            encoder::png_options opt{compression, band_rows};
+                            auto start = std::chrono::steady_clock::now();
+                            enc.save_png(std::move(copy),
+                                         sdl::rwops{filename, "wb"},
+                                         opt).get();
+                            return std::chrono::steady_clock::now() - start;
+                        });
+            }
+
+        fs::remove(filename);
+    }
+    catch (std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sdl2xx/audio_mixer.hpp>
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+using sdl::audio::mixer;
+
+
+constexpr int rate = 48'000;
+constexpr std::size_t block_frames = 1024;
+
+
+void
+usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [SECONDS]\n"
+         << "\n"
+         << "Mixes SECONDS (default 10) of 48 kHz stereo audio with 16, 64 and 256\n"
+         << "looping voices, half mono and half stereo, with every SIMD path this CPU\n"
+         << "supports. Pans change on every block, so the gain ramps are exercised.\n"
+         << "\n"
+         << "\"voices/ms\" is how many voice-milliseconds are mixed per millisecond of\n"
+         << "CPU time: the number of voices one core could mix in real time.\n"
+         << endl;
+}
+
+
+const char*
+name_of(mixer::simd s)
+{
+    switch (s) {
+        case mixer::simd::scalar:
+            return "scalar";
+        case mixer::simd::avx2:
+            return "avx2";
+        case mixer::simd::neon:
+            return "neon";
+    }
+    return "?";
+}
+
+
+std::vector<float>
+make_tone(unsigned channels,
+          float freq)
+{
+    std::vector<float> samples(rate * channels);
+    for (int i = 0; i < rate; ++i)
+        for (unsigned c = 0; c < channels; ++c)
+            samples[i * channels + c] = std::sin(2 * std::numbers::pi_v<float> * freq * i / rate
+                                                 + c);
+    return samples;
+}
+
+
+void
+measure(mixer::simd path,
+        unsigned num_voices,
+        double seconds,
+        const std::vector<float>& mono,
+        const std::vector<float>& stereo)
+{
+    mixer mix{block_frames};
+    mix.set_simd(path);
+
+    std::minstd_rand rng{num_voices};
+    std::uniform_real_distribution<float> pan_dist{-1, 1};
+    std::vector<mixer::voice_id> ids;
+    for (unsigned i = 0; i < num_voices; ++i) {
+        if (i % 2)
+            ids.push_back(mix.play(stereo, 2, 1.0f / num_voices, pan_dist(rng), true));
+        else
+            ids.push_back(mix.play(mono, 1, 1.0f / num_voices, pan_dist(rng), true));
+    }
+
+    std::vector<Sint16> out(block_frames * 2);
+    const std::size_t blocks = seconds * rate / block_frames;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t b = 0; b < blocks; ++b) {
+        // Move a few voices on every block.
+        for (unsigned i = b % 8; i < num_voices; i += 8)
+            mix.set_pan(ids[i], pan_dist(rng));
+        mix.mix(out);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double audio_ms = 1000.0 * blocks * block_frames / rate;
+    cout << std::left << std::setw(8) << name_of(path) << std::right
+         << std::setw(8) << num_voices << " voices"
+         << std::fixed << std::setprecision(1)
+         << std::setw(12) << elapsed.count() << " ms"
+         << std::setw(12) << num_voices * audio_ms / elapsed.count() << " voices/ms"
+         << endl;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    try {
+        if (argc > 2) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        double seconds = argc > 1 ? std::stod(argv[1]) : 10;
+
+        auto mono = make_tone(1, 440);
+        auto stereo = make_tone(2, 660);
+
+        for (auto path : {mixer::simd::scalar, mixer::simd::avx2, mixer::simd::neon}) {
+            if (!mixer::is_supported(path)) {
+                cout << std::left << std::setw(8) << name_of(path) << "not supported" << endl;
+                continue;
+            }
+            for (unsigned num_voices : {16u, 64u, 256u})
+                measure(path, num_voices, seconds, mono, stereo);
+        }
+    }
+    catch (std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,202 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <sdl2xx/audio_resampler.hpp>
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+using sdl::audio::resampler;
+
+
+struct quality_info {
+    resampler::quality q;
+    const char* name;
+    // Lowest SNR accepted by the quality check.
+    double min_snr;
+};
+
+constexpr quality_info qualities[] = {
+    {resampler::quality::linear, "linear", 25},
+    {resampler::quality::low,    "low",    65},
+    {resampler::quality::medium, "medium", 80},
+    {resampler::quality::high,   "high",   100},
+};
+
+
+struct conversion {
+    int src_rate;
+    int dst_rate;
+    int freq;
+};
+
+constexpr conversion conversions[] = {
+    {44100, 48000, 1000},
+    {48000, 44100, 1000},
+    {44100, 47999, 1000},
+    {48000, 22050, 5000},
+};
+
+
+void
+usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [SECONDS]\n"
+         << "\n"
+         << "Quality check: resamples one second of a stereo sine with every quality,\n"
+         << "and compares the output to the ideal sine at the new rate. Fails if the\n"
+         << "SNR is below the minimum for the quality.\n"
+         << "\n"
+         << "Throughput: converts SECONDS (default 20) of stereo 44.1 kHz audio to 48 kHz,\n"
+         << "in blocks of 64 and 1024 frames, and prints output frames per second.\n"
+         << endl;
+}
+
+
+double
+sine(int freq,
+     int rate,
+     std::size_t frame)
+{
+    return 0.5 * std::sin(2 * std::numbers::pi * freq * frame / rate);
+}
+
+
+void
+drain(resampler& r,
+      std::vector<float>& out,
+      std::vector<float>& buf)
+{
+    while (std::size_t got = r.get(std::span{buf}))
+        out.insert(out.end(), buf.begin(), buf.begin() + got);
+}
+
+
+// Returns the SNR in dB.
+double
+measure_snr(const quality_info& qi,
+            const conversion& conv)
+{
+    resampler r{2, conv.src_rate, conv.dst_rate, qi.q};
+
+    const std::size_t in_frames = conv.src_rate;
+    std::vector<float> in(2 * in_frames);
+    for (std::size_t i = 0; i < in_frames; ++i) {
+        in[2 * i + 0] = sine(conv.freq, conv.src_rate, i);
+        in[2 * i + 1] = -in[2 * i + 0];
+    }
+
+    // Small blocks, like an audio callback would use.
+    std::vector<float> out;
+    std::vector<float> buf(2 * 256);
+    for (std::size_t i = 0; i < in_frames; i += 100) {
+        std::size_t n = std::min<std::size_t>(100, in_frames - i);
+        r.put(std::span<const float>{in.data() + 2 * i, 2 * n});
+        drain(r, out, buf);
+    }
+    r.flush();
+    drain(r, out, buf);
+
+    // Skip the edges, where the filter sees the implicit silence around the input.
+    const std::size_t out_frames = out.size() / 2;
+    const std::size_t edge = r.get_latency() * 4 + 10;
+    double signal = 0;
+    double noise = 0;
+    for (std::size_t i = edge; i + edge < out_frames; ++i) {
+        double ref = sine(conv.freq, conv.dst_rate, i);
+        for (unsigned c = 0; c < 2; ++c) {
+            double e = out[2 * i + c] - (c ? -ref : ref);
+            signal += ref * ref;
+            noise += e * e;
+        }
+    }
+    return 10 * std::log10(signal / noise);
+}
+
+
+void
+measure_throughput(const quality_info& qi,
+                   double seconds,
+                   std::size_t block_frames)
+{
+    resampler r{2, 44100, 48000, qi.q};
+    std::vector<float> in(2 * block_frames, 0.25f);
+    std::vector<float> out(2 * (block_frames * 2 + 64));
+
+    const std::size_t blocks = seconds * 44100 / block_frames;
+    std::size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t b = 0; b < blocks; ++b) {
+        r.put(std::span<const float>{in});
+        total += r.get(std::span{out});
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    cout << "  " << std::left << std::setw(8) << qi.name << std::right
+         << std::setw(6) << block_frames << " frames/block"
+         << std::fixed << std::setprecision(2)
+         << std::setw(10) << total / 2 / elapsed.count() / 1e6 << " Mframes/s"
+         << std::setprecision(0)
+         << std::setw(8) << total / 2 / elapsed.count() / 48000 << "x real time"
+         << endl;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    try {
+        if (argc > 2) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        double seconds = argc > 1 ? std::stod(argv[1]) : 20;
+
+        bool passed = true;
+        cout << "Quality (SNR):" << endl;
+        for (auto& qi : qualities)
+            for (auto& conv : conversions) {
+                double snr = measure_snr(qi, conv);
+                bool ok = snr >= qi.min_snr;
+                passed &= ok;
+                cout << "  " << std::left << std::setw(8) << qi.name << std::right
+                     << std::setw(6) << conv.src_rate << " -> " << std::setw(5) << conv.dst_rate
+                     << std::setw(6) << conv.freq << " Hz"
+                     << std::fixed << std::setprecision(1)
+                     << std::setw(8) << snr << " dB";
+                if (!ok)
+                    cout << "   FAILED, minimum is " << qi.min_snr << " dB";
+                cout << endl;
+            }
+
+        cout << "Throughput (stereo, 44100 -> 48000):" << endl;
+        for (auto& qi : qualities)
+            for (std::size_t block_frames : {64u, 1024u})
+                measure_throughput(qi, seconds, block_frames);
+
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}
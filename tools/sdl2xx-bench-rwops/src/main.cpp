@@ -0,0 +1,147 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <sdl2xx/buffered_rwops.hpp>
+#include <sdl2xx/rwops.hpp>
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+namespace fs = std::filesystem;
+
+
+// Each record is 15 bytes, read as 4 fields.
+constexpr std::size_t record_size = 1 + 2 + 4 + 8;
+
+
+void
+usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [RECORDS]\n"
+         << "\n"
+         << "Writes RECORDS records (default 1000000) of 4 little-endian fields to a\n"
+         << "temporary file, then parses them field by field with read_le<T>(),\n"
+         << "through a plain rwops and through a buffered_rwops.\n"
+         << endl;
+}
+
+
+void
+write_records(const fs::path& filename,
+              std::size_t count)
+{
+    sdl::buffered_rwops dst{filename, "wb"};
+    for (std::size_t i = 0; i < count; ++i) {
+        dst.write_le<Uint8>(i);
+        dst.write_le<Uint16>(i * 3);
+        dst.write_le<Uint32>(i * 7);
+        dst.write_le<Uint64>(i * 11);
+    }
+    dst.flush();
+}
+
+
+Uint64
+parse_records(sdl::rwops& src,
+              std::size_t count)
+{
+    Uint64 sum = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        sum += src.read_le<Uint8>();
+        sum += src.read_le<Uint16>();
+        sum += src.read_le<Uint32>();
+        sum += src.read_le<Uint64>();
+    }
+    return sum;
+}
+
+
+template<typename Func>
+void
+measure(const std::string& name,
+        std::size_t count,
+        Func&& func)
+{
+    auto start = std::chrono::steady_clock::now();
+    Uint64 sum = func();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double bytes = double(count) * record_size;
+    const double fields = double(count) * 4;
+    cout << std::left << std::setw(28) << name << std::right << std::fixed
+         << std::setprecision(1)
+         << std::setw(10) << bytes / elapsed.count() / 1e6 << " MB/s"
+         << std::setw(10) << fields / elapsed.count() / 1e6 << " Mfields/s"
+         << "   (checksum " << sum << ")"
+         << endl;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    try {
+        if (argc > 2) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+
+        fs::path filename = fs::temp_directory_path() / "sdl2xx-bench-rwops.bin";
+        write_records(filename, count);
+
+        measure("file", count,
+                [&]
+                {
+                    sdl::rwops src{filename, "rb"};
+                    return parse_records(src, count);
+                });
+
+        measure("buffered file", count,
+                [&]
+                {
+                    sdl::buffered_rwops src{filename, "rb"};
+                    return parse_records(src, count);
+                });
+
+        measure("streambuf", count,
+                [&]
+                {
+                    std::filebuf buf;
+                    buf.open(filename, std::ios::in | std::ios::binary);
+                    sdl::rwops src{buf};
+                    return parse_records(src, count);
+                });
+
+        measure("buffered streambuf", count,
+                [&]
+                {
+                    std::filebuf buf;
+                    buf.open(filename, std::ios::in | std::ios::binary);
+                    sdl::buffered_rwops src{sdl::rwops{buf}};
+                    return parse_records(src, count);
+                });
+
+        fs::remove(filename);
+    }
+    catch (std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * SDL2XX - a C++23 wrapper for SDL2.
+ *
+ * Copyright 2025  Daniel K. O. <dkosmari>
+ *
+ * SPDX-License-Identifier: Zlib
+ */
+
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <sdl2xx/pack.hpp>
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+namespace fs = std::filesystem;
+
+
+void
+usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [-a ALIGNMENT] [-c CODEC] [-l LEVEL] OUTPUT INPUT...\n"
+         << "\n"
+         << "Creates the pack file OUTPUT from the INPUT files.\n"
+         << "Directories are added recursively; entries are named by their path\n"
+         << "relative to the INPUT directory, using '/' as separator.\n"
+         << "\n"
+         << "  -c CODEC  compress entries with 'deflate', 'zstd' or 'lz4'\n"
+         << "  -l LEVEL  compression level\n"
+         << endl;
+}
+
+
+sdl::pack::compression
+parse_compression(const std::string& name)
+{
+    if (name == "none")
+        return sdl::pack::compression::none;
+    if (name == "deflate")
+        return sdl::pack::compression::deflate;
+    if (name == "zstd")
+        return sdl::pack::compression::zstd;
+    if (name == "lz4")
+        return sdl::pack::compression::lz4;
+    throw std::invalid_argument{"unknown codec: " + name};
+}
+
+
+void
+add_input(sdl::pack::writer& w,
+          const fs::path& input,
+          sdl::pack::compression comp)
+{
+    if (fs::is_directory(input)) {
+        for (auto& e : fs::recursive_directory_iterator{input}) {
+            if (!e.is_regular_file())
+                continue;
+            auto name = e.path().lexically_relative(input).generic_string();
+            w.add_file(name, e.path(), comp);
+        }
+    } else
+        w.add_file(input.filename().generic_string(), input, comp);
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    try {
+        std::size_t alignment = sdl::pack::default_alignment;
+        auto comp = sdl::pack::compression::none;
+        int level = sdl::compress_rwops::default_level;
+        int arg = 1;
+        while (arg + 1 < argc) {
+            std::string opt = argv[arg];
+            if (opt == "-a")
+                alignment = std::stoul(argv[arg + 1]);
+            else if (opt == "-c")
+                comp = parse_compression(argv[arg + 1]);
+            else if (opt == "-l")
+                level = std::stoi(argv[arg + 1]);
+            else
+                break;
+            arg += 2;
+        }
+        if (argc - arg < 2) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        fs::path output = argv[arg++];
+        sdl::pack::writer w{alignment, level};
+        for (; arg < argc; ++arg)
+            add_input(w, argv[arg], comp);
+
+        auto count = w.size();
+        w.save(output);
+        cout << "Wrote " << count << " entries to " << output << endl;
+    }
+    catch (std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}